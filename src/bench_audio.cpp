@@ -0,0 +1,452 @@
+// Audio mixing benchmark.
+// Mixes one block of stereo output per voice, the way the wave engine does, for voices at the
+// device rate (copied straight in) and voices that need resampling (LERPed by the kernels),
+// against the same voices read a sample at a time through Wave::vChannelView, and checks the
+// results agree. Reports voices mixed per millisecond, and how many voices that would keep up
+// with playback.
+//
+// Then runs the whole engine through a Null driver, with no audio device, for a rising number
+// of voices, and checks that mixing the same voices twice gives the same samples. The same
+// voices are run again from IMA ADPCM waves, which the mixer decodes as it goes. Given a
+// file name, the 64 voice mix is also written there with a WaveWriter driver.
+//
+// Last, the engine resamples a sine through linear and windowed sinc interpolation, and
+// reports what each costs in voices per millisecond, and how close each output is to the
+// exact sine, as a signal to noise ratio. Cost is how many times longer sinc takes.
+//
+// And for synthesis, each oscillator shape is run a sample at a time through Update() and a
+// block at a time through UpdateBlock(), checking both give the same samples, then a bank of
+// oscillators is run through the engine's per sample and block callbacks.
+//
+// g++ -O2 -DSOUNDWAVE_USING_NULL -o bench_audio bench_audio.cpp -lpthread -std=c++17
+// ./bench_audio [block samples] [seconds per case] [file.wav]
+//
+// The kernels use SSE2 on any x86-64 build. Add -mavx2 (or -march=native) for the AVX2
+// kernels, or -DSOUNDWAVE_SIMD_NONE to measure the scalar ones.
+
+#define OLC_SOUNDWAVE
+#include "olcSoundWaveEngine.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+
+constexpr uint32_t nSampleRate = 44100;
+
+// Hashes every block it mixes, to tell whether two runs agree
+class HashDriver : public olc::sound::driver::Null
+{
+public:
+    HashDriver(olc::sound::WaveEngine *pHost) : Null(pHost, Mode::Manual)
+    {}
+
+    uint64_t nHash = 1469598103934665603ull;
+
+protected:
+    void OnBlock(const std::vector<float> &vBlock) override
+    {
+        const uint8_t *pBytes = (const uint8_t *)vBlock.data();
+        for (size_t n = 0; n < vBlock.size() * sizeof(float); n++)
+            nHash = (nHash ^ pBytes[n]) * 1099511628211ull;
+    }
+};
+
+// Keeps every sample it mixes
+class CaptureDriver : public olc::sound::driver::Null
+{
+public:
+    CaptureDriver(olc::sound::WaveEngine *pHost) : Null(pHost, Mode::Manual)
+    {}
+
+    std::vector<float> vSamples;
+
+protected:
+    void OnBlock(const std::vector<float> &vBlock) override
+    {
+        vSamples.insert(vSamples.end(), vBlock.begin(), vBlock.end());
+    }
+};
+
+// Returns the number of voices it mixed
+typedef std::function<uint64_t()> MixFunc;
+
+// Runs func until fDuration has passed, returning voices per millisecond
+double Time(const MixFunc &func, float fDuration)
+{
+    uint64_t nVoices = 0;
+    int nRuns = 0;
+    auto tpStart = std::chrono::steady_clock::now();
+    double fElapsed = 0.0;
+    while (nRuns < 3 || fElapsed < fDuration)
+    {
+        nVoices += func();
+        nRuns++;
+        fElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - tpStart).count();
+    }
+    return double(nVoices) / (fElapsed * 1000.0);
+}
+
+// How the mixer read waves before it had kernels, a sample and channel at a time
+void MixByView(float *pOutput, olc::sound::Wave &wave, uint32_t nFrames, double dStart, double dStep, float fGain)
+{
+    size_t nWaveChannels = wave.file.channels();
+    for (uint32_t n = 0; n < nFrames; n++)
+        for (uint32_t c = 0; c < 2; c++)
+            pOutput[n * 2 + c] += float(wave.vChannelView[c % nWaveChannels].GetSample(dStart + n * dStep)) * fGain;
+}
+
+// The kernels, chosen as WaveEngine::MixWave chooses them
+void MixByKernels(float *pOutput, olc::sound::Wave &wave, uint32_t nFrames, double dStart, double dStep, float fGain)
+{
+    const float *pData = wave.file.data();
+    size_t nWaveChannels = wave.file.channels();
+    if (dStep == 1.0)
+    {
+        const float *pSource = pData + size_t(dStart) * nWaveChannels;
+        if (nWaveChannels == 2)
+            olc::sound::mix::Accumulate(pOutput, pSource, size_t(nFrames) * 2, fGain);
+        else
+            olc::sound::mix::AccumulateMonoToStereo(pOutput, pSource, nFrames, fGain);
+        return;
+    }
+
+    alignas(32) float fChunk[256];
+    uint64_t nFixedStart = uint64_t(dStart * 4294967296.0);
+    uint64_t nFixedStep = uint64_t(dStep * 4294967296.0);
+    for (uint32_t n = 0; n < nFrames; n += 256)
+    {
+        uint32_t nCount = std::min(256u, nFrames - n);
+        uint64_t nFixed = nFixedStart + n * nFixedStep;
+        if (nWaveChannels == 2)
+            olc::sound::mix::AccumulateResampledStereo(pOutput + n * 2, pData, nFixed, nFixedStep, nCount, fGain);
+        else
+        {
+            olc::sound::mix::Resample(fChunk, pData, 1, 0, nFixed, nFixedStep, nCount);
+            olc::sound::mix::AccumulateMonoToStereo(pOutput + n * 2, fChunk, nCount, fGain);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t nBlockSamples = (argc > 1) ? uint32_t(std::atoi(argv[1])) : 512;
+    float fDuration = (argc > 2) ? float(std::atof(argv[2])) : 0.5f;
+    std::string sWaveFile = (argc > 3) ? argv[3] : "";
+
+    // A bank of voices, each starting somewhere different in the same 4 second waves
+    constexpr int nVoices = 32;
+    std::vector<float> vOutput(size_t(nBlockSamples) * 2);
+    std::vector<float> vReference(size_t(nBlockSamples) * 2);
+
+    std::cout << "kernels:     " << olc::sound::mix::Path() << "\n";
+    std::cout << "block:       " << nBlockSamples << " samples, stereo, " << nSampleRate << " Hz\n\n";
+    std::cout << std::left << std::setw(30) << "voice" << std::right << std::fixed << std::setprecision(1)
+              << std::setw(16) << "voices/ms mixer" << std::setw(16) << "voices/ms view" << std::setw(10) << "mixer"
+              << std::setw(18) << "real time voices" << std::setw(8) << "match" << "\n";
+
+    struct Case
+    {
+        const char *sName;
+        uint32_t nChannels;
+        uint32_t nRate;
+        double dSpeed;
+    };
+
+    for (const Case &c : std::initializer_list<Case>{
+             {"mono, device rate", 1, 44100, 1.0},
+             {"stereo, device rate", 2, 44100, 1.0},
+             {"mono, 22050 Hz", 1, 22050, 1.0},
+             {"stereo, 48000 Hz", 2, 48000, 1.0},
+             {"mono, device rate, x1.3", 1, 44100, 1.3},
+             {"stereo, device rate, x0.7", 2, 44100, 0.7}})
+    {
+        olc::sound::Wave wave(c.nChannels, sizeof(float), c.nRate, c.nRate * 4);
+        for (size_t n = 0; n < wave.file.samples(); n++)
+            for (uint32_t ch = 0; ch < c.nChannels; ch++)
+                wave.file.data()[n * c.nChannels + ch] = float(std::sin(double(n) * (0.01 + 0.003 * ch)));
+
+        double dStep = c.dSpeed * double(c.nRate) / double(nSampleRate);
+        auto Start = [&](int nVoice)
+        {
+            double dStart = double((nVoice * 7919) % (c.nRate * 2));
+            return (dStep == 1.0) ? dStart : dStart + 0.25;
+        };
+
+        auto Mix = [&](std::vector<float> &vTarget, bool bKernels)
+        {
+            std::fill(vTarget.begin(), vTarget.end(), 0.0f);
+            for (int v = 0; v < nVoices; v++)
+            {
+                if (bKernels)
+                    MixByKernels(vTarget.data(), wave, nBlockSamples, Start(v), dStep, 0.1f);
+                else
+                    MixByView(vTarget.data(), wave, nBlockSamples, Start(v), dStep, 0.1f);
+            }
+            return uint64_t(nVoices);
+        };
+
+        Mix(vOutput, true);
+        Mix(vReference, false);
+        float fError = 0.0f;
+        for (size_t n = 0; n < vOutput.size(); n++)
+            fError = std::max(fError, std::abs(vOutput[n] - vReference[n]));
+
+        double fKernels = Time([&]() { return Mix(vOutput, true); }, fDuration);
+        double fView = Time([&]() { return Mix(vReference, false); }, fDuration);
+        double fBlockMilliseconds = 1000.0 * nBlockSamples / nSampleRate;
+
+        std::cout << std::left << std::setw(30) << c.sName << std::right << std::setw(16) << fKernels << std::setw(16) << fView
+                  << std::setw(9) << fKernels / fView << "x" << std::setw(18) << uint64_t(fKernels * fBlockMilliseconds)
+                  << std::setw(8) << (fError < 1e-4f ? "yes" : "NO") << std::endl;
+    }
+
+    // Half the voices resample a mono wave, half copy a stereo one
+    olc::sound::Wave waveMono(1, sizeof(float), 22050, 22050 * 4);
+    for (size_t n = 0; n < waveMono.file.samples(); n++)
+        waveMono.file.data()[n] = float(std::sin(double(n) * 0.02));
+    olc::sound::Wave waveStereo(2, sizeof(float), nSampleRate, nSampleRate * 4);
+    for (size_t n = 0; n < waveStereo.file.samples() * 2; n++)
+        waveStereo.file.data()[n] = float(std::sin(double(n) * 0.013));
+    olc::sound::WaveAdpcm adpcmMono, adpcmStereo;
+    adpcmMono.Encode(waveMono);
+    adpcmStereo.Encode(waveStereo);
+
+    // Plays nVoices voices on a fresh engine driven by pDriver, which must be made for it
+    auto Play = [&](olc::sound::WaveEngine &engine, std::unique_ptr<olc::sound::driver::Null> pDriver, uint32_t nVoices, bool bAdpcm = false)
+    {
+        engine.UseDriver(std::move(pDriver));
+        engine.SetVoiceLimit(nVoices);
+        engine.InitialiseAudio(nSampleRate, 2, 8, nBlockSamples);
+        for (uint32_t v = 0; v < nVoices; v++)
+        {
+            double dSpeed = (v % 2) ? 1.0 + 0.01 * v : 1.0;
+            if (bAdpcm)
+                engine.PlayWaveform((v % 2) ? &adpcmMono : &adpcmStereo, true, dSpeed, 1.0f / nVoices);
+            else
+                engine.PlayWaveform((v % 2) ? &waveMono : &waveStereo, true, dSpeed, 1.0f / nVoices);
+        }
+    };
+
+    std::cout << "\n" << std::left << std::setw(30) << "engine, Null driver" << std::right << std::setw(16) << "voices/ms"
+              << std::setw(16) << "blocks/s" << std::setw(10) << "" << std::setw(18) << "real time voices" << std::setw(8) << "repeat" << "\n";
+
+    for (bool bAdpcm : {false, true})
+    for (uint32_t nVoices : {1u, 16u, 64u, 256u})
+    {
+        uint64_t nHash[2];
+        for (int nRun = 0; nRun < 2; nRun++)
+        {
+            olc::sound::WaveEngine engine;
+            auto pDriver = std::make_unique<HashDriver>(&engine);
+            HashDriver *pHash = pDriver.get();
+            Play(engine, std::move(pDriver), nVoices, bAdpcm);
+            pHash->RenderBlocks(64);
+            nHash[nRun] = pHash->nHash;
+        }
+
+        olc::sound::WaveEngine engine;
+        auto pDriver = std::make_unique<olc::sound::driver::Null>(&engine, olc::sound::driver::Null::Mode::Manual);
+        olc::sound::driver::Null *pNull = pDriver.get();
+        Play(engine, std::move(pDriver), nVoices, bAdpcm);
+        double fVoices = Time([&]() { pNull->RenderBlocks(16); return uint64_t(16) * nVoices; }, fDuration);
+        double fBlockMilliseconds = 1000.0 * nBlockSamples / nSampleRate;
+
+        std::cout << std::left << std::setw(30) << (std::to_string(nVoices) + (bAdpcm ? " voices, ADPCM" : " voices")) << std::right << std::setw(16) << fVoices
+                  << std::setw(16) << fVoices * 1000.0 / nVoices << std::setw(10) << "" << std::setw(18) << uint64_t(fVoices * fBlockMilliseconds)
+                  << std::setw(8) << (nHash[0] == nHash[1] ? "yes" : "NO") << std::endl;
+    }
+
+    std::cout << "\n" << std::left << std::setw(30) << "resampling, engine" << std::right << std::setw(16) << "voices/ms linear"
+              << std::setw(16) << "voices/ms sinc" << std::setw(10) << "cost" << std::setw(18) << "SNR linear dB" << std::setw(16) << "SNR sinc dB" << "\n";
+
+    struct Resampling
+    {
+        const char *sName;
+        uint32_t nChannels;
+        uint32_t nRate;
+        double dSpeed;
+    };
+
+    for (const Resampling &c : std::initializer_list<Resampling>{
+             {"mono, 22050 Hz", 1, 22050, 1.0},
+             {"stereo, 48000 Hz", 2, 48000, 1.0},
+             {"mono, device rate, x1.3", 1, 44100, 1.3},
+             {"stereo, device rate, x0.7", 2, 44100, 0.7},
+             {"stereo, device rate, x2.5", 2, 44100, 2.5}})
+    {
+        // A sine at 60% of the lower of the source's and output's Nyquist frequencies
+        double dStep = c.dSpeed * double(c.nRate) / double(nSampleRate);
+        double dCycles = 0.3 / std::max(dStep, 1.0);
+        olc::sound::Wave wave(c.nChannels, sizeof(float), c.nRate, c.nRate * 4);
+        for (size_t n = 0; n < wave.file.samples(); n++)
+            for (uint32_t ch = 0; ch < c.nChannels; ch++)
+                wave.file.data()[n * c.nChannels + ch] = float(0.5 * std::sin(2.0 * 3.14159265358979323846 * dCycles * double(n) + ch));
+
+        double fVoices[2], fSNR[2];
+        for (auto interpolation : {olc::sound::Interpolation::Linear, olc::sound::Interpolation::Sinc})
+        {
+            int i = int(interpolation);
+            {
+                // One voice, against the sine it was made from, clear of either end of the wave
+                olc::sound::WaveEngine engine;
+                auto pDriver = std::make_unique<CaptureDriver>(&engine);
+                CaptureDriver *pCapture = pDriver.get();
+                engine.UseDriver(std::move(pDriver));
+                engine.SetInterpolation(interpolation);
+                engine.InitialiseAudio(nSampleRate, 2, 8, nBlockSamples);
+                engine.PlayWaveform(&wave, false, c.dSpeed, 1.0f);
+                pCapture->RenderBlocks(nSampleRate / nBlockSamples);
+
+                double dSignal = 0.0, dNoise = 0.0;
+                for (size_t n = 256; n < pCapture->vSamples.size() / 2; n++)
+                    for (uint32_t ch = 0; ch < 2; ch++)
+                    {
+                        double dExact = 0.5 * std::sin(2.0 * 3.14159265358979323846 * dCycles * double(n) * dStep + ch % c.nChannels);
+                        double dError = double(pCapture->vSamples[n * 2 + ch]) - dExact;
+                        dSignal += dExact * dExact;
+                        dNoise += dError * dError;
+                    }
+                fSNR[i] = 10.0 * std::log10(dSignal / std::max(dNoise, 1e-30));
+            }
+
+            olc::sound::WaveEngine engine;
+            auto pDriver = std::make_unique<olc::sound::driver::Null>(&engine, olc::sound::driver::Null::Mode::Manual);
+            olc::sound::driver::Null *pNull = pDriver.get();
+            engine.UseDriver(std::move(pDriver));
+            engine.SetInterpolation(interpolation);
+            engine.SetVoiceLimit(64);
+            engine.InitialiseAudio(nSampleRate, 2, 8, nBlockSamples);
+            for (uint32_t v = 0; v < 64; v++)
+                engine.PlayWaveform(&wave, true, c.dSpeed * (1.0 + 0.001 * v), 1.0f / 64);
+            fVoices[i] = Time([&]() { pNull->RenderBlocks(16); return uint64_t(16) * 64; }, fDuration);
+        }
+
+        std::cout << std::left << std::setw(30) << c.sName << std::right << std::setw(16) << fVoices[0] << std::setw(16) << fVoices[1]
+                  << std::setw(9) << fVoices[0] / fVoices[1] << "x" << std::setw(18) << fSNR[0] << std::setw(16) << fSNR[1] << std::endl;
+    }
+
+    std::cout << "\n" << std::left << std::setw(30) << "synth, oscillator" << std::right << std::setw(16) << "Ms/s block"
+              << std::setw(16) << "Ms/s frame" << std::setw(10) << "block" << std::setw(18) << "" << std::setw(8) << "match" << "\n";
+
+    using Oscillator = olc::sound::synth::modules::Oscillator;
+    for (auto [sName, type] : std::initializer_list<std::pair<const char *, Oscillator::Type>>{
+             {"Sine", Oscillator::Type::Sine},
+             {"Saw", Oscillator::Type::Saw},
+             {"Square", Oscillator::Type::Square},
+             {"Triangle", Oscillator::Type::Triangle},
+             {"PWM", Oscillator::Type::PWM},
+             {"Noise", Oscillator::Type::Noise}})
+    {
+        const double dTimeStep = 1.0 / nSampleRate;
+        const uint32_t nFrames = std::min(nBlockSamples, olc::sound::synth::nMaxBlockFrames);
+        auto Make = [&]()
+        {
+            Oscillator osc;
+            osc.waveform = type;
+            osc.frequency = 440.0 / 20000.0;
+            osc.amplitude = 0.5;
+            osc.parameter = -0.3;
+            return osc;
+        };
+
+        // A few blocks' worth each way, from the same start
+        Oscillator oscBlock = Make(), oscSample = Make();
+        float fError = 0.0f;
+        for (int nBlock = 0; nBlock < 16; nBlock++)
+        {
+            oscBlock.UpdateBlock(0, 0.0, dTimeStep, nFrames);
+            for (uint32_t n = 0; n < nFrames; n++)
+            {
+                oscSample.Update(0, 0.0, dTimeStep);
+                fError = std::max(fError, std::abs(oscBlock.output.block[n] - float(oscSample.output.value)));
+            }
+        }
+
+        double fBlock = Time([&]() { oscBlock.UpdateBlock(0, 0.0, dTimeStep, nFrames); return uint64_t(nFrames); }, fDuration);
+        double fSample = Time([&]()
+        {
+            for (uint32_t n = 0; n < nFrames; n++)
+                oscSample.Update(0, 0.0, dTimeStep);
+            return uint64_t(nFrames);
+        }, fDuration);
+
+        std::cout << std::left << std::setw(30) << sName << std::right << std::setw(16) << fBlock / 1000.0 << std::setw(16) << fSample / 1000.0
+                  << std::setw(9) << fBlock / fSample << "x" << std::setw(18) << "" << std::setw(8) << (fError < 1e-4f ? "yes" : "NO") << std::endl;
+    }
+
+    {
+        // Eight detuned sines summed on every channel, through each kind of callback
+        constexpr int nOscillators = 8;
+        double fBlocks[2];
+        for (int nBlockCallback = 0; nBlockCallback < 2; nBlockCallback++)
+        {
+            std::vector<Oscillator> vOscillators(nOscillators);
+            olc::sound::synth::ModularSynth synth;
+            for (int i = 0; i < nOscillators; i++)
+            {
+                vOscillators[i].frequency = (110.0 + 55.0 * i) / 20000.0;
+                vOscillators[i].amplitude = 1.0 / nOscillators;
+                synth.AddModule(&vOscillators[i]);
+            }
+
+            olc::sound::WaveEngine engine;
+            auto pDriver = std::make_unique<olc::sound::driver::Null>(&engine, olc::sound::driver::Null::Mode::Manual);
+            olc::sound::driver::Null *pNull = pDriver.get();
+            engine.UseDriver(std::move(pDriver));
+            if (nBlockCallback)
+            {
+                engine.SetCallBack_SynthBlock([&](uint32_t nChannel, double dTime, double dTimeStep, float *pSamples, uint32_t nCount)
+                {
+                    // The bank is run once, on the first channel, and copied to the rest
+                    static std::vector<float> vMix(olc::sound::synth::nMaxBlockFrames);
+                    for (uint32_t n = 0; n < nCount; n += olc::sound::synth::nMaxBlockFrames)
+                    {
+                        uint32_t nFrames = std::min(nCount - n, olc::sound::synth::nMaxBlockFrames);
+                        if (nChannel == 0)
+                        {
+                            std::fill(vMix.begin(), vMix.end(), 0.0f);
+                            synth.UpdateBlock(0, dTime + n * dTimeStep, dTimeStep, nFrames);
+                            for (auto &osc : vOscillators)
+                                olc::sound::mix::Accumulate(vMix.data(), osc.output.block, nFrames, 1.0f);
+                        }
+                        std::copy(vMix.begin(), vMix.begin() + nFrames, pSamples + n);
+                    }
+                });
+            }
+            else
+            {
+                float fMix = 0.0f;
+                engine.SetCallBack_SynthFunction([&](uint32_t nChannel, double dTime)
+                {
+                    if (nChannel == 0)
+                    {
+                        synth.Update(0, dTime, 1.0 / nSampleRate);
+                        fMix = 0.0f;
+                        for (auto &osc : vOscillators)
+                            fMix += float(osc.output.value);
+                    }
+                    return fMix;
+                });
+            }
+            engine.InitialiseAudio(nSampleRate, 2, 8, nBlockSamples);
+            fBlocks[nBlockCallback] = Time([&]() { pNull->RenderBlocks(16); return uint64_t(16); }, fDuration) * 1000.0;
+        }
+
+        std::cout << std::left << std::setw(30) << "8 sines, engine callbacks" << std::right << std::setw(16) << fBlocks[1]
+                  << std::setw(16) << fBlocks[0] << std::setw(9) << fBlocks[1] / fBlocks[0] << "x" << std::setw(18) << "blocks/s" << std::endl;
+    }
+
+    if (!sWaveFile.empty())
+    {
+        // Five seconds, mixed as fast as the writer can go
+        olc::sound::WaveEngine engine;
+        auto pDriver = std::make_unique<olc::sound::driver::WaveWriter>(&engine, sWaveFile, olc::sound::driver::Null::Mode::Manual);
+        olc::sound::driver::WaveWriter *pWriter = pDriver.get();
+        Play(engine, std::move(pDriver), 64);
+        pWriter->RenderBlocks(5 * nSampleRate / nBlockSamples);
+        engine.DestroyAudio();
+        std::cout << "\nwrote " << sWaveFile << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,310 @@
+// CPU draw primitive benchmark.
+// Times Clear, FillRect, FillCircle and DrawSprite, which draw through the span kernels,
+// straight away and deferred to the tile workers, against the same pixels plotted one by
+// one with Draw(), and checks all three give the same image.
+//
+// DrawLine, DrawCircle and DrawString plot through Draw() when drawn straight away, so for
+// those the spans and Draw() columns are the same calls, and the tiles column shows what
+// deferring them costs or saves.
+//
+// g++ -O2 -DOLC_PGE_HEADLESS -o bench_cpu bench_cpu.cpp -lpthread -lstdc++fs -std=c++17
+// ./bench_cpu [width] [height] [seconds per case]
+//
+// The kernels use SSE2 on any x86-64 build. Add -mavx2 (or -march=native) for the AVX2
+// kernels, or -DOLC_SIMD_NONE to measure the scalar ones.
+
+#define OLC_PGE_APPLICATION
+#include "olcPixelGameEngine.h"
+
+#include <cstdlib>
+#include <iomanip>
+
+class BenchCPU : public olc::PixelGameEngine
+{
+private:
+    int nWidth;
+    int nHeight;
+    float fDuration;
+
+    std::unique_ptr<olc::Sprite> sprTarget;
+    std::unique_ptr<olc::Sprite> sprReference;
+    std::unique_ptr<olc::Sprite> sprBackground;
+    std::unique_ptr<olc::Sprite> sprTile;
+
+    // Returns the number of pixels it drew
+    typedef std::function<uint64_t()> DrawFunc;
+
+public:
+    BenchCPU(int nWidth, int nHeight, float fDuration)
+    {
+        sAppName = "CPU Benchmark";
+        this->nWidth = nWidth;
+        this->nHeight = nHeight;
+        this->fDuration = fDuration;
+    }
+
+private:
+    void Reset(olc::Sprite *spr)
+    {
+        std::memcpy(spr->GetData(), sprBackground->GetData(), sizeof(olc::Pixel) * nWidth * nHeight);
+    }
+
+    // Runs func until fDuration has passed, returning pixels per second
+    double Time(const DrawFunc &func)
+    {
+        uint64_t nPixels = 0;
+        int nRuns = 0;
+        auto tpStart = std::chrono::steady_clock::now();
+        double fElapsed = 0.0;
+        while (nRuns < 3 || fElapsed < fDuration)
+        {
+            nPixels += func();
+            nRuns++;
+            fElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - tpStart).count();
+        }
+        return double(nPixels) / fElapsed;
+    }
+
+    bool Matches()
+    {
+        return std::memcmp(sprTarget->GetData(), sprReference->GetData(), sizeof(olc::Pixel) * nWidth * nHeight) == 0;
+    }
+
+    void Run(const std::string &sName, olc::Pixel::Mode mode, const DrawFunc &funcSpans, const DrawFunc &funcDraw)
+    {
+        SetPixelMode(mode);
+
+        DrawFunc funcDeferred = [&]()
+        {
+            EnableDeferredDrawing(true);
+            uint64_t nPixels = funcSpans();
+            EnableDeferredDrawing(false);
+            return nPixels;
+        };
+
+        // Draw once each from the same background, the images must agree
+        SetDrawTarget(sprReference.get());
+        Reset(sprReference.get());
+        funcDraw();
+        SetDrawTarget(sprTarget.get());
+        Reset(sprTarget.get());
+        funcSpans();
+        bool bMatch = Matches();
+        Reset(sprTarget.get());
+        funcDeferred();
+        bMatch &= Matches();
+
+        double fSpans = Time(funcSpans);
+        double fDeferred = Time(funcDeferred);
+        SetDrawTarget(sprReference.get());
+        double fDraw = Time(funcDraw);
+
+        const char *sMode = (mode == olc::Pixel::NORMAL) ? "NORMAL" : (mode == olc::Pixel::MASK) ? "MASK" : "ALPHA";
+        std::cout << std::left << std::setw(22) << sName << std::setw(8) << sMode << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << fSpans / 1e6 << std::setw(14) << fDeferred / 1e6 << std::setw(14) << fDraw / 1e6
+                  << std::setw(9) << fSpans / fDraw << "x" << std::setw(9) << fDeferred / fDraw << "x" << std::setw(8) << (bMatch ? "yes" : "NO") << std::endl;
+
+        SetPixelMode(olc::Pixel::NORMAL);
+    }
+
+    // What FillCircle() did before it drew spans
+    uint64_t DrawCircleByPixel(int32_t x, int32_t y, int32_t radius, olc::Pixel p)
+    {
+        uint64_t nPixels = 0;
+        int x0 = 0;
+        int y0 = radius;
+        int d = 3 - 2 * radius;
+
+        auto drawline = [&](int sx, int ex, int y)
+        {
+            for (int x = sx; x <= ex; x++)
+                Draw(x, y, p);
+            nPixels += ex - sx + 1;
+        };
+
+        while (y0 >= x0)
+        {
+            drawline(x - y0, x + y0, y - x0);
+            if (x0 > 0) drawline(x - y0, x + y0, y + x0);
+
+            if (d < 0)
+                d += 4 * x0++ + 6;
+            else
+            {
+                if (x0 != y0)
+                {
+                    drawline(x - x0, x + x0, y - y0);
+                    drawline(x - x0, x + x0, y + y0);
+                }
+                d += 4 * (x0++ - y0--) + 10;
+            }
+        }
+        return nPixels;
+    }
+
+    // What DrawSprite() did before it drew spans
+    uint64_t DrawSpriteByPixel(int32_t x, int32_t y, olc::Sprite *sprite, int32_t scale, bool bFlipX)
+    {
+        for (int32_t i = 0; i < sprite->width; i++)
+            for (int32_t j = 0; j < sprite->height; j++)
+                for (int32_t is = 0; is < scale; is++)
+                    for (int32_t js = 0; js < scale; js++)
+                        Draw(x + i * scale + is, y + j * scale + js, sprite->GetPixel(bFlipX ? sprite->width - 1 - i : i, j));
+        return uint64_t(sprite->width) * sprite->height * scale * scale;
+    }
+
+    // Tiles the target with sprTile, partly off the edges
+    uint64_t TileSprites(int32_t scale, bool bFlipX, bool bSpans)
+    {
+        uint64_t nPixels = 0;
+        int32_t nSize = sprTile->width * scale;
+        for (int32_t y = -nSize / 3; y < nHeight; y += nSize)
+            for (int32_t x = -nSize / 3; x < nWidth; x += nSize)
+            {
+                if (bSpans)
+                {
+                    DrawSprite(x, y, sprTile.get(), scale, bFlipX ? olc::Sprite::HORIZ : olc::Sprite::NONE);
+                    nPixels += uint64_t(nSize) * nSize;
+                }
+                else
+                    nPixels += DrawSpriteByPixel(x, y, sprTile.get(), scale, bFlipX);
+            }
+        return nPixels;
+    }
+
+protected:
+    bool OnUserCreate() override
+    {
+        sprTarget = std::make_unique<olc::Sprite>(nWidth, nHeight);
+        sprReference = std::make_unique<olc::Sprite>(nWidth, nHeight);
+        sprBackground = std::make_unique<olc::Sprite>(nWidth, nHeight);
+        for (int y = 0; y < nHeight; y++)
+            for (int x = 0; x < nWidth; x++)
+                sprBackground->SetPixel(x, y, olc::Pixel(x * 7, y * 5, (x ^ y) * 3));
+
+        // Opaque, clear and translucent texels, so MASK and ALPHA have work to do
+        sprTile = std::make_unique<olc::Sprite>(48, 48);
+        for (int y = 0; y < 48; y++)
+            for (int x = 0; x < 48; x++)
+                sprTile->SetPixel(x, y, olc::Pixel(x * 5, 255 - y * 5, 128, ((x / 6 + y / 6) & 1) ? 255 : (x * y) & 0xFF));
+
+        olc::Pixel pSolid(40, 160, 220);
+        olc::Pixel pTranslucent(220, 120, 40, 150);
+        int32_t nRadius = std::min(nWidth, nHeight) / 2 - 8;
+        auto nRect = uint64_t(nWidth - 32) * (nHeight - 32);
+
+        std::cout << "kernels:     " << olc::Span::Path() << "\n";
+        std::cout << "threads:     " << std::thread::hardware_concurrency() << "\n";
+        std::cout << "target:      " << nWidth << "x" << nHeight << "\n\n";
+        std::cout << std::left << std::setw(22) << "primitive" << std::setw(8) << "mode" << std::right
+                  << std::setw(14) << "Mpx/s spans" << std::setw(14) << "Mpx/s tiles" << std::setw(14) << "Mpx/s Draw()"
+                  << std::setw(10) << "spans" << std::setw(10) << "tiles" << std::setw(8) << "match" << "\n";
+
+        Run("Clear", olc::Pixel::NORMAL,
+            [&]() { Clear(pSolid); return uint64_t(nWidth) * nHeight; },
+            [&]() { for (int y = 0; y < nHeight; y++) for (int x = 0; x < nWidth; x++) Draw(x, y, pSolid); return uint64_t(nWidth) * nHeight; });
+
+        for (auto mode : {olc::Pixel::NORMAL, olc::Pixel::ALPHA})
+        {
+            olc::Pixel p = (mode == olc::Pixel::ALPHA) ? pTranslucent : pSolid;
+            Run("FillRect", mode,
+                [&]() { FillRect(16, 16, nWidth - 32, nHeight - 32, p); return nRect; },
+                [&]() { for (int x = 16; x < nWidth - 16; x++) for (int y = 16; y < nHeight - 16; y++) Draw(x, y, p); return nRect; });
+
+            uint64_t nCircle = 0;
+            Run("FillCircle", mode,
+                [&]() { FillCircle(nWidth / 2, nHeight / 2, nRadius, p); return nCircle; },
+                [&]() { return nCircle = DrawCircleByPixel(nWidth / 2, nHeight / 2, nRadius, p); });
+        }
+
+        SetPixelBlend(0.75f);
+        Run("FillRect blend 0.75", olc::Pixel::ALPHA,
+            [&]() { FillRect(16, 16, nWidth - 32, nHeight - 32, pTranslucent); return nRect; },
+            [&]() { for (int x = 16; x < nWidth - 16; x++) for (int y = 16; y < nHeight - 16; y++) Draw(x, y, pTranslucent); return nRect; });
+        SetPixelBlend(1.0f);
+
+        for (auto mode : {olc::Pixel::NORMAL, olc::Pixel::MASK, olc::Pixel::ALPHA})
+            Run("DrawSprite", mode, [&]() { return TileSprites(1, false, true); }, [&]() { return TileSprites(1, false, false); });
+
+        Run("DrawSprite x2 flipped", olc::Pixel::NORMAL, [&]() { return TileSprites(2, true, true); }, [&]() { return TileSprites(2, true, false); });
+        Run("DrawSprite x2 flipped", olc::Pixel::ALPHA, [&]() { return TileSprites(2, true, true); }, [&]() { return TileSprites(2, true, false); });
+
+        // Many small primitives, where recording and binning cost the most
+        Run("FillCircle x500", olc::Pixel::ALPHA,
+            [&]()
+            {
+                uint64_t nPixels = 0;
+                for (int i = 0; i < 500; i++)
+                    FillCircle((i * 97) % nWidth, (i * 61) % nHeight, 12, pTranslucent), nPixels += 2 * 12 * 2 * 12;
+                return nPixels;
+            },
+            [&]()
+            {
+                uint64_t nPixels = 0;
+                for (int i = 0; i < 500; i++)
+                    DrawCircleByPixel((i * 97) % nWidth, (i * 61) % nHeight, 12, pTranslucent), nPixels += 2 * 12 * 2 * 12;
+                return nPixels;
+            });
+
+        // Primitives that plot through Draw(), deferred as one command each
+        for (auto mode : {olc::Pixel::NORMAL, olc::Pixel::ALPHA})
+        {
+            olc::Pixel p = (mode == olc::Pixel::ALPHA) ? pTranslucent : pSolid;
+            auto lines = [&]()
+            {
+                uint64_t nPixels = 0;
+                for (int i = 0; i < 2000; i++)
+                {
+                    int32_t y1 = (i * 37) % nHeight, y2 = (i * 91) % nHeight;
+                    DrawLine(0, y1, nWidth - 1, y2, p);
+                    nPixels += std::max(nWidth, std::abs(y2 - y1) + 1);
+                }
+                return nPixels;
+            };
+            Run("DrawLine x2000", mode, lines, lines);
+
+            auto circles = [&]()
+            {
+                for (int i = 0; i < 500; i++)
+                    DrawCircle((i * 97) % nWidth, (i * 61) % nHeight, 12 + i % 40, p);
+                return uint64_t(500) * 2 * 3 * 32;
+            };
+            Run("DrawCircle x500", mode, circles, circles);
+        }
+
+        for (uint32_t scale : {1u, 2u})
+            for (auto mode : {olc::Pixel::MASK, olc::Pixel::ALPHA})
+            {
+                // DrawString picks MASK or ALPHA itself, from the colour's alpha
+                olc::Pixel p = (mode == olc::Pixel::ALPHA) ? pTranslucent : pSolid;
+                auto strings = [&]()
+                {
+                    for (int i = 0; i < 200; i++)
+                        DrawString((i * 53) % nWidth, (i * 29) % nHeight, "The quick brown fox 0123456789", p, scale);
+                    return uint64_t(200) * 30 * 64 * scale * scale;
+                };
+                Run(scale == 1 ? "DrawString x200" : "DrawString x200 x2", mode, strings, strings);
+            }
+
+        // Nothing to show, the results are on stdout
+        return false;
+    }
+
+    bool OnUserUpdate(float fElapsedTime) override
+    {
+        return false;
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    int nWidth = (argc > 1) ? std::atoi(argv[1]) : 1280;
+    int nHeight = (argc > 2) ? std::atoi(argv[2]) : 720;
+    float fDuration = (argc > 3) ? float(std::atof(argv[3])) : 0.5f;
+
+    BenchCPU bench(nWidth, nHeight, fDuration);
+    if (bench.Construct(nWidth, nHeight, 1, 1))
+        bench.Start();
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Decal throughput benchmark for the OpenGL 3.3 renderer.
+// Draws a fixed number of small textured quads per frame and reports quads per second.
+//
+// g++ -o bench_decals bench_decals.cpp -lX11 -lGL -lpthread -lpng -lstdc++fs -std=c++17
+// LIBGL_ALWAYS_SOFTWARE=1 ./bench_decals [quads per frame] [seconds]
+//
+// LIBGL_ALWAYS_SOFTWARE=1 makes Mesa use llvmpipe, so results can be compared without a GPU.
+
+#define OLC_PGE_APPLICATION
+#define OLC_GFX_OPENGL33
+#include "olcPixelGameEngine.h"
+
+#include <cstdlib>
+
+class BenchDecals : public olc::PixelGameEngine
+{
+private:
+    int nQuadsPerFrame;
+    float fDuration;
+
+    olc::Renderable rendQuad;
+    uint32_t nSeed = 1;
+
+    int nWarmupFrames = 30;
+    int nFrames = 0;
+    uint64_t nQuads = 0;
+    std::chrono::steady_clock::time_point tpStart;
+
+    // Deterministic, so every run draws the same scene
+    uint32_t Rand()
+    {
+        nSeed = nSeed * 1664525u + 1013904223u;
+        return nSeed >> 8;
+    }
+
+public:
+    BenchDecals(int nQuadsPerFrame, float fDuration)
+    {
+        sAppName = "Decal Benchmark";
+        this->nQuadsPerFrame = nQuadsPerFrame;
+        this->fDuration = fDuration;
+    }
+
+protected:
+    bool OnUserCreate() override
+    {
+        rendQuad.Create(16, 16);
+        for (int y = 0; y < 16; y++)
+            for (int x = 0; x < 16; x++)
+                rendQuad.Sprite()->SetPixel(x, y, ((x ^ y) & 4) ? olc::WHITE : olc::GREY);
+        rendQuad.Decal()->Update();
+        return true;
+    }
+
+    bool OnUserUpdate(float fElapsedTime) override
+    {
+        if (nWarmupFrames > 0 && --nWarmupFrames == 0)
+            tpStart = std::chrono::steady_clock::now();
+
+        nSeed = 1;
+        for (int i = 0; i < nQuadsPerFrame; i++)
+        {
+            olc::vf2d pos = {float(Rand() % ScreenWidth()), float(Rand() % ScreenHeight())};
+            olc::Pixel tint = olc::Pixel(Rand() & 0xFF, Rand() & 0xFF, Rand() & 0xFF);
+            DrawDecal(pos, rendQuad.Decal(), {0.5f, 0.5f}, tint);
+        }
+
+        if (nWarmupFrames > 0)
+            return true;
+
+        nFrames++;
+        nQuads += nQuadsPerFrame;
+
+        float fElapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - tpStart).count();
+        if (fElapsed >= fDuration)
+        {
+            std::cout << "frames:        " << nFrames << "\n";
+            std::cout << "quads/frame:   " << nQuadsPerFrame << "\n";
+            std::cout << "frames/sec:    " << float(nFrames) / fElapsed << "\n";
+            std::cout << "quads/sec:     " << float(nQuads) / fElapsed << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    int nQuadsPerFrame = (argc > 1) ? std::atoi(argv[1]) : 20000;
+    float fDuration = (argc > 2) ? float(std::atof(argv[2])) : 5.0f;
+
+    BenchDecals bench(nQuadsPerFrame, fDuration);
+    if (bench.Construct(640, 480, 1, 1, false, false))
+        bench.Start();
+
+    return 0;
+}
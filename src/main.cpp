@@ -1,6 +1,10 @@
 #define OLC_PGE_APPLICATION
 #include "olcPixelGameEngine.h"
 
+// Headless builds have no audio device either, so the music is mixed in real time to nowhere
+#if defined(OLC_PGE_HEADLESS)
+#define SOUNDWAVE_USING_NULL
+#endif
 #define OLC_SOUNDWAVE
 #include "olcSoundWaveEngine.h"
 
@@ -10,6 +14,13 @@
 using namespace std;
 
 // g++ -o main main.cpp -lX11 -lGL -lpthread -lpng -lstdc++fs -std=c++17 -lpulse -lpulse-simple
+//
+// Headless build (CPU renderer, no X11/GL), e.g. for golden images on a server:
+// g++ -DOLC_PGE_HEADLESS -DOLC_GFX_SOFTWARE -DOLC_IMAGE_LIBPNG -o main_headless main.cpp -lpthread -lpng -lstdc++fs -std=c++17
+// ./main_headless --seed 1 --frames 120 --golden golden.png
+//
+// --capture frames.olccap records the renderer calls of every frame, for timing
+// renderer changes with mmm_replay.cpp
 
 enum
 {
@@ -132,6 +143,247 @@ struct maze
     }
 };
 
+// The maze seen as a (2W+1)x(2H+1) grid: odd rows/columns are path, even ones are
+// wall, so cells, the passages between them and the walls are all grid squares.
+// Open squares of the same kind are greedily merged into as few rectangles as possible
+struct mazeMesh
+{
+    enum
+    {
+        MESH_WALL = 0,
+        MESH_FLOOR,
+        MESH_START,
+        MESH_FINISH
+    };
+
+    struct rect
+    {
+        vec2d pos;  // in maze space
+        vec2d size; // in maze space
+        int material;
+    };
+
+    int m_nGridWidth = 0;
+    int m_nGridHeight = 0;
+    vector<uint8_t> m_grid;
+    vector<rect> m_rects;
+
+    // Maze space position of a grid row/column, and its width
+    static float GridToMaze(int c, int nPathWidth, int nWallWidth)
+    {
+        return (float)((c / 2) * (nPathWidth + nWallWidth) + ((c & 1) ? nWallWidth : 0));
+    }
+
+    static float GridSize(int c, int nPathWidth, int nWallWidth)
+    {
+        return (float)((c & 1) ? nPathWidth : nWallWidth);
+    }
+
+    // Rebuild whenever the maze changes. Only cells set in mask are meshed (all if empty)
+    void Build(const maze &m, int nPathWidth, int nWallWidth, const vector<bool> &mask = {})
+    {
+        m_nGridWidth = 2 * m.m_nMazeWidth + 1;
+        m_nGridHeight = 2 * m.m_nMazeHeight + 1;
+        m_grid.assign(m_nGridWidth * m_nGridHeight, MESH_WALL);
+
+        for (int y = 0; y < m.m_nMazeHeight; y++)
+        {
+            for (int x = 0; x < m.m_nMazeWidth; x++)
+            {
+                if (!mask.empty() && !mask[y * m.m_nMazeWidth + x])
+                    continue;
+
+                int cell = m.m_nMaze[y * m.m_nMazeWidth + x];
+                uint8_t material = (cell & CELL_START) ? MESH_START : (cell & CELL_FINISH) ? MESH_FINISH
+                                                                                          : MESH_FLOOR;
+                int g = (2 * y + 1) * m_nGridWidth + 2 * x + 1;
+                m_grid[g] = material;
+                // Passages belong to the cell north/west of them
+                if (cell & CELL_PATH_EAST)
+                    m_grid[g + 1] = material;
+                if (cell & CELL_PATH_SOUTH)
+                    m_grid[g + m_nGridWidth] = material;
+            }
+        }
+
+        // Greedy: grow each unmerged square right as far as possible, then down
+        // while the whole span below is the same material
+        m_rects.clear();
+        vector<bool> merged(m_grid.size(), false);
+        auto open = [&](int gx, int gy, uint8_t material)
+        {
+            int g = gy * m_nGridWidth + gx;
+            return m_grid[g] == material && !merged[g];
+        };
+
+        for (int gy = 0; gy < m_nGridHeight; gy++)
+        {
+            for (int gx = 0; gx < m_nGridWidth; gx++)
+            {
+                uint8_t material = m_grid[gy * m_nGridWidth + gx];
+                if (material == MESH_WALL || merged[gy * m_nGridWidth + gx])
+                    continue;
+
+                int w = 1;
+                while (gx + w < m_nGridWidth && open(gx + w, gy, material))
+                    w++;
+
+                int h = 1;
+                while (gy + h < m_nGridHeight)
+                {
+                    bool bRowOpen = true;
+                    for (int i = 0; i < w && bRowOpen; i++)
+                        bRowOpen = open(gx + i, gy + h, material);
+                    if (!bRowOpen)
+                        break;
+                    h++;
+                }
+
+                for (int j = 0; j < h; j++)
+                    for (int i = 0; i < w; i++)
+                        merged[(gy + j) * m_nGridWidth + gx + i] = true;
+
+                rect r;
+                r.pos = {GridToMaze(gx, nPathWidth, nWallWidth), GridToMaze(gy, nPathWidth, nWallWidth)};
+                r.size = {GridToMaze(gx + w - 1, nPathWidth, nWallWidth) + GridSize(gx + w - 1, nPathWidth, nWallWidth) - r.pos.x,
+                          GridToMaze(gy + h - 1, nPathWidth, nWallWidth) + GridSize(gy + h - 1, nPathWidth, nWallWidth) - r.pos.y};
+                r.material = material;
+                m_rects.push_back(r);
+            }
+        }
+    }
+};
+
+// Cells in line of sight of the player, by recursive shadow casting over the mazeMesh
+// grid (wall squares block). Only recomputed when the player moves to another cell
+struct fieldOfView
+{
+    vector<bool> m_visible; // one per maze cell
+    int m_nCellX = -1;
+    int m_nCellY = -1;
+
+    void Invalidate()
+    {
+        m_nCellX = m_nCellY = -1;
+    }
+
+    // fRadius is in grid squares. Returns true if the visible set was recomputed
+    bool Update(const maze &m, const mazeMesh &mesh, int nCellX, int nCellY, float fRadius)
+    {
+        if (nCellX == m_nCellX && nCellY == m_nCellY)
+            return false;
+        m_nCellX = nCellX;
+        m_nCellY = nCellY;
+
+        m_visible.assign(m.m_nMazeWidth * m.m_nMazeHeight, false);
+        m_visible[nCellY * m.m_nMazeWidth + nCellX] = true;
+
+        // Octant transforms, from (column, row) of the scan to grid x/y
+        static const int octants[8][4] = {
+            {1, 0, 0, 1}, {0, 1, 1, 0}, {0, -1, 1, 0}, {-1, 0, 0, 1},
+            {-1, 0, 0, -1}, {0, -1, -1, 0}, {0, 1, -1, 0}, {1, 0, 0, -1}};
+
+        for (auto &o : octants)
+            CastLight(m, mesh, 2 * nCellX + 1, 2 * nCellY + 1, 1, 1.0f, 0.0f, fRadius, o[0], o[1], o[2], o[3]);
+        return true;
+    }
+
+    void CastLight(const maze &m, const mazeMesh &mesh, int cx, int cy, int row, float fStart, float fEnd, float fRadius, int xx, int xy, int yx, int yy)
+    {
+        if (fStart < fEnd)
+            return;
+
+        float fNewStart = 0.0f;
+        for (int j = row; j <= (int)fRadius; j++)
+        {
+            bool bBlocked = false;
+            for (int dx = -j, dy = -j; dx <= 0; dx++)
+            {
+                int gx = cx + dx * xx + dy * xy;
+                int gy = cy + dx * yx + dy * yy;
+                float fLeftSlope = (dx - 0.5f) / (dy + 0.5f);
+                float fRightSlope = (dx + 0.5f) / (dy - 0.5f);
+
+                if (fStart < fRightSlope)
+                    continue;
+                if (fEnd > fLeftSlope)
+                    break;
+
+                bool bInside = gx >= 0 && gy >= 0 && gx < mesh.m_nGridWidth && gy < mesh.m_nGridHeight;
+                bool bWall = !bInside || mesh.m_grid[gy * mesh.m_nGridWidth + gx] == mazeMesh::MESH_WALL;
+
+                // Cells sit on odd grid squares
+                if (bInside && (gx & 1) && (gy & 1) && (float)(dx * dx + dy * dy) <= fRadius * fRadius)
+                    m_visible[(gy / 2) * m.m_nMazeWidth + gx / 2] = true;
+
+                if (bBlocked)
+                {
+                    if (bWall)
+                    {
+                        fNewStart = fRightSlope;
+                        continue;
+                    }
+                    bBlocked = false;
+                    fStart = fNewStart;
+                }
+                else if (bWall && j < (int)fRadius)
+                {
+                    bBlocked = true;
+                    CastLight(m, mesh, cx, cy, j + 1, fStart, fLeftSlope, fRadius, xx, xy, yx, yy);
+                    fNewStart = fRightSlope;
+                }
+            }
+            if (bBlocked)
+                break;
+        }
+    }
+};
+
+// Darkness over the maze, a few texels per cell, drawn as one filtered decal so
+// the GPU smooths it. Lit texels are those of visible cells, fading with distance
+// from the centre of the player's cell, so it only changes when that cell does
+struct lightMap
+{
+    static const int nTexelsPerCell = 4;
+
+    olc::Renderable m_map;
+    float m_fRadius = 0.0f;
+    int m_nMarginCells = 0; // dark border, wide enough to cover the view with the player at the maze edge
+
+    void Build(const maze &m, const fieldOfView &fov, int nTileWidth, float fRadius, int nMarginCells)
+    {
+        m_fRadius = fRadius;
+        m_nMarginCells = nMarginCells;
+
+        int w = (m.m_nMazeWidth + 2 * nMarginCells) * nTexelsPerCell;
+        int h = (m.m_nMazeHeight + 2 * nMarginCells) * nTexelsPerCell;
+        if (m_map.Sprite() == nullptr || m_map.Sprite()->width != w || m_map.Sprite()->height != h)
+            m_map.Create(w, h, true);
+
+        float fTexel = (float)nTileWidth / nTexelsPerCell;
+        vec2d light = {(fov.m_nCellX + 0.5f) * nTileWidth, (fov.m_nCellY + 0.5f) * nTileWidth};
+
+        for (int y = 0; y < h; y++)
+        {
+            for (int x = 0; x < w; x++)
+            {
+                int cellX = x / nTexelsPerCell - nMarginCells;
+                int cellY = y / nTexelsPerCell - nMarginCells;
+                float fLight = 0.0f;
+                if (cellX >= 0 && cellY >= 0 && cellX < m.m_nMazeWidth && cellY < m.m_nMazeHeight &&
+                    fov.m_visible[cellY * m.m_nMazeWidth + cellX])
+                {
+                    vec2d texel = {(x + 0.5f) * fTexel - nMarginCells * nTileWidth, (y + 0.5f) * fTexel - nMarginCells * nTileWidth};
+                    float d = (texel - light).GetLength() / fRadius;
+                    fLight = fmaxf(0.0f, 1.0f - d * d);
+                }
+                m_map.Sprite()->SetPixel(x, y, olc::Pixel(0, 0, 0, (uint8_t)(255.0f * (1.0f - fLight))));
+            }
+        }
+        m_map.Decal()->Update();
+    }
+};
+
 struct player
 {
     vec2d pos = {0, 0};
@@ -270,16 +522,12 @@ private:
     float zoomNull;   // inspect mode
     float zoomSearch; // search mode
 
-    olc::Sprite *sprFading;
-    olc::Decal *decFading;
-    float lightScaleNormal;
-    float lightScaleSmall;
 
     // Sound Specific
     olc::sound::WaveEngine engine;
 
     olc::sound::Wave bg_music_memorize;
-    olc::sound::Wave bg_music_search;
+    olc::sound::WaveStream bg_music_search; // streamed from disk, too long to keep in memory
 
     bool bMenu;
     bool bMemorize; // is gameplay right now in the memorize mode or nt the find and find the exit mode?
@@ -311,72 +559,167 @@ private:
     float newZoom;
     vec2d lookTarget;
 
-    void DrawMaze(maze m_maze, player p_player, bool bLight, camera c_camera)
+    // Retained decals, recorded once and redrawn by the engine every frame
+    olc::DecalList dlBackground;
+    olc::DecalList dlMaze; // in maze space, placed by the camera each frame
+
+    // Merged floor rectangles of m_maze
+    mazeMesh m_mazeMesh;
+    // m_maze pre-rendered at 1, 1/2, 1/4... texels per maze unit, for zoomed-out views
+    vector<olc::Renderable> m_mazeLOD;
+
+    // Cells the player can see in remember mode, and their merged rectangles
+    fieldOfView m_fov;
+    mazeMesh m_visibleMesh;
+    lightMap m_lightMap;
+
+    // Draws the rectangles of mesh. visibleCells (one per cell, all if empty) only
+    // decides whether the start and finish signs are shown, the mesh is expected to
+    // have been built from it already
+    void DrawMaze(mazeMesh &mesh, const vector<bool> &visibleCells, camera c_camera, bool bCull = true)
     {
-        for (int x = 0; x < m_maze.m_nMazeWidth; x++)
+        auto onScreen = [&](vec2d pos, vec2d size_projected)
         {
-            for (int y = 0; y < m_maze.m_nMazeHeight; y++)
+            vec2d topLeft_projected = c_camera.Project(pos);
+            return !bCull ||
+                   (topLeft_projected.x > -size_projected.x && topLeft_projected.y > -size_projected.y &&
+                    topLeft_projected.x < ScreenWidth() && topLeft_projected.y < ScreenHeight());
+        };
+
+        for (auto &r : mesh.m_rects)
+        {
+            olc::Decal *decal = decFloor[r.material - mazeMesh::MESH_FLOOR];
+            vec2d size_projected = r.size * c_camera.zoom;
+
+            if (onScreen(r.pos, size_projected))
             {
-                olc::Pixel color = (m_maze.m_nMaze[y * m_maze.m_nMazeWidth + x] & CELL_START) ? m_maze.startColor : (m_maze.m_nMaze[y * m_maze.m_nMazeWidth + x] & CELL_FINISH) ? m_maze.finishColor
-                                                                                                                                                                                : m_maze.floorColor;
-                int x_transformed = m_nWallWidth + x * m_nTileWidth;
-                int y_transformed = m_nWallWidth + y * m_nTileWidth;
-                vec2d center = {(float)x_transformed + 0.5f * m_nTileWidth, (float)y_transformed + 0.5f * m_nTileWidth};
-
-                vec2d topLeft_projected = c_camera.Project({(float)x_transformed, (float)y_transformed});
-                float newPathW = (float)m_nPathWidth * c_camera.zoom;
-                float newWallW = (float)m_nWallWidth * c_camera.zoom;
-                float newTileW = newPathW + newWallW;
-
-                vec2d scale = {newPathW / decFloor[0]->sprite->width, newPathW / decFloor[0]->sprite->height};
-                vec2d scale_wall = {newWallW / decFloor[0]->sprite->width, newWallW / decFloor[0]->sprite->height};
-                olc::Decal *decal = (m_maze.m_nMaze[y * m_maze.m_nMazeWidth + x] & CELL_START) ? decFloor[1] : (m_maze.m_nMaze[y * m_maze.m_nMazeWidth + x] & CELL_FINISH) ? decFloor[2]
-                                                                                                                                                                           : decFloor[0];
-
-                float r_vision2 = p_player.visionRadius * p_player.visionRadius;
-                float distance2 = (p_player.pos - center).GetLengthSqared();
-
-                if (topLeft_projected.x > -newTileW && topLeft_projected.y > -newTileW &&
-                    topLeft_projected.x < ScreenWidth() && topLeft_projected.y < ScreenHeight() &&
-                    (bLight || (distance2 < r_vision2)))
-                {
-                    DrawDecal({topLeft_projected.x, topLeft_projected.y}, decal, {scale.x, scale.y});
-                    // FillRect(topLeft_projected.x, topLeft_projected.y, newPathW, newPathW, color);
+                vec2d topLeft_projected = c_camera.Project(r.pos);
+                vec2d scale = {size_projected.x / decal->sprite->width, size_projected.y / decal->sprite->height};
+                DrawDecal({topLeft_projected.x, topLeft_projected.y}, decal, {scale.x, scale.y});
+            }
+        }
 
-                    if (m_maze.m_nMaze[y * m_maze.m_nMazeWidth + x] & CELL_PATH_SOUTH)
-                        DrawDecal({topLeft_projected.x, topLeft_projected.y + newPathW}, decal, {scale.x, scale_wall.y});
-                    if (m_maze.m_nMaze[y * m_maze.m_nMazeWidth + x] & CELL_PATH_EAST)
-                        DrawDecal({topLeft_projected.x + newPathW, topLeft_projected.y}, decal, {scale_wall.x, scale.y});
+        // Start and finish signs, drawn when their cell is
+        auto cellShown = [&](int x, int y)
+        {
+            vec2d size = {(float)m_nPathWidth, (float)m_nPathWidth};
+            return (visibleCells.empty() || visibleCells[y * m_maze.m_nMazeWidth + x]) &&
+                   onScreen(CellTopLeft(x, y), size * c_camera.zoom);
+        };
+        if (cellShown(m_maze.start_x, m_maze.start_y))
+            DrawSign(m_maze.start_x, m_maze.start_y, CELL_START, decStart, 2.0f, c_camera);
+        if (cellShown(m_maze.finish_x, m_maze.finish_y))
+            DrawSign(m_maze.finish_x, m_maze.finish_y, CELL_FINISH, decFinish, -2.0f, c_camera);
+    }
 
-                    if (decal == decFloor[1])
-                    {
-                        vec2d scaleStart = {newPathW * 3.0f / decStart->sprite->width, newPathW * 3.0f / decStart->sprite->height};
-                        DrawDecal({topLeft_projected.x - newPathW * 1.5f, topLeft_projected.y + newPathW * 2.0f}, decStart, {scaleStart.x, scaleStart.y});
-                    }
-                    else if (decal == decFloor[2])
-                    {
-                        vec2d scaleFinish = {newPathW * 3.0f / decFinish->sprite->width, newPathW * 3.0f / decFinish->sprite->height};
-                        DrawDecal({topLeft_projected.x - newPathW * 1.5f, topLeft_projected.y - newPathW * 2.0f}, decFinish, {scaleFinish.x, scaleFinish.y});
-                    }
+    vec2d CellTopLeft(int x, int y)
+    {
+        return {(float)(m_nWallWidth + x * m_nTileWidth), (float)(m_nWallWidth + y * m_nTileWidth)};
+    }
+
+    void DrawSign(int x, int y, int flag, olc::Decal *decSign, float fOffsetY, camera c_camera)
+    {
+        if (!(m_maze.m_nMaze[y * m_maze.m_nMazeWidth + x] & flag))
+            return;
+
+        float newPathW = (float)m_nPathWidth * c_camera.zoom;
+        vec2d topLeft_projected = c_camera.Project(CellTopLeft(x, y));
+        vec2d scaleSign = {newPathW * 3.0f / decSign->sprite->width, newPathW * 3.0f / decSign->sprite->height};
+        DrawDecal({topLeft_projected.x - newPathW * 1.5f, topLeft_projected.y + newPathW * fOffsetY}, decSign, {scaleSign.x, scaleSign.y});
+    }
+
+    // Pre-renders the maze at one texel per maze unit, then halves it level by level.
+    // Walls stay transparent so the background shows through, as with the decals
+    void BuildMazeLOD()
+    {
+        m_mazeLOD.clear();
+
+        int w = m_maze.m_nMazeWidth * m_nTileWidth + m_nWallWidth;
+        int h = m_maze.m_nMazeHeight * m_nTileWidth + m_nWallWidth;
 
-                    /*// Draw passageways between cells
-                    for (float p = 0.0f; p < newPathW; p++)
+        olc::Renderable level;
+        level.Create(w, h, true);
+        olc::Sprite *spr = level.Sprite();
+        std::fill(spr->GetData(), spr->GetData() + w * h, olc::BLANK);
+        for (auto &r : m_mazeMesh.m_rects)
+        {
+            olc::Sprite *sprTex = sprFloor[r.material - mazeMesh::MESH_FLOOR];
+            for (int y = (int)r.pos.y; y < (int)(r.pos.y + r.size.y); y++)
+                for (int x = (int)r.pos.x; x < (int)(r.pos.x + r.size.x); x++)
+                    spr->SetPixel(x, y, sprTex->Sample(((float)x - r.pos.x + 0.5f) / r.size.x, ((float)y - r.pos.y + 0.5f) / r.size.y));
+        }
+        level.Decal()->Update();
+        m_mazeLOD.push_back(std::move(level));
+
+        while (w > 4 && h > 4)
+        {
+            olc::Sprite *sprSrc = m_mazeLOD.back().Sprite();
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+
+            olc::Renderable next;
+            next.Create(w, h, true);
+            for (int y = 0; y < h; y++)
+            {
+                for (int x = 0; x < w; x++)
+                {
+                    // 2x2 box filter, colour weighted by alpha so floor edges don't darken
+                    int r = 0, g = 0, b = 0, a = 0;
+                    for (int j = 0; j < 2; j++)
                     {
-                        for (float k = 0.0f; k < newPathW; k++)
+                        for (int i = 0; i < 2; i++)
                         {
-                            if (m_maze.m_nMaze[y * m_maze.m_nMazeWidth + x] & CELL_PATH_SOUTH)
-                                Draw(topLeft_projected.x + p, topLeft_projected.y + newPathW + k, color); // Draw South Passage
-
-                            if (m_maze.m_nMaze[y * m_maze.m_nMazeWidth + x] & CELL_PATH_EAST)
-                                Draw(topLeft_projected.x + newPathW + k, topLeft_projected.y + p, color); // Draw East Passage
+                            olc::Pixel p = sprSrc->GetPixel(min(2 * x + i, sprSrc->width - 1), min(2 * y + j, sprSrc->height - 1));
+                            r += p.r * p.a;
+                            g += p.g * p.a;
+                            b += p.b * p.a;
+                            a += p.a;
                         }
-                    }*/
+                    }
+                    next.Sprite()->SetPixel(x, y, a > 0 ? olc::Pixel(r / a, g / a, b / a, a / 4) : olc::BLANK);
                 }
             }
+            next.Decal()->Update();
+            m_mazeLOD.push_back(std::move(next));
         }
     }
 
-    void DrawPlayer(player p, camera c_camera, olc::Decal *decFading, vec2d spriteScale)
+    // Zoomed out, the whole maze is a single decal: the LOD level closest to one
+    // texel per screen pixel, without going below it
+    void DrawMazeLOD(camera c_camera)
+    {
+        int level = 0;
+        while (level + 1 < (int)m_mazeLOD.size() && c_camera.zoom * (float)(2 << level) <= 1.0f)
+            level++;
+
+        olc::Sprite *sprFull = m_mazeLOD[0].Sprite();
+        olc::Decal *decal = m_mazeLOD[level].Decal();
+        vec2d topLeft_projected = c_camera.Project({0.0f, 0.0f});
+        vec2d scale = {c_camera.zoom * sprFull->width / decal->sprite->width, c_camera.zoom * sprFull->height / decal->sprite->height};
+        DrawDecal({topLeft_projected.x, topLeft_projected.y}, decal, {scale.x, scale.y});
+
+        DrawSign(m_maze.start_x, m_maze.start_y, CELL_START, decStart, 2.0f, c_camera);
+        DrawSign(m_maze.finish_x, m_maze.finish_y, CELL_FINISH, decFinish, -2.0f, c_camera);
+    }
+
+    // Call whenever the maze changes. Records the whole maze unprojected, the camera
+    // transform is applied per frame
+    void RecordMaze()
+    {
+        m_mazeMesh.Build(m_maze, m_nPathWidth, m_nWallWidth);
+        BuildMazeLOD();
+        m_fov.Invalidate();
+
+        camera c_identity = c_camera;
+        c_identity.origin = {0.0f, 0.0f};
+        c_identity.zoom = 1.0f;
+
+        BeginDecalList(&dlMaze);
+        DrawMaze(m_mazeMesh, {}, c_identity, false);
+        EndDecalList();
+    }
+
+    void DrawPlayer(player p, camera c_camera)
     {
 
         vec2d p_draw_pos = p.pos;
@@ -414,30 +757,32 @@ private:
             // DrawCircle(p_pos_projected.x, p_pos_projected.y, p_r_projected, olc::WHITE);
             DrawDecal({p_pos_projected.x - p_r_projected, p_pos_projected.y - p_r_projected}, decPlayer, {scale.x, scale.y});
         }
+    }
 
-        if (!bLight)
-        {
-            // Width and hight of the sprite relative in screen space
-            float darkW = spriteScale.x * (float)ScreenWidth();
-            float darkH = spriteScale.y * (float)ScreenHeight();
-
-            // top left of sprite in screen space
-            vec2d origin = {c_camera.center.x - darkW * 0.5f, c_camera.center.y - darkH * 0.5f};
-
-            // top left of sprite in camera space
-            vec2d origin_projected = c_camera.Project(origin);
+    void DrawLightMap(camera c_camera)
+    {
+        float fTexel = (float)m_nTileWidth / lightMap::nTexelsPerCell;
+        float fMargin = (float)(m_lightMap.m_nMarginCells * m_nTileWidth);
+        vec2d topLeft_projected = c_camera.Project({-fMargin, -fMargin});
+        DrawDecal({topLeft_projected.x, topLeft_projected.y}, m_lightMap.m_map.Decal(), {fTexel * c_camera.zoom, fTexel * c_camera.zoom});
+    }
 
-            // sprite width and height in camera space
-            vec2d scale = {darkW / decFading->sprite->width * c_camera.zoom, darkH / decFading->sprite->height * c_camera.zoom};
+    // The menu and ending screens don't move, so once one has been shown the
+    // engine can idle until a key is pressed
+    enum stillScreen { SCREEN_NONE, SCREEN_MENU, SCREEN_END };
+    stillScreen m_lastScreen = SCREEN_NONE;
 
-            DrawDecal({origin_projected.x, origin_projected.y}, decFading, {scale.x, scale.y});
-        }
-    }
+    // Optional run limits, set from the command line
+    int m_nFrameLimit = 0;
+    int m_nFrameCount = 0;
+    std::string m_sGoldenFile;
 
 public:
-    MMM()
+    MMM(int nFrameLimit = 0, const std::string &sGoldenFile = "")
     {
         sAppName = "Memory Maze Man!";
+        m_nFrameLimit = nFrameLimit;
+        m_sGoldenFile = sGoldenFile;
     }
 
 protected:
@@ -452,12 +797,13 @@ protected:
         m_nTileWidth = m_nPathWidth + m_nWallWidth;
 
         m_maze.wallColor = olc::Pixel(10, 10, 10);
+        // Floors are drawn at a fraction of their size, so they get mipmaps to keep from shimmering
         sprFloor[0] = new olc::Sprite("MMM_floor_v0.png"); // regular tile
-        decFloor[0] = new olc::Decal(sprFloor[0]);
+        decFloor[0] = new olc::Decal(sprFloor[0], false, true, true);
         sprFloor[1] = new olc::Sprite("MMM_floor_start_finish_v0.png"); // start tile
-        decFloor[1] = new olc::Decal(sprFloor[1]);
+        decFloor[1] = new olc::Decal(sprFloor[1], false, true, true);
         sprFloor[2] = new olc::Sprite("MMM_floor_start_finish_v0.png"); // finish tile
-        decFloor[2] = new olc::Decal(sprFloor[2]);
+        decFloor[2] = new olc::Decal(sprFloor[2], false, true, true);
 
         sprGameBG = new olc::Sprite("MMM_bg_v0.1.png");
         decGameBG = new olc::Decal(sprGameBG);
@@ -486,17 +832,13 @@ protected:
         newZoom = zoomNull;
         lookTarget = {(float)m_nMazeWidth * 0.5f * m_nTileWidth, (float)m_nMazeHeight * 0.5f * m_nTileWidth};
 
-        sprFading = new olc::Sprite("MMM_darken_v0.1.png");
-        decFading = new olc::Decal(sprFading);
-        lightScaleNormal = 0.5f;
-        lightScaleSmall = 0.7f;
         p_player.visionRadius = (float)ScreenWidth() / zoomSearch * 0.75f;
 
-        bg_music_search.LoadAudioWaveform("MMM_OST_v0.wav");
+        bg_music_search.Open("MMM_OST_v0.wav");
         engine.InitialiseAudio(44100, 2);
         engine.SetOutputVolume(0.8f);
 
-        engine.PlayWaveform(&bg_music_search, true);
+        engine.PlayStream(&bg_music_search, true);
 
         bMenu = true;
         bMemorize = false;
@@ -525,6 +867,21 @@ protected:
         transCounter = 1.0f;
 
         bFinished = false;
+
+        BeginDecalList(&dlBackground);
+        DrawDecal({0, 0}, decGameBG, {bg_game_scale.x, bg_game_scale.y});
+        EndDecalList();
+        RecordMaze();
+        AddLayerDecalList(0, &dlBackground);
+        AddLayerDecalList(0, &dlMaze);
+
+        SetFrameRateLimit(120);
+        // Large mazes can be too much for slow machines at full size. Frame limited
+        // runs are compared image for image, so they always render at full size.
+        // The budget sits below a 60 Hz refresh so a display bound frame never
+        // counts as a slow one
+        if (m_nFrameLimit == 0)
+            EnableDynamicResolution(true, 0.014f, 0.5f);
         return true;
     }
 
@@ -643,6 +1000,7 @@ protected:
                     m_nMazeHeight += 2;
                     if (m_nMazeHeight >= 16.0f) bFinished = true;
                     m_maze.GenerateMaze(m_nMazeWidth, m_nMazeHeight);
+                    RecordMaze();
                     p_player.pos = {((float)m_maze.start_x + 0.5f) * m_nTileWidth, ((float)m_maze.start_y + 0.5f) * m_nTileWidth};
                     bFreeze = true;
 
@@ -672,9 +1030,12 @@ protected:
         ///////////////
 
         ////DRAWING////
+        dlBackground.bShow = false;
+        dlMaze.bShow = false;
+
         if (bFinished)
         {
-            DrawDecal({0, 0}, decGameBG, {bg_game_scale.x, bg_game_scale.y});
+            dlBackground.bShow = true;
             DrawStringDecal({(float)ScreenWidth() * 0.1f, (float)ScreenHeight() * 0.45f}, "Thank you for playing", olc::WHITE, {textSize, textSize});
             DrawStringDecal({(float)ScreenWidth() * 0.1f, (float)ScreenHeight() * 0.55f}, "MEMORY MAZE MAN!", olc::WHITE, {textSize, textSize});
         } 
@@ -689,11 +1050,11 @@ protected:
         }
         else if (bTransitionFromMenu)
         {
-            DrawDecal({0, 0}, decGameBG, {bg_game_scale.x, bg_game_scale.y});
+            dlBackground.bShow = true;
         }
         else if (bTransitionToLevel)
         {
-            DrawDecal({0, 0}, decGameBG, {bg_game_scale.x, bg_game_scale.y});
+            dlBackground.bShow = true;
             switch (m_nMazeWidth)
             {
             case 9:
@@ -716,12 +1077,19 @@ protected:
         else if (bMemorize)
         {
             // Clear(m_maze.wallColor);
-            DrawDecal({0, 0}, decGameBG, {bg_game_scale.x, bg_game_scale.y});
+            dlBackground.bShow = true;
 
-            // draw maze
-            DrawMaze(m_maze, p_player, true, c_camera);
+            // draw maze, from the LOD pyramid when zoomed out
+            if (c_camera.zoom < 1.0f)
+                DrawMazeLOD(c_camera);
+            else
+            {
+                dlMaze.bShow = true;
+                dlMaze.vOffset = {-c_camera.origin.x * c_camera.zoom, -c_camera.origin.y * c_camera.zoom};
+                dlMaze.vScale = {c_camera.zoom, c_camera.zoom};
+            }
             // draw player
-            // DrawPlayer(p_player, c_camera, decFading, {lightScaleNormal, lightScaleNormal});
+            // DrawPlayer(p_player, c_camera);
             if (bText)
             {
                 vec2d scaleInput = {(float)ScreenWidth() / decInput->sprite->width * 0.8f, (float)ScreenHeight() / decInput->sprite->height * 0.8f};
@@ -735,28 +1103,89 @@ protected:
         else if (bRemember)
         {
             // Clear(m_maze.wallColor);
-            DrawDecal({0, 0}, decGameBG, {bg_game_scale.x, bg_game_scale.y});
-
-            // draw maze
-            DrawMaze(m_maze, p_player, false, c_camera);
+            dlBackground.bShow = true;
+
+            // draw the part of the maze in sight, re-meshed when the player changes cell
+            int cellX = max(0, min(m_maze.m_nMazeWidth - 1, (int)(p_player.pos.x / m_nTileWidth)));
+            int cellY = max(0, min(m_maze.m_nMazeHeight - 1, (int)(p_player.pos.y / m_nTileWidth)));
+            bool bSightChanged = m_fov.Update(m_maze, m_mazeMesh, cellX, cellY, p_player.visionRadius / (0.5f * m_nTileWidth));
+            if (bSightChanged)
+                m_visibleMesh.Build(m_maze, m_nPathWidth, m_nWallWidth, m_fov.m_visible);
+            DrawMaze(m_visibleMesh, m_fov.m_visible, c_camera);
             // draw player
 
-            DrawPlayer(p_player, c_camera, decFading, {lightScaleSmall, lightScaleSmall});
+            DrawPlayer(p_player, c_camera);
+
+            // darkness, uploaded again only when the sight or the light radius changes. The
+            // margin reaches half the view past the maze, plus a cell for the camera's lag
+            int nMarginCells = (int)ceilf((float)max(ScreenWidth(), ScreenHeight()) / (2.0f * zoomSearch * m_nTileWidth)) + 1;
+            if (bSightChanged || m_lightMap.m_fRadius != p_player.visionRadius || m_lightMap.m_nMarginCells != nMarginCells)
+                m_lightMap.Build(m_maze, m_fov, m_nTileWidth, p_player.visionRadius, nMarginCells);
+            DrawLightMap(c_camera);
         }
         ////////////////
 
+        // Runs with a frame limit count frames, so they never idle
+        stillScreen screen = bFinished ? SCREEN_END : (bMenu && !bTransitionFromMenu) ? SCREEN_MENU : SCREEN_NONE;
+        if (screen != SCREEN_NONE && screen == m_lastScreen && m_nFrameLimit == 0)
+            IdleFrame();
+        m_lastScreen = screen;
+
+        if (m_nFrameLimit > 0 && ++m_nFrameCount >= m_nFrameLimit)
+            return false;
+
+        return true;
+    }
+
+    bool OnUserDestroy() override
+    {
+        // Stop mixing before the music stream goes away
+        engine.DestroyAudio();
+
+        // Only renderers that keep a CPU framebuffer (the software renderer) can save one
+        if (!m_sGoldenFile.empty() && GetFramebuffer() != nullptr)
+        {
+            if (olc::Sprite::loader->SaveImageResource(GetFramebuffer(), m_sGoldenFile) != olc::rcode::OK)
+                std::cerr << "Failed to write " << m_sGoldenFile << std::endl;
+        }
         return true;
     }
 };
 
-int main()
+int main(int argc, char *argv[])
 {
+    int nFrameLimit = 0;
+    std::string sGoldenFile;
+    std::string sCaptureFile;
+    bool bSeeded = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string sArg = argv[i];
+        if (sArg == "--frames" && i + 1 < argc)
+            nFrameLimit = std::atoi(argv[++i]);
+        else if (sArg == "--golden" && i + 1 < argc)
+            sGoldenFile = argv[++i];
+        else if (sArg == "--capture" && i + 1 < argc)
+            sCaptureFile = argv[++i];
+        else if (sArg == "--seed" && i + 1 < argc)
+        {
+            srand(unsigned(std::atoi(argv[++i])));
+            bSeeded = true;
+        }
+    }
+
     // Seed random number generator
-    srand(clock());
+    if (!bSeeded)
+        srand(clock());
 
-    MMM demo;
+    MMM demo(nFrameLimit, sGoldenFile);
     if (demo.Construct(578, 578, 1, 1, false))
+    {
+        if (!sCaptureFile.empty() && demo.EnableRenderCapture(sCaptureFile) != olc::rcode::OK)
+            std::cerr << "Failed to open " << sCaptureFile << std::endl;
         demo.Start();
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,122 @@
+// Replays a renderer capture and reports frame timings.
+// Capture frames from MMM with "./main --capture frames.olccap", then time them on
+// whichever renderer this tool is built for, without running the game:
+//
+// g++ -o mmm_replay mmm_replay.cpp -lX11 -lGL -lpthread -lpng -lstdc++fs -std=c++17
+// g++ -DOLC_GFX_OPENGL33 -o mmm_replay33 mmm_replay.cpp -lX11 -lGL -lpthread -lpng -lstdc++fs -std=c++17
+// g++ -O2 -DOLC_PGE_HEADLESS -DOLC_GFX_SOFTWARE -DOLC_IMAGE_LIBPNG -o mmm_replay_sw mmm_replay.cpp -lpthread -lpng -lstdc++fs -std=c++17
+//
+// ./mmm_replay frames.olccap [--loops N] [--golden last_frame.png]
+//
+// The first captured frame also holds the game's startup uploads, so it is replayed
+// once, untimed. --golden only works with the software renderer.
+
+#define OLC_PGE_APPLICATION
+#include "olcPixelGameEngine.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+class MMMReplay : public olc::PixelGameEngine
+{
+private:
+    olc::RenderReplay &replay;
+    int nLoops;
+    std::string sGoldenFile;
+
+public:
+    MMMReplay(olc::RenderReplay &replay, int nLoops, const std::string &sGoldenFile)
+        : replay(replay), nLoops(nLoops), sGoldenFile(sGoldenFile)
+    {
+        sAppName = "MMM Replay";
+    }
+
+protected:
+    bool OnUserCreate() override
+    {
+        return true;
+    }
+
+    bool OnUserUpdate(float fElapsedTime) override
+    {
+        std::vector<double> vFrameTimes;
+
+        replay.PlayFrame(0);
+        for (int nLoop = 0; nLoop < nLoops; nLoop++)
+        {
+            for (size_t i = 1; i < replay.FrameCount(); i++)
+            {
+                auto tp1 = std::chrono::steady_clock::now();
+                replay.PlayFrame(i);
+                auto tp2 = std::chrono::steady_clock::now();
+                vFrameTimes.push_back(std::chrono::duration<double, std::milli>(tp2 - tp1).count());
+            }
+        }
+
+        if (!sGoldenFile.empty() && GetFramebuffer() != nullptr)
+            olc::Sprite::loader->SaveImageResource(GetFramebuffer(), sGoldenFile);
+
+        if (vFrameTimes.empty())
+        {
+            std::cout << "No frames to time" << std::endl;
+            return false;
+        }
+
+        double fTotal = 0.0;
+        for (double t : vFrameTimes)
+            fTotal += t;
+        std::sort(vFrameTimes.begin(), vFrameTimes.end());
+        auto Percentile = [&](double p) { return vFrameTimes[size_t(p * double(vFrameTimes.size() - 1))]; };
+
+        std::cout << "frames:        " << vFrameTimes.size() << "\n";
+        std::cout << "total ms:      " << fTotal << "\n";
+        std::cout << "mean ms:       " << fTotal / double(vFrameTimes.size()) << "\n";
+        std::cout << "min ms:        " << vFrameTimes.front() << "\n";
+        std::cout << "median ms:     " << Percentile(0.5) << "\n";
+        std::cout << "p95 ms:        " << Percentile(0.95) << "\n";
+        std::cout << "max ms:        " << vFrameTimes.back() << "\n";
+        std::cout << "frames/sec:    " << 1000.0 * double(vFrameTimes.size()) / fTotal << std::endl;
+        return false;
+    }
+
+    bool OnUserDestroy() override
+    {
+        // Free the replayed textures while the renderer still exists
+        replay.Clear();
+        return true;
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: " << argv[0] << " capture.olccap [--loops N] [--golden file.png]" << std::endl;
+        return 1;
+    }
+
+    int nLoops = 1;
+    std::string sGoldenFile;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string sArg = argv[i];
+        if (sArg == "--loops" && i + 1 < argc)
+            nLoops = std::max(1, std::atoi(argv[++i]));
+        else if (sArg == "--golden" && i + 1 < argc)
+            sGoldenFile = argv[++i];
+    }
+
+    olc::RenderReplay replay;
+    if (replay.Load(argv[1]) != olc::rcode::OK)
+    {
+        std::cout << "Could not load capture " << argv[1] << std::endl;
+        return 1;
+    }
+
+    MMMReplay app(replay, nLoops, sGoldenFile);
+    if (app.Construct(replay.GetScreenSize().x, replay.GetScreenSize().y,
+                      replay.GetPixelSize().x, replay.GetPixelSize().y, false, false))
+        app.Start();
+
+    return 0;
+}
@@ -395,6 +395,9 @@ int main()
 #include <algorithm>
 #include <array>
 #include <cstring>
+#include <mutex>
+#include <condition_variable>
+#include <tuple>
 #pragma endregion
 
 #define PGE_VER 223
@@ -439,13 +442,31 @@ int main()
 
 #define UNUSED(x) (void)(x)
 
+// O------------------------------------------------------------------------------O
+// | SIMD SELECTION, for the CPU span kernels                                     |
+// O------------------------------------------------------------------------------O
+// AVX2 is used when the compiler targets it (-mavx2, -march=native, /arch:AVX2),
+// SSE2 on any x86-64. Define OLC_SIMD_NONE to build the scalar kernels only
+#if !defined(OLC_SIMD_NONE)
+	#if defined(__AVX2__)
+		#include <immintrin.h>
+		#define OLC_SIMD_AVX2
+	#endif
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+		#define OLC_SIMD_SSE2
+	#endif
+#endif
+
 // O------------------------------------------------------------------------------O
 // | PLATFORM SELECTION CODE, Thanks slavka!                                      |
 // O------------------------------------------------------------------------------O
 
 #if defined(OLC_PGE_HEADLESS)
 	#define OLC_PLATFORM_HEADLESS
-	#define OLC_GFX_HEADLESS
+	#if !defined(OLC_GFX_SOFTWARE)
+		#define OLC_GFX_HEADLESS
+	#endif
 	#if !defined(OLC_IMAGE_STB) && !defined(OLC_IMAGE_GDI) && !defined(OLC_IMAGE_LIBPNG)
 		#define OLC_IMAGE_HEADLESS
 	#endif
@@ -478,7 +499,7 @@ int main()
 
 
 // Renderer
-#if !defined(OLC_GFX_OPENGL10) && !defined(OLC_GFX_OPENGL33) && !defined(OLC_GFX_DIRECTX10) && !defined(OLC_GFX_HEADLESS)
+#if !defined(OLC_GFX_OPENGL10) && !defined(OLC_GFX_OPENGL33) && !defined(OLC_GFX_DIRECTX10) && !defined(OLC_GFX_HEADLESS) && !defined(OLC_GFX_SOFTWARE)
 	#if !defined(OLC_GFX_CUSTOM_EX)
 		#if defined(OLC_PLATFORM_EMSCRIPTEN)
 			#define OLC_GFX_OPENGL33
@@ -829,16 +850,23 @@ namespace olc
 	class Decal
 	{
 	public:
-		Decal(olc::Sprite* spr, bool filter = false, bool clamp = true);
+		// With mipmaps, Update() also rebuilds a chain of prefiltered half size levels,
+		// which renderers sample from when the decal is drawn smaller than the sprite
+		Decal(olc::Sprite* spr, bool filter = false, bool clamp = true, bool mipmaps = false);
 		Decal(const uint32_t nExistingTextureResource, olc::Sprite* spr);
 		virtual ~Decal();
 		void Update();
 		void UpdateSprite();
 
+	private:
+		void UpdateMipLevels();
+
 	public: // But dont touch
 		int32_t id = -1;
 		olc::Sprite* sprite = nullptr;
 		olc::vf2d vUVScale = { 1.0f, 1.0f };
+		bool bMipmaps = false;
+		std::vector<std::unique_ptr<olc::Sprite>> vMipLevels; // Level 1 down to 1x1
 	};
 
 	enum class DecalMode
@@ -869,8 +897,8 @@ namespace olc
 		Renderable() = default;		
 		Renderable(Renderable&& r) : pSprite(std::move(r.pSprite)), pDecal(std::move(r.pDecal)) {}		
 		Renderable(const Renderable&) = delete;
-		olc::rcode Load(const std::string& sFile, ResourcePack* pack = nullptr, bool filter = false, bool clamp = true);
-		void Create(uint32_t width, uint32_t height, bool filter = false, bool clamp = true);
+		olc::rcode Load(const std::string& sFile, ResourcePack* pack = nullptr, bool filter = false, bool clamp = true, bool mipmaps = false);
+		void Create(uint32_t width, uint32_t height, bool filter = false, bool clamp = true, bool mipmaps = false);
 		olc::Decal* Decal() const;
 		olc::Sprite* Sprite() const;
 
@@ -884,6 +912,8 @@ namespace olc
 	// | Auxilliary components internal to engine                                     |
 	// O------------------------------------------------------------------------------O
 
+	struct DecalList;
+
 	struct DecalInstance
 	{
 		olc::Decal* decal = nullptr;
@@ -894,6 +924,34 @@ namespace olc
 		olc::DecalMode mode = olc::DecalMode::NORMAL;
 		olc::DecalStructure structure = olc::DecalStructure::FAN;
 		uint32_t points = 0;
+		// If set, this instance just places a retained list, using the
+		// transform (in pixels) that was active when it was submitted
+		const olc::DecalList* list = nullptr;
+		olc::vf2d vListOffset = { 0.0f, 0.0f };
+		olc::vf2d vListScale = { 1.0f, 1.0f };
+	};
+
+	// O------------------------------------------------------------------------------O
+	// | olc::DecalList - A retained batch of decals, recorded once, drawn many times |
+	// O------------------------------------------------------------------------------O
+	// Record with BeginDecalList()/EndDecalList() using the regular Draw...Decal()
+	// functions. The recorded geometry is then placed each frame by vScale and vOffset
+	// (pixels, p' = p * vScale + vOffset), so a scrolling/zooming scene does not need
+	// rebuilding. Renderers may cache the uploaded geometry until nRevision changes.
+	// Note: decals are recorded against the current screen size, and the olc::Decals
+	// referenced must outlive the list (or the list must be re-recorded)
+	struct DecalList
+	{
+		DecalList();
+		DecalList(const DecalList&) = delete;
+		~DecalList();
+
+		std::vector<DecalInstance> vecDecalInstance;
+		olc::vf2d vOffset = { 0.0f, 0.0f };
+		olc::vf2d vScale = { 1.0f, 1.0f };
+		bool bShow = true;
+		uint32_t nID = 0;
+		uint32_t nRevision = 0;
 	};
 
 	struct LayerDesc
@@ -902,13 +960,69 @@ namespace olc
 		olc::vf2d vScale = { 1, 1 };
 		bool bShow = false;
 		bool bUpdate = false;
+		// Region of pDrawTarget written since its last upload (empty if min >= max)
+		olc::vi2d vDirtyMin = { INT32_MAX, INT32_MAX };
+		olc::vi2d vDirtyMax = { INT32_MIN, INT32_MIN };
 		olc::Renderable pDrawTarget;
 		uint32_t nResID = 0;
 		std::vector<DecalInstance> vecDecalInstance;
+		std::vector<olc::DecalList*> vecDecalList;
 		olc::Pixel tint = olc::WHITE;
 		std::function<void()> funcHook = nullptr;
 	};
 
+	// O------------------------------------------------------------------------------O
+	// | olc::WorkerPool - Persistent threads for splitting work into jobs           |
+	// O------------------------------------------------------------------------------O
+	class WorkerPool
+	{
+	public:
+		// 0 threads means one fewer than the hardware has, as the caller works too
+		WorkerPool(uint32_t nThreads = 0);
+		WorkerPool(const WorkerPool&) = delete;
+		~WorkerPool();
+
+	public:
+		// Calls func(job) for every job in [0, nJobs) across the pool and the calling
+		// thread, returning when all are complete. Not reentrant.
+		void ParallelFor(uint32_t nJobs, const std::function<void(uint32_t)>& func);
+		uint32_t ThreadCount() const;
+		// Engine wide pool for CPU work started on the engine thread, made on first use
+		static WorkerPool& Shared();
+
+	private:
+		void Worker();
+		void RunJobs();
+
+		std::vector<std::thread> vThreads;
+		std::mutex muxPool;
+		std::condition_variable cvWork;
+		std::condition_variable cvDone;
+		const std::function<void(uint32_t)>* pJobFunc = nullptr;
+		uint32_t nJobs = 0;
+		std::atomic<uint32_t> nNextJob{ 0 };
+		uint32_t nBusyWorkers = 0;
+		uint64_t nGeneration = 0;
+		bool bQuit = false;
+	};
+
+	// O------------------------------------------------------------------------------O
+	// | olc::Span - Kernels for runs of pixels, used by the CPU drawing routines    |
+	// O------------------------------------------------------------------------------O
+	namespace Span
+	{
+		// Instruction set the kernels were built for, "AVX2", "SSE2" or "scalar"
+		const char* Path();
+		void Fill(olc::Pixel* dst, const olc::Pixel p, int32_t n);
+		void Copy(olc::Pixel* dst, const olc::Pixel* src, int32_t n);
+		// Copies the fully opaque pixels only, as Pixel::MASK
+		void CopyMasked(olc::Pixel* dst, const olc::Pixel* src, int32_t n);
+		// Blends as Pixel::ALPHA, nBlend is the pixel blend factor scaled to 0 - 256
+		void Blend(olc::Pixel* dst, const olc::Pixel* src, int32_t n, uint32_t nBlend);
+		void BlendColour(olc::Pixel* dst, const olc::Pixel p, int32_t n, uint32_t nBlend);
+		olc::Pixel BlendPixel(const olc::Pixel d, const olc::Pixel s, uint32_t nBlend);
+	}
+
 	class Renderer
 	{
 	public:
@@ -921,13 +1035,29 @@ namespace olc
 		virtual void	   SetDecalMode(const olc::DecalMode& mode) = 0;
 		virtual void       DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) = 0;
 		virtual void       DrawDecal(const olc::DecalInstance& decal) = 0;
+		// Retained lists arrive with their transform already in NDC. By default the
+		// instances are transformed and drawn one by one, renderers may cache instead
+		virtual void       DrawDecalList(const olc::DecalList& list, const olc::vf2d& offset, const olc::vf2d& scale);
+		virtual void       ReleaseDecalList(const uint32_t id) { UNUSED(id); }
 		virtual uint32_t   CreateTexture(const uint32_t width, const uint32_t height, const bool filtered = false, const bool clamp = true) = 0;
 		virtual void       UpdateTexture(uint32_t id, olc::Sprite* spr) = 0;
+		// Uploads only part of a sprite, by default the whole sprite goes anyway
+		virtual void       UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) { UNUSED(pos); UNUSED(size); UpdateTexture(id, spr); }
+		// Levels 1 and up of the bound texture, following its UpdateTexture(). Renderers
+		// that can't sample mipmaps ignore them
+		virtual void       UpdateTextureMipLevels(uint32_t id, const std::vector<std::unique_ptr<olc::Sprite>>& vLevels) { UNUSED(id); UNUSED(vLevels); }
 		virtual void       ReadTexture(uint32_t id, olc::Sprite* spr) = 0;
 		virtual uint32_t   DeleteTexture(const uint32_t id) = 0;
 		virtual void       ApplyTexture(uint32_t id) = 0;
 		virtual void       UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) = 0;
 		virtual void       ClearBuffer(olc::Pixel p, bool bDepth) = 0;
+		// Dynamic resolution - after BeginScaledFrame() the frame is drawn into vRenderSize
+		// pixels at the viewport's corner, and EndScaledFrame() stretches it over the whole
+		// viewport. Returns false if the renderer can't, and the frame is drawn as usual
+		virtual bool       BeginScaledFrame(const olc::vi2d& vRenderSize) { UNUSED(vRenderSize); return false; }
+		virtual void       EndScaledFrame() {}
+		// Renderers that draw on the CPU can expose the last displayed frame
+		virtual olc::Sprite* GetFramebuffer() { return nullptr; }
 		static olc::PixelGameEngine* ptrPGE;
 	};
 
@@ -966,6 +1096,9 @@ namespace olc
 		olc::rcode Construct(int32_t screen_w, int32_t screen_h, int32_t pixel_w, int32_t pixel_h,
 			bool full_screen = false, bool vsync = false, bool cohesion = false);
 		olc::rcode Start();
+		// Records every renderer call into sFile, for replaying with olc::RenderReplay
+		// (see src/mmm_replay.cpp). Call before Start()
+		olc::rcode EnableRenderCapture(const std::string& sFile);
 
 	public: // User Override Interfaces
 		// Called once on application startup, use to load your resources
@@ -1012,6 +1145,9 @@ namespace olc
 		int32_t GetDrawTargetHeight() const;
 		// Returns the currently active draw target
 		olc::Sprite* GetDrawTarget() const;
+		// Returns the last displayed frame, only for renderers that keep it in a sprite
+		// (OLC_GFX_SOFTWARE), otherwise nullptr
+		olc::Sprite* GetFramebuffer() const;
 		// Resize the primary screen sprite
 		void SetScreenSize(int w, int h);
 		// Specify which Sprite should be the target of drawing functions, use nullptr
@@ -1034,7 +1170,8 @@ namespace olc
 		const olc::vi2d& GetDroppedFilesPoint() const;
 
 	public: // CONFIGURATION ROUTINES
-		// Layer targeting functions
+		// Layer targeting functions - pixels drawn to a layer are tracked and only
+		// the changed region is uploaded, bDirty forces the whole layer to upload
 		void SetDrawTarget(uint8_t layer, bool bDirty = true);
 		void EnableLayer(uint8_t layer, bool b);
 		void SetLayerOffset(uint8_t layer, const olc::vf2d& offset);
@@ -1142,6 +1279,15 @@ namespace olc
 		void DrawLineDecal(const olc::vf2d& pos1, const olc::vf2d& pos2, Pixel p = olc::WHITE);
 		void DrawRotatedStringDecal(const olc::vf2d& pos, const std::string& sText, const float fAngle, const olc::vf2d& center = { 0.0f, 0.0f }, const olc::Pixel col = olc::WHITE, const olc::vf2d& scale = { 1.0f, 1.0f });
 		void DrawRotatedStringPropDecal(const olc::vf2d& pos, const std::string& sText, const float fAngle, const olc::vf2d& center = { 0.0f, 0.0f }, const olc::Pixel col = olc::WHITE, const olc::vf2d& scale = { 1.0f, 1.0f });
+		// Retained decal lists - decals drawn between Begin and End are recorded into
+		// the list instead of the current layer
+		void BeginDecalList(olc::DecalList* list);
+		void EndDecalList();
+		// Places a recorded list in this frame, in order with other decals, using its transform
+		void DrawDecalList(olc::DecalList* list);
+		// Keeps a recorded list on a layer, drawn every frame (before that frame's decals)
+		void AddLayerDecalList(uint8_t layer, olc::DecalList* list);
+		void RemoveLayerDecalList(uint8_t layer, olc::DecalList* list);
 		// Clears entire draw target to Pixel
 		void Clear(Pixel p);
 		// Clears the rendering back buffer
@@ -1155,6 +1301,29 @@ namespace olc
 		// Dont allow PGE to mark layers as dirty, so pixel graphics don't update
 		void EnablePixelTransfer(const bool bEnable = true);
 
+		// Record CPU drawing instead of doing it straight away, the commands are then
+		// rasterized in parallel over tiles of the draw target. They are flushed before
+		// the layers are uploaded, when the draw target changes, or by FlushDrawing().
+		// Sprites are read when the commands run, so must not change or go away until
+		// then, and the draw target must be flushed before its pixels are read back
+		void EnableDeferredDrawing(const bool bEnable = true);
+		void FlushDrawing();
+
+		// Frame pacing - caps how often the engine loop runs, 0 (the default) runs it
+		// as fast as possible. The wait is measured from when the last frame was due, so
+		// a frame already held back by vsync isn't delayed again
+		void SetFrameRateLimit(const uint32_t nFPS);
+		uint32_t GetFrameRateLimit() const;
+		// Idle mode - call from OnUserUpdate() when this frame would look the same as the
+		// last one shown. It isn't rendered or presented, and the engine sleeps until
+		// input arrives or fWakeAfter seconds pass before the next update
+		void IdleFrame(const float fWakeAfter = 0.5f);
+		// Dynamic resolution - while frames take longer than fFrameBudget seconds, they are
+		// rendered to a smaller part of the viewport, down to fMinScale of its size, and
+		// stretched to fill it. Layers and decals are drawn at the reduced size alike
+		void EnableDynamicResolution(const bool bEnable = true, const float fFrameBudget = 1.0f / 60.0f, const float fMinScale = 0.5f);
+		float GetRenderScale() const;
+
 		// Command Console Routines
 		void ConsoleShow(const olc::Key &keyExit, bool bSuspendTime = true);
 		bool IsConsoleShowing() const;
@@ -1173,6 +1342,63 @@ namespace olc
 	private:
 		void UpdateTextEntry();
 		void UpdateConsole();
+		void olc_MarkDirty(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+		uint32_t olc_BlendFactor() const;
+
+		struct DrawSpan { int32_t y, x1, x2; };
+
+		// Where a CPU primitive lands: the draw target, the region of it that may be
+		// written, and the pixel mode in effect when it was drawn. With pRecordSpans
+		// set, filled spans are collected instead of drawn
+		struct RasterTarget
+		{
+			olc::Sprite* pTarget = nullptr;
+			olc::vi2d vClipMin = { 0, 0 };
+			olc::vi2d vClipMax = { 0, 0 };
+			Pixel::Mode nMode = Pixel::NORMAL;
+			uint32_t nBlend = 256;
+			const std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)>* pFuncCustom = nullptr;
+			std::vector<Pixel>* pScratch = nullptr;
+			std::vector<DrawSpan>* pRecordSpans = nullptr;
+			uint32_t nRecordFirst = 0;	// Spans recorded from here on are one shape's, so may be joined
+			const DrawSpan* pSpans = nullptr;
+		};
+
+		struct DrawCommand
+		{
+			enum class Type : uint8_t { PIXEL, CLEAR, RECT, CIRCLE, TRIANGLE, SPRITE, LINE, CIRCLE_OUTLINE, GLYPH };
+			Type type = Type::PIXEL;
+			Pixel::Mode nMode = Pixel::NORMAL;
+			uint8_t nFlip = 0;
+			uint32_t nBlend = 256;
+			Pixel p;
+			olc::vi2d pos[3];		// Pixel, rectangle, circle, sprite and glyph position, line ends, triangle corners
+			olc::vi2d size;			// Rectangle, sprite and glyph region size
+			olc::vi2d source;		// Sprite and glyph region offset
+			int32_t n = 0;			// Circle radius, sprite and glyph scale
+			uint32_t nPattern = 0;	// Line pattern, circle outline octant mask
+			olc::Sprite* sprite = nullptr;
+			olc::vi2d vMin, vMax;	// Pixels it may touch, [min, max)
+			uint32_t nSpanFirst = 0;	// Circle, triangle, line and outline spans, sorted by row, once binned
+			uint32_t nSpanCount = 0;
+		};
+
+		void olc_SubmitDraw(DrawCommand& cmd);
+		static void olc_RasterCommand(RasterTarget rt, const DrawCommand& cmd);
+		static void olc_FillSpan(const RasterTarget& rt, int32_t x1, int32_t x2, int32_t y, Pixel p);
+		static void olc_DrawSpan(const RasterTarget& rt, int32_t x, int32_t y, const Pixel* src, int32_t n);
+		static void olc_RasterCircle(const RasterTarget& rt, int32_t x, int32_t y, int32_t radius, Pixel p);
+		static void olc_RasterTriangle(const RasterTarget& rt, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p);
+		static void olc_RasterSprite(const RasterTarget& rt, int32_t x, int32_t y, Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, int32_t scale, uint8_t flip);
+		static void olc_RasterGlyph(const RasterTarget& rt, int32_t x, int32_t y, Sprite* font, int32_t ox, int32_t oy, int32_t w, int32_t scale, Pixel p);
+		template<typename Plot> static void olc_WalkLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t pattern, Plot plot);
+		template<typename Plot> static void olc_WalkCircle(int32_t x, int32_t y, int32_t radius, uint8_t mask, Plot plot);
+		void olc_SubmitGlyph(int32_t x, int32_t y, int32_t ox, int32_t oy, int32_t w, uint32_t scale, Pixel col);
+		void olc_UploadLayer(olc::LayerDesc& layer);
+		std::vector<olc::DecalInstance>& GetDecalTarget();
+		void olc_DrawDecalList(const olc::DecalList& list, const olc::vf2d& offset, const olc::vf2d& scale);
+		void olc_DrawStringGlyphs(const olc::vf2d& pos, const std::string& sText, const Pixel col, const olc::vf2d& scale);
+		void olc_BuildTextLayout(olc::DecalList& list, const std::string& sText, const Pixel col, const olc::vf2d& scale);
 
 	public:
 
@@ -1209,6 +1435,14 @@ namespace olc
 		olc::Sprite*     pDrawTarget = nullptr;
 		Pixel::Mode	nPixelMode = Pixel::NORMAL;
 		float		fBlendFactor = 1.0f;
+		std::vector<Pixel> vSpanScratch;
+		bool		bDeferDrawing = false;
+		std::vector<DrawCommand> vDrawCommands;
+		std::vector<std::vector<uint32_t>> vDrawTileBins;
+		std::vector<DrawSpan> vDrawSpans;
+		std::vector<DrawSpan> vDrawSpansSorted;
+		std::vector<uint32_t> vDrawRowStart;
+		static constexpr int32_t nDrawTileSize = 64;
 		olc::vi2d	vScreenSize = { 256, 240 };
 		olc::vf2d	vInvScreenSize = { 1.0f / 256.0f, 1.0f / 240.0f };
 		olc::vi2d	vPixelSize = { 4, 4 };
@@ -1233,12 +1467,50 @@ namespace olc
 		Renderable  fontRenderable;
 		std::vector<LayerDesc> vLayers;
 		uint8_t		nTargetLayer = 0;
+		bool		bDrawTargetIsLayer = true;
 		uint32_t	nLastFPS = 0;
 		bool        bPixelCohesion = false;
 		DecalMode   nDecalMode = DecalMode::NORMAL;
 		DecalStructure nDecalStructure = DecalStructure::FAN;
+		olc::DecalList* pRecordingList = nullptr;
+		// Strings drawn by DrawStringDecal() on more than one frame are laid out once,
+		// into a single triangle list instance, and placed as a retained list after that.
+		// A first sighting only leaves a hash in a fixed table, so text that changes
+		// every frame costs no allocations
+		struct TextLayout
+		{
+			olc::DecalList list;
+			uint32_t nLastFrame = 0;
+		};
+		struct TextSighting
+		{
+			size_t nHash = 0;
+			uint32_t nFrame = 0;
+		};
+		std::map<std::tuple<std::string, uint32_t, float, float, uint8_t>, std::unique_ptr<TextLayout>> mapTextLayouts;
+		static constexpr size_t nMaxTextLayouts = 256;
+		std::array<TextSighting, 256> vTextSightings{};
+		uint32_t	nTextLayoutFrame = 0;
+		bool		bTextLayoutsStale = false;
 		std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)> funcPixelMode;
-		std::chrono::time_point<std::chrono::system_clock> m_tp1, m_tp2;
+		std::chrono::time_point<std::chrono::steady_clock> m_tp1, m_tp2;
+		// Frame pacing and idle mode. Input and window events may come from the
+		// platform's thread, so they wake the idle wait through the atomics
+		uint32_t	nFrameRateLimit = 0;
+		std::chrono::steady_clock::time_point tpNextFrame;
+		bool		bIdleFrame = false;
+		float		fIdleWakeAfter = 0.0f;
+		std::atomic<bool> bIdleWake{ false };
+		std::atomic<bool> bForceRedraw{ true };
+		std::mutex	muxIdle;
+		std::condition_variable cvIdle;
+		// Dynamic resolution, the scale applies to both sides of the viewport
+		bool		bDynamicResolution = false;
+		float		fFrameBudget = 1.0f / 60.0f;
+		float		fMinRenderScale = 0.5f;
+		float		fRenderScale = 1.0f;
+		float		fFrameTimeAverage = 0.0f;
+		uint32_t	nFramesAtScale = 0;
 		std::vector<olc::vi2d> vFontSpacing;
 		std::vector<std::string> vDroppedFiles;
 		std::vector<std::string> vDroppedFilesCache;
@@ -1278,6 +1550,8 @@ namespace olc
 
 		// The main engine thread
 		void		EngineThread();
+		void		olc_PaceFrame();
+		void		olc_WakeFromIdle();
 
 
 		// If anything sets this flag to false, the engine
@@ -1292,6 +1566,8 @@ namespace olc
 		void olc_UpdateViewport();
 		void olc_ConstructFontSheet();
 		void olc_CoreUpdate();
+		void olc_PresentFrame();
+		void olc_UpdateRenderScale(float fFrameTime);
 		void olc_PrepareEngine();
 		void olc_UpdateMouseState(int32_t button, bool state);
 		void olc_UpdateKeyState(int32_t key, bool state);
@@ -1387,6 +1663,8 @@ namespace olc
 {
 	typedef char GLchar;
 	typedef ptrdiff_t GLsizeiptr;
+	typedef ptrdiff_t GLintptr;
+	typedef struct locGLsync_t* locGLsync;
 
 	typedef GLuint CALLSTYLE locCreateShader_t(GLenum type);
 	typedef GLuint CALLSTYLE locCreateProgram_t(void);
@@ -1416,6 +1694,14 @@ namespace olc
 	typedef void CALLSTYLE locFrameBufferTexture2D_t(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
 	typedef void CALLSTYLE locDrawBuffers_t(GLsizei n, const GLenum* bufs);
 	typedef void CALLSTYLE locBlendFuncSeparate_t(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+	typedef void CALLSTYLE locDeleteBuffers_t(GLsizei n, const GLuint* buffers);
+	typedef void CALLSTYLE locDeleteVertexArrays_t(GLsizei n, const GLuint* arrays);
+	typedef void CALLSTYLE locBufferSubData_t(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+	typedef void CALLSTYLE locBufferStorage_t(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+	typedef void* CALLSTYLE locMapBufferRange_t(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+	typedef locGLsync CALLSTYLE locFenceSync_t(GLenum condition, GLbitfield flags);
+	typedef GLenum CALLSTYLE locClientWaitSync_t(locGLsync sync, GLbitfield flags, uint64_t timeout);
+	typedef void CALLSTYLE locDeleteSync_t(locGLsync sync);
 
 #if defined(OLC_PLATFORM_WINAPI)
 	typedef void __stdcall locSwapInterval_t(GLsizei n);
@@ -1698,11 +1984,12 @@ namespace olc
 	// O------------------------------------------------------------------------------O
 	// | olc::Decal IMPLEMENTATION                                                    |
 	// O------------------------------------------------------------------------------O
-	Decal::Decal(olc::Sprite* spr, bool filter, bool clamp)
+	Decal::Decal(olc::Sprite* spr, bool filter, bool clamp, bool mipmaps)
 	{
 		id = -1;
 		if (spr == nullptr) return;
 		sprite = spr;
+		bMipmaps = mipmaps;
 		id = renderer->CreateTexture(sprite->width, sprite->height, filter, clamp);
 		Update();
 	}
@@ -1719,6 +2006,58 @@ namespace olc
 		vUVScale = { 1.0f / float(sprite->width), 1.0f / float(sprite->height) };
 		renderer->ApplyTexture(id);
 		renderer->UpdateTexture(id, sprite);
+		if (bMipmaps) UpdateMipLevels();
+	}
+
+	void Decal::UpdateMipLevels()
+	{
+		// Every level down to 1x1, as GL only samples from a complete chain
+		size_t nLevels = 0;
+		for (int32_t w = sprite->width, h = sprite->height; w > 1 || h > 1; w = std::max(w / 2, 1), h = std::max(h / 2, 1))
+			nLevels++;
+		vMipLevels.resize(nLevels);
+
+		olc::Sprite* src = sprite;
+		for (auto& level : vMipLevels)
+		{
+			int32_t w = std::max(src->width / 2, 1), h = std::max(src->height / 2, 1);
+			if (!level || level->width != w || level->height != h) level = std::make_unique<olc::Sprite>(w, h);
+			olc::Sprite* dst = level.get();
+
+			// 2x2 box filter, colour weighted by alpha so edges against transparent
+			// texels don't darken. An odd last row or column is left out
+			static constexpr int32_t nRowsPerJob = 16;
+			auto filter = [&](uint32_t nJob)
+			{
+				int32_t y1 = int32_t(nJob) * nRowsPerJob, y2 = std::min(y1 + nRowsPerJob, h);
+				for (int32_t y = y1; y < y2; y++)
+				{
+					const olc::Pixel* r0 = src->GetData() + std::min(y * 2, src->height - 1) * src->width;
+					const olc::Pixel* r1 = src->GetData() + std::min(y * 2 + 1, src->height - 1) * src->width;
+					olc::Pixel* out = dst->GetData() + y * w;
+					for (int32_t x = 0; x < w; x++)
+					{
+						int32_t x0 = std::min(x * 2, src->width - 1), x1 = std::min(x * 2 + 1, src->width - 1);
+						const olc::Pixel p[4] = { r0[x0], r0[x1], r1[x0], r1[x1] };
+						uint32_t a = 0, r = 0, g = 0, b = 0;
+						for (const auto& q : p) { a += q.a; r += q.r * q.a; g += q.g * q.a; b += q.b * q.a; }
+						if (a > 0)
+							out[x] = olc::Pixel(uint8_t((r + a / 2) / a), uint8_t((g + a / 2) / a), uint8_t((b + a / 2) / a), uint8_t((a + 2) / 4));
+						else
+							out[x] = olc::Pixel(uint8_t((p[0].r + p[1].r + p[2].r + p[3].r + 2) / 4), uint8_t((p[0].g + p[1].g + p[2].g + p[3].g + 2) / 4), uint8_t((p[0].b + p[1].b + p[2].b + p[3].b + 2) / 4), 0);
+					}
+				}
+			};
+
+			uint32_t nJobs = uint32_t((h + nRowsPerJob - 1) / nRowsPerJob);
+			if (int64_t(w) * h >= 16384)
+				WorkerPool::Shared().ParallelFor(nJobs, filter);
+			else
+				for (uint32_t j = 0; j < nJobs; j++) filter(j);
+			src = dst;
+		}
+
+		renderer->UpdateTextureMipLevels(id, vMipLevels);
 	}
 
 	void Decal::UpdateSprite()
@@ -1737,18 +2076,18 @@ namespace olc
 		}
 	}
 
-	void Renderable::Create(uint32_t width, uint32_t height, bool filter, bool clamp)
+	void Renderable::Create(uint32_t width, uint32_t height, bool filter, bool clamp, bool mipmaps)
 	{
 		pSprite = std::make_unique<olc::Sprite>(width, height);
-		pDecal = std::make_unique<olc::Decal>(pSprite.get(), filter, clamp);
+		pDecal = std::make_unique<olc::Decal>(pSprite.get(), filter, clamp, mipmaps);
 	}
 
-	olc::rcode Renderable::Load(const std::string& sFile, ResourcePack* pack, bool filter, bool clamp)
+	olc::rcode Renderable::Load(const std::string& sFile, ResourcePack* pack, bool filter, bool clamp, bool mipmaps)
 	{
 		pSprite = std::make_unique<olc::Sprite>();
 		if (pSprite->LoadFromFile(sFile, pack) == olc::rcode::OK)
 		{
-			pDecal = std::make_unique<olc::Decal>(pSprite.get(), filter, clamp);
+			pDecal = std::make_unique<olc::Decal>(pSprite.get(), filter, clamp, mipmaps);
 			return olc::rcode::OK;
 		}
 		else
@@ -1765,6 +2104,291 @@ namespace olc
 	olc::Sprite* Renderable::Sprite() const
 	{ return pSprite.get(); }
 
+	// O------------------------------------------------------------------------------O
+	// | olc::DecalList IMPLEMENTATION                                                |
+	// O------------------------------------------------------------------------------O
+	DecalList::DecalList()
+	{
+		static uint32_t nNextID = 1;
+		nID = nNextID++;
+	}
+
+	DecalList::~DecalList()
+	{
+		if (renderer) renderer->ReleaseDecalList(nID);
+	}
+
+	void Renderer::DrawDecalList(const olc::DecalList& list, const olc::vf2d& offset, const olc::vf2d& scale)
+	{
+		olc::DecalInstance di;
+		for (const auto& decal : list.vecDecalInstance)
+		{
+			di = decal;
+			for (auto& p : di.pos)
+				p = p * scale + offset;
+			DrawDecal(di);
+		}
+	}
+
+	// O------------------------------------------------------------------------------O
+	// | olc::WorkerPool IMPLEMENTATION                                               |
+	// O------------------------------------------------------------------------------O
+	WorkerPool& WorkerPool::Shared()
+	{
+		static WorkerPool pool;
+		return pool;
+	}
+
+	WorkerPool::WorkerPool(uint32_t nThreads)
+	{
+		if (nThreads == 0)
+		{
+			uint32_t nHardware = std::thread::hardware_concurrency();
+			nThreads = nHardware > 1 ? nHardware - 1 : 0;
+		}
+
+		for (uint32_t i = 0; i < nThreads; i++)
+			vThreads.emplace_back(&WorkerPool::Worker, this);
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::unique_lock<std::mutex> lock(muxPool);
+			bQuit = true;
+		}
+		cvWork.notify_all();
+		for (auto& t : vThreads) t.join();
+	}
+
+	uint32_t WorkerPool::ThreadCount() const
+	{ return uint32_t(vThreads.size()) + 1; }
+
+	void WorkerPool::ParallelFor(uint32_t nJobCount, const std::function<void(uint32_t)>& func)
+	{
+		if (nJobCount == 0) return;
+		if (vThreads.empty() || nJobCount == 1)
+		{
+			for (uint32_t i = 0; i < nJobCount; i++) func(i);
+			return;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(muxPool);
+			pJobFunc = &func;
+			nJobs = nJobCount;
+			nNextJob = 0;
+			nBusyWorkers = uint32_t(vThreads.size());
+			nGeneration++;
+		}
+		cvWork.notify_all();
+
+		RunJobs();
+
+		std::unique_lock<std::mutex> lock(muxPool);
+		cvDone.wait(lock, [&] { return nBusyWorkers == 0; });
+		pJobFunc = nullptr;
+	}
+
+	void WorkerPool::RunJobs()
+	{
+		for (uint32_t i = nNextJob++; i < nJobs; i = nNextJob++)
+			(*pJobFunc)(i);
+	}
+
+	void WorkerPool::Worker()
+	{
+		uint64_t nSeenGeneration = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(muxPool);
+				cvWork.wait(lock, [&] { return bQuit || nGeneration != nSeenGeneration; });
+				if (bQuit) return;
+				nSeenGeneration = nGeneration;
+			}
+
+			RunJobs();
+
+			std::unique_lock<std::mutex> lock(muxPool);
+			if (--nBusyWorkers == 0) cvDone.notify_one();
+		}
+	}
+
+	// O------------------------------------------------------------------------------O
+	// | olc::Span IMPLEMENTATION                                                     |
+	// O------------------------------------------------------------------------------O
+	// Every path computes the same integer results: alpha blending rounds
+	// (s * a + d * (255 - a)) / 255, with a = src.a scaled by nBlend / 256
+	namespace Span
+	{
+		static constexpr uint32_t nOpaque = 0xFF000000;
+
+		static inline uint32_t Div255(uint32_t v)
+		{ v += 128; return (v + (v >> 8)) >> 8; }
+
+		olc::Pixel BlendPixel(const olc::Pixel d, const olc::Pixel s, uint32_t nBlend)
+		{
+			uint32_t a = (s.a * nBlend + 128) >> 8, ia = 255 - a;
+			return olc::Pixel(uint8_t(Div255(s.r * a + d.r * ia)), uint8_t(Div255(s.g * a + d.g * ia)), uint8_t(Div255(s.b * a + d.b * ia)));
+		}
+
+#if defined(OLC_SIMD_SSE2)
+		// Two pixels widened to 16 bit lanes
+		static inline __m128i Blend2(__m128i s, __m128i d, __m128i blend)
+		{
+			__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			a = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, blend), _mm_set1_epi16(128)), 8);
+			__m128i v = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), a))), _mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+		}
+
+		static inline __m128i Blend4(__m128i s, __m128i d, __m128i blend)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i lo = Blend2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), blend);
+			__m128i hi = Blend2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), blend);
+			return _mm_or_si128(_mm_packus_epi16(lo, hi), _mm_set1_epi32(int32_t(nOpaque)));
+		}
+
+		static inline __m128i Mask4(__m128i s, __m128i d)
+		{
+			__m128i opaque = _mm_set1_epi32(int32_t(nOpaque));
+			__m128i m = _mm_cmpeq_epi32(_mm_and_si128(s, opaque), opaque);
+			return _mm_or_si128(_mm_and_si128(m, s), _mm_andnot_si128(m, d));
+		}
+#endif
+
+#if defined(OLC_SIMD_AVX2)
+		// The same, four pixels per 128 bit lane
+		static inline __m256i Blend4x2(__m256i s, __m256i d, __m256i blend)
+		{
+			__m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			a = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(a, blend), _mm256_set1_epi16(128)), 8);
+			__m256i v = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, _mm256_sub_epi16(_mm256_set1_epi16(255), a))), _mm256_set1_epi16(128));
+			return _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_srli_epi16(v, 8)), 8);
+		}
+
+		static inline __m256i Blend8(__m256i s, __m256i d, __m256i blend)
+		{
+			__m256i zero = _mm256_setzero_si256();
+			__m256i lo = Blend4x2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), blend);
+			__m256i hi = Blend4x2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), blend);
+			return _mm256_or_si256(_mm256_packus_epi16(lo, hi), _mm256_set1_epi32(int32_t(nOpaque)));
+		}
+
+		static inline __m256i Mask8(__m256i s, __m256i d)
+		{
+			__m256i opaque = _mm256_set1_epi32(int32_t(nOpaque));
+			__m256i m = _mm256_cmpeq_epi32(_mm256_and_si256(s, opaque), opaque);
+			return _mm256_blendv_epi8(d, s, m);
+		}
+#endif
+
+		const char* Path()
+		{
+#if defined(OLC_SIMD_AVX2)
+			return "AVX2";
+#elif defined(OLC_SIMD_SSE2)
+			return "SSE2";
+#else
+			return "scalar";
+#endif
+		}
+
+		void Fill(olc::Pixel* dst, const olc::Pixel p, int32_t n)
+		{
+			int32_t i = 0;
+#if defined(OLC_SIMD_AVX2)
+			__m256i v8 = _mm256_set1_epi32(int32_t(p.n));
+			for (; i + 8 <= n; i += 8)
+				_mm256_storeu_si256((__m256i*)(dst + i), v8);
+#endif
+#if defined(OLC_SIMD_SSE2)
+			__m128i v4 = _mm_set1_epi32(int32_t(p.n));
+			for (; i + 4 <= n; i += 4)
+				_mm_storeu_si128((__m128i*)(dst + i), v4);
+#endif
+			for (; i < n; i++) dst[i] = p;
+		}
+
+		void Copy(olc::Pixel* dst, const olc::Pixel* src, int32_t n)
+		{
+			if (n > 0) std::memcpy(dst, src, size_t(n) * sizeof(olc::Pixel));
+		}
+
+		void CopyMasked(olc::Pixel* dst, const olc::Pixel* src, int32_t n)
+		{
+			int32_t i = 0;
+#if defined(OLC_SIMD_AVX2)
+			for (; i + 8 <= n; i += 8)
+			{
+				__m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+				__m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+				_mm256_storeu_si256((__m256i*)(dst + i), Mask8(s, d));
+			}
+#endif
+#if defined(OLC_SIMD_SSE2)
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+				__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+				_mm_storeu_si128((__m128i*)(dst + i), Mask4(s, d));
+			}
+#endif
+			for (; i < n; i++)
+				if (src[i].a == 255) dst[i] = src[i];
+		}
+
+		void Blend(olc::Pixel* dst, const olc::Pixel* src, int32_t n, uint32_t nBlend)
+		{
+			int32_t i = 0;
+#if defined(OLC_SIMD_AVX2)
+			__m256i blend8 = _mm256_set1_epi16(int16_t(nBlend));
+			for (; i + 8 <= n; i += 8)
+			{
+				__m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+				__m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+				_mm256_storeu_si256((__m256i*)(dst + i), Blend8(s, d, blend8));
+			}
+#endif
+#if defined(OLC_SIMD_SSE2)
+			__m128i blend4 = _mm_set1_epi16(int16_t(nBlend));
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+				__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+				_mm_storeu_si128((__m128i*)(dst + i), Blend4(s, d, blend4));
+			}
+#endif
+			for (; i < n; i++) dst[i] = BlendPixel(dst[i], src[i], nBlend);
+		}
+
+		void BlendColour(olc::Pixel* dst, const olc::Pixel p, int32_t n, uint32_t nBlend)
+		{
+			int32_t i = 0;
+#if defined(OLC_SIMD_AVX2)
+			__m256i blend8 = _mm256_set1_epi16(int16_t(nBlend));
+			__m256i s8 = _mm256_set1_epi32(int32_t(p.n));
+			for (; i + 8 <= n; i += 8)
+			{
+				__m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+				_mm256_storeu_si256((__m256i*)(dst + i), Blend8(s8, d, blend8));
+			}
+#endif
+#if defined(OLC_SIMD_SSE2)
+			__m128i blend4 = _mm_set1_epi16(int16_t(nBlend));
+			__m128i s4 = _mm_set1_epi32(int32_t(p.n));
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+				_mm_storeu_si128((__m128i*)(dst + i), Blend4(s4, d, blend4));
+			}
+#endif
+			for (; i < n; i++) dst[i] = BlendPixel(dst[i], p, nBlend);
+		}
+	}
+
 	// O------------------------------------------------------------------------------O
 	// | olc::ResourcePack IMPLEMENTATION                                             |
 	// O------------------------------------------------------------------------------O
@@ -1976,8 +2600,10 @@ namespace olc
 
 	void PixelGameEngine::SetScreenSize(int w, int h)
 	{
+		FlushDrawing();
 		vScreenSize = { w, h };
 		vInvScreenSize = { 1.0f / float(w), 1.0f / float(h) };
+		bTextLayoutsStale = true;
 		for (auto& layer : vLayers)
 		{
 			layer.pDrawTarget.Create(vScreenSize.x, vScreenSize.y);
@@ -2017,112 +2643,396 @@ namespace olc
 
 	void PixelGameEngine::SetDrawTarget(Sprite* target)
 	{
+		FlushDrawing();
 		if (target)
 		{
 			pDrawTarget = target;
+			bDrawTargetIsLayer = false;
 		}
 		else
 		{
 			nTargetLayer = 0;
 			pDrawTarget = vLayers[0].pDrawTarget.Sprite();
+			bDrawTargetIsLayer = true;
 		}
 	}
 
 	void PixelGameEngine::SetDrawTarget(uint8_t layer, bool bDirty)
 	{
+		FlushDrawing();
 		if (layer < vLayers.size())
 		{
 			pDrawTarget = vLayers[layer].pDrawTarget.Sprite();
 			vLayers[layer].bUpdate = bDirty;
 			nTargetLayer = layer;
+			bDrawTargetIsLayer = true;
 		}
 	}
 
-	void PixelGameEngine::EnableLayer(uint8_t layer, bool b)
-	{ if (layer < vLayers.size()) vLayers[layer].bShow = b; }
-
-	void PixelGameEngine::SetLayerOffset(uint8_t layer, const olc::vf2d& offset)
-	{ SetLayerOffset(layer, offset.x, offset.y); }
-
-	void PixelGameEngine::SetLayerOffset(uint8_t layer, float x, float y)
-	{ if (layer < vLayers.size()) vLayers[layer].vOffset = { x, y }; }
-
-	void PixelGameEngine::SetLayerScale(uint8_t layer, const olc::vf2d& scale)
-	{ SetLayerScale(layer, scale.x, scale.y); }
-
-	void PixelGameEngine::SetLayerScale(uint8_t layer, float x, float y)
-	{ if (layer < vLayers.size()) vLayers[layer].vScale = { x, y }; }
-
-	void PixelGameEngine::SetLayerTint(uint8_t layer, const olc::Pixel& tint)
-	{ if (layer < vLayers.size()) vLayers[layer].tint = tint; }
-
-	void PixelGameEngine::SetLayerCustomRenderFunction(uint8_t layer, std::function<void()> f)
-	{ if (layer < vLayers.size()) vLayers[layer].funcHook = f; }
-
-	std::vector<LayerDesc>& PixelGameEngine::GetLayers()
-	{ return vLayers; }
-
-	uint32_t PixelGameEngine::CreateLayer()
+	void PixelGameEngine::olc_MarkDirty(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
 	{
-		LayerDesc ld;
-		ld.pDrawTarget.Create(vScreenSize.x, vScreenSize.y);
-		vLayers.push_back(std::move(ld));
-		return uint32_t(vLayers.size()) - 1;
+		LayerDesc& layer = vLayers[nTargetLayer];
+		layer.vDirtyMin = layer.vDirtyMin.min({ x1, y1 });
+		layer.vDirtyMax = layer.vDirtyMax.max({ x2, y2 });
 	}
 
-	Sprite* PixelGameEngine::GetDrawTarget() const
-	{ return pDrawTarget; }
+	uint32_t PixelGameEngine::olc_BlendFactor() const
+	{ return uint32_t(fBlendFactor * 256.0f + 0.5f); }
 
-	int32_t PixelGameEngine::GetDrawTargetWidth() const
+	void PixelGameEngine::EnableDeferredDrawing(const bool bEnable)
 	{
-		if (pDrawTarget)
-			return pDrawTarget->width;
-		else
-			return 0;
+		if (!bEnable) FlushDrawing();
+		bDeferDrawing = bEnable;
 	}
 
-	int32_t PixelGameEngine::GetDrawTargetHeight() const
+	void PixelGameEngine::FlushDrawing()
 	{
-		if (pDrawTarget)
-			return pDrawTarget->height;
-		else
-			return 0;
-	}
-
-	uint32_t PixelGameEngine::GetFPS() const
-	{ return nLastFPS; }
+		if (vDrawCommands.empty()) return;
 
-	bool PixelGameEngine::IsFocused() const
-	{ return bHasInputFocus; }
+		// Bin the commands by the tiles they may touch, then each tile runs its
+		// commands in the order they were drawn, clipped to itself
+		olc::Sprite* target = pDrawTarget;
+		int32_t nTilesX = (target->width + nDrawTileSize - 1) / nDrawTileSize;
+		int32_t nTilesY = (target->height + nDrawTileSize - 1) / nDrawTileSize;
+		vDrawTileBins.resize(size_t(nTilesX) * size_t(nTilesY));
+		for (auto& bin : vDrawTileBins) bin.clear();
 
-	HWButton PixelGameEngine::GetKey(Key k) const
-	{ return pKeyboardState[k];	}
+		// Circles, triangles, lines and outlines walk every row to find their spans, which
+		// is done once here instead of in each tile. Their spans share a colour, so can be
+		// sorted, and they are binned only to the tiles their spans reach
+		RasterTarget rtRecord;
+		rtRecord.pTarget = target;
+		rtRecord.vClipMax = { target->width, target->height };
+		rtRecord.pRecordSpans = &vDrawSpans;
+		vDrawSpans.clear();
 
-	HWButton PixelGameEngine::GetMouse(uint32_t b) const
-	{ return pMouseState[b]; }
+		for (uint32_t i = 0; i < uint32_t(vDrawCommands.size()); i++)
+		{
+			DrawCommand& cmd = vDrawCommands[i];
+			olc::vi2d vMin = cmd.vMin.max({ 0, 0 });
+			olc::vi2d vMax = cmd.vMax.min({ target->width, target->height });
+			if (vMin.x >= vMax.x || vMin.y >= vMax.y) continue;
 
-	int32_t PixelGameEngine::GetMouseX() const
-	{ return vMousePos.x; }
+			if (cmd.type == DrawCommand::Type::CIRCLE || cmd.type == DrawCommand::Type::TRIANGLE ||
+				cmd.type == DrawCommand::Type::LINE || cmd.type == DrawCommand::Type::CIRCLE_OUTLINE)
+			{
+				cmd.nSpanFirst = uint32_t(vDrawSpans.size());
+				rtRecord.nRecordFirst = cmd.nSpanFirst;
+				olc_RasterCommand(rtRecord, cmd);
+
+				// Sorted by row with a counting sort, as a shape has far fewer rows than a
+				// comparison sort would take steps
+				cmd.nSpanCount = uint32_t(vDrawSpans.size()) - cmd.nSpanFirst;
+				if (cmd.nSpanCount > 1)
+				{
+					auto spans = vDrawSpans.begin() + cmd.nSpanFirst;
+					auto [itMin, itMax] = std::minmax_element(spans, vDrawSpans.end(), [](const DrawSpan& a, const DrawSpan& b) { return a.y < b.y; });
+					int32_t nFirstRow = itMin->y;
+					vDrawRowStart.assign(size_t(itMax->y - nFirstRow) + 2, 0);
+					for (auto it = spans; it != vDrawSpans.end(); ++it) vDrawRowStart[it->y - nFirstRow + 1]++;
+					for (size_t r = 1; r < vDrawRowStart.size(); r++) vDrawRowStart[r] += vDrawRowStart[r - 1];
+					vDrawSpansSorted.resize(cmd.nSpanCount);
+					for (auto it = spans; it != vDrawSpans.end(); ++it) vDrawSpansSorted[vDrawRowStart[it->y - nFirstRow]++] = *it;
+					std::copy(vDrawSpansSorted.begin(), vDrawSpansSorted.end(), spans);
+				}
 
-	int32_t PixelGameEngine::GetMouseY() const
-	{ return vMousePos.y; }
+				for (size_t s = cmd.nSpanFirst; s < vDrawSpans.size(); s++)
+				{
+					const DrawSpan& span = vDrawSpans[s];
+					for (int32_t tx = span.x1 / nDrawTileSize; tx <= (span.x2 - 1) / nDrawTileSize; tx++)
+					{
+						auto& bin = vDrawTileBins[(span.y / nDrawTileSize) * nTilesX + tx];
+						if (bin.empty() || bin.back() != i) bin.push_back(i);
+					}
+				}
+				continue;
+			}
 
-	const olc::vi2d& PixelGameEngine::GetMousePos() const
-	{ return vMousePos; }
+			for (int32_t ty = vMin.y / nDrawTileSize; ty <= (vMax.y - 1) / nDrawTileSize; ty++)
+				for (int32_t tx = vMin.x / nDrawTileSize; tx <= (vMax.x - 1) / nDrawTileSize; tx++)
+					vDrawTileBins[ty * nTilesX + tx].push_back(i);
+		}
 
-	int32_t PixelGameEngine::GetMouseWheel() const
-	{ return nMouseWheelDelta; }
+		WorkerPool::Shared().ParallelFor(uint32_t(vDrawTileBins.size()), [&](uint32_t nTile)
+		{
+			const auto& bin = vDrawTileBins[nTile];
+			if (bin.empty()) return;
 
-	int32_t PixelGameEngine::ScreenWidth() const
-	{ return vScreenSize.x; }
+			static thread_local std::vector<Pixel> vScratch;
+			RasterTarget rt;
+			rt.pTarget = target;
+			rt.vClipMin = { int32_t(nTile % nTilesX) * nDrawTileSize, int32_t(nTile / nTilesX) * nDrawTileSize };
+			rt.vClipMax = (rt.vClipMin + olc::vi2d(nDrawTileSize, nDrawTileSize)).min({ target->width, target->height });
+			rt.pScratch = &vScratch;
+			rt.pSpans = vDrawSpans.data();
+			for (uint32_t i : bin)
+				olc_RasterCommand(rt, vDrawCommands[i]);
+		});
 
-	int32_t PixelGameEngine::ScreenHeight() const
-	{ return vScreenSize.y; }
+		vDrawCommands.clear();
+	}
 
-	float PixelGameEngine::GetElapsedTime() const
-	{ return fLastElapsed; }
+	void PixelGameEngine::olc_SubmitDraw(DrawCommand& cmd)
+	{
+		if (!pDrawTarget) return;
+		if (bDrawTargetIsLayer) olc_MarkDirty(cmd.vMin.x, cmd.vMin.y, cmd.vMax.x, cmd.vMax.y);
+		cmd.nMode = nPixelMode;
+		cmd.nBlend = olc_BlendFactor();
 
-	const olc::vi2d& PixelGameEngine::GetWindowSize() const
+		// Custom pixel modes call back into user code, and a sprite drawn onto itself
+		// needs its earlier pixels, so those wait for the pending commands and run here
+		if (bDeferDrawing && nPixelMode != Pixel::CUSTOM && cmd.sprite != pDrawTarget)
+		{
+			vDrawCommands.push_back(cmd);
+			return;
+		}
+
+		FlushDrawing();
+		RasterTarget rt;
+		rt.pTarget = pDrawTarget;
+		rt.vClipMax = { pDrawTarget->width, pDrawTarget->height };
+		rt.pFuncCustom = &funcPixelMode;
+		rt.pScratch = &vSpanScratch;
+		olc_RasterCommand(rt, cmd);
+	}
+
+	void PixelGameEngine::olc_RasterCommand(RasterTarget rt, const DrawCommand& cmd)
+	{
+		rt.nMode = cmd.nMode;
+		rt.nBlend = cmd.nBlend;
+		switch (cmd.type)
+		{
+		case DrawCommand::Type::PIXEL:
+			olc_DrawSpan(rt, cmd.pos[0].x, cmd.pos[0].y, &cmd.p, 1);
+			break;
+		case DrawCommand::Type::CLEAR:
+			// Clear() ignores the pixel mode
+			for (int32_t y = rt.vClipMin.y; y < rt.vClipMax.y; y++)
+				Span::Fill(rt.pTarget->GetData() + y * rt.pTarget->width + rt.vClipMin.x, cmd.p, rt.vClipMax.x - rt.vClipMin.x);
+			break;
+		case DrawCommand::Type::RECT:
+			for (int32_t y = std::max(cmd.pos[0].y, rt.vClipMin.y); y < std::min(cmd.pos[0].y + cmd.size.y, rt.vClipMax.y); y++)
+				olc_FillSpan(rt, cmd.pos[0].x, cmd.pos[0].x + cmd.size.x, y, cmd.p);
+			break;
+		case DrawCommand::Type::CIRCLE:
+		case DrawCommand::Type::TRIANGLE:
+		case DrawCommand::Type::LINE:
+		case DrawCommand::Type::CIRCLE_OUTLINE:
+			if (rt.pSpans != nullptr)
+			{
+				const DrawSpan* begin = rt.pSpans + cmd.nSpanFirst;
+				const DrawSpan* end = begin + cmd.nSpanCount;
+				const DrawSpan* span = std::lower_bound(begin, end, rt.vClipMin.y, [](const DrawSpan& a, int32_t y) { return a.y < y; });
+				for (; span != end && span->y < rt.vClipMax.y; span++)
+					olc_FillSpan(rt, span->x1, span->x2, span->y, cmd.p);
+			}
+			else if (cmd.type == DrawCommand::Type::CIRCLE)
+				olc_RasterCircle(rt, cmd.pos[0].x, cmd.pos[0].y, cmd.n, cmd.p);
+			else if (cmd.type == DrawCommand::Type::TRIANGLE)
+				olc_RasterTriangle(rt, cmd.pos[0].x, cmd.pos[0].y, cmd.pos[1].x, cmd.pos[1].y, cmd.pos[2].x, cmd.pos[2].y, cmd.p);
+			else if (cmd.type == DrawCommand::Type::LINE)
+				olc_WalkLine(cmd.pos[0].x, cmd.pos[0].y, cmd.pos[1].x, cmd.pos[1].y, cmd.nPattern, [&](int32_t x, int32_t y) { olc_FillSpan(rt, x, x + 1, y, cmd.p); });
+			else
+				olc_WalkCircle(cmd.pos[0].x, cmd.pos[0].y, cmd.n, uint8_t(cmd.nPattern), [&](int32_t x, int32_t y) { olc_FillSpan(rt, x, x + 1, y, cmd.p); });
+			break;
+		case DrawCommand::Type::SPRITE:
+			olc_RasterSprite(rt, cmd.pos[0].x, cmd.pos[0].y, cmd.sprite, cmd.source.x, cmd.source.y, cmd.size.x, cmd.size.y, cmd.n, cmd.nFlip);
+			break;
+		case DrawCommand::Type::GLYPH:
+			olc_RasterGlyph(rt, cmd.pos[0].x, cmd.pos[0].y, cmd.sprite, cmd.source.x, cmd.source.y, cmd.size.x, cmd.n, cmd.p);
+			break;
+		}
+	}
+
+	// Fills [x1, x2) of row y with the target's pixel mode, clipped
+	void PixelGameEngine::olc_FillSpan(const RasterTarget& rt, int32_t x1, int32_t x2, int32_t y, Pixel p)
+	{
+		if (y < rt.vClipMin.y || y >= rt.vClipMax.y) return;
+		x1 = std::max(x1, rt.vClipMin.x);
+		x2 = std::min(x2, rt.vClipMax.x);
+		if (x1 >= x2) return;
+
+		if (rt.pRecordSpans != nullptr)
+		{
+			// Lines and outlines arrive a pixel at a time, so runs along a row are joined
+			std::vector<DrawSpan>& spans = *rt.pRecordSpans;
+			if (spans.size() > rt.nRecordFirst && spans.back().y == y && spans.back().x2 == x1)
+				spans.back().x2 = x2;
+			else
+				spans.push_back({ y, x1, x2 });
+			return;
+		}
+
+		Pixel* dst = rt.pTarget->GetData() + y * rt.pTarget->width + x1;
+		switch (rt.nMode)
+		{
+		case Pixel::NORMAL: Span::Fill(dst, p, x2 - x1); break;
+		case Pixel::MASK: if (p.a == 255) Span::Fill(dst, p, x2 - x1); break;
+		case Pixel::ALPHA: Span::BlendColour(dst, p, x2 - x1, rt.nBlend); break;
+		default:
+			for (int32_t x = x1; x < x2; x++, dst++) *dst = (*rt.pFuncCustom)(x, y, p, *dst);
+			break;
+		}
+	}
+
+	// Draws n source pixels to row y from column x, with the target's pixel mode
+	void PixelGameEngine::olc_DrawSpan(const RasterTarget& rt, int32_t x, int32_t y, const Pixel* src, int32_t n)
+	{
+		if (y < rt.vClipMin.y || y >= rt.vClipMax.y) return;
+		int32_t x1 = std::max(x, rt.vClipMin.x);
+		int32_t x2 = std::min(x + n, rt.vClipMax.x);
+		if (x1 >= x2) return;
+
+		src += x1 - x;
+		Pixel* dst = rt.pTarget->GetData() + y * rt.pTarget->width + x1;
+		switch (rt.nMode)
+		{
+		case Pixel::NORMAL: Span::Copy(dst, src, x2 - x1); break;
+		case Pixel::MASK: Span::CopyMasked(dst, src, x2 - x1); break;
+		case Pixel::ALPHA: Span::Blend(dst, src, x2 - x1, rt.nBlend); break;
+		default:
+			for (int32_t i = x1; i < x2; i++, dst++, src++) *dst = (*rt.pFuncCustom)(i, y, *src, *dst);
+			break;
+		}
+	}
+
+	void PixelGameEngine::olc_UploadLayer(olc::LayerDesc& layer)
+	{
+		olc::Decal* decal = layer.pDrawTarget.Decal();
+		olc::Sprite* sprite = layer.pDrawTarget.Sprite();
+		if (layer.bUpdate)
+		{
+			decal->Update();
+		}
+		else
+		{
+			olc::vi2d vMin = layer.vDirtyMin.max({ 0, 0 });
+			olc::vi2d vMax = layer.vDirtyMax.min({ sprite->width, sprite->height });
+			if (vMin.x < vMax.x && vMin.y < vMax.y)
+				renderer->UpdateTextureRegion(decal->id, sprite, vMin, vMax - vMin);
+		}
+
+		layer.bUpdate = false;
+		layer.vDirtyMin = { INT32_MAX, INT32_MAX };
+		layer.vDirtyMax = { INT32_MIN, INT32_MIN };
+	}
+
+	void PixelGameEngine::EnableLayer(uint8_t layer, bool b)
+	{ if (layer < vLayers.size()) vLayers[layer].bShow = b; }
+
+	void PixelGameEngine::SetLayerOffset(uint8_t layer, const olc::vf2d& offset)
+	{ SetLayerOffset(layer, offset.x, offset.y); }
+
+	void PixelGameEngine::SetLayerOffset(uint8_t layer, float x, float y)
+	{ if (layer < vLayers.size()) vLayers[layer].vOffset = { x, y }; }
+
+	void PixelGameEngine::SetLayerScale(uint8_t layer, const olc::vf2d& scale)
+	{ SetLayerScale(layer, scale.x, scale.y); }
+
+	void PixelGameEngine::SetLayerScale(uint8_t layer, float x, float y)
+	{ if (layer < vLayers.size()) vLayers[layer].vScale = { x, y }; }
+
+	void PixelGameEngine::SetLayerTint(uint8_t layer, const olc::Pixel& tint)
+	{ if (layer < vLayers.size()) vLayers[layer].tint = tint; }
+
+	void PixelGameEngine::SetLayerCustomRenderFunction(uint8_t layer, std::function<void()> f)
+	{ if (layer < vLayers.size()) vLayers[layer].funcHook = f; }
+
+	std::vector<LayerDesc>& PixelGameEngine::GetLayers()
+	{ return vLayers; }
+
+	uint32_t PixelGameEngine::CreateLayer()
+	{
+		LayerDesc ld;
+		ld.pDrawTarget.Create(vScreenSize.x, vScreenSize.y);
+		vLayers.push_back(std::move(ld));
+		return uint32_t(vLayers.size()) - 1;
+	}
+
+	Sprite* PixelGameEngine::GetDrawTarget() const
+	{ return pDrawTarget; }
+
+	Sprite* PixelGameEngine::GetFramebuffer() const
+	{ return renderer->GetFramebuffer(); }
+
+	int32_t PixelGameEngine::GetDrawTargetWidth() const
+	{
+		if (pDrawTarget)
+			return pDrawTarget->width;
+		else
+			return 0;
+	}
+
+	int32_t PixelGameEngine::GetDrawTargetHeight() const
+	{
+		if (pDrawTarget)
+			return pDrawTarget->height;
+		else
+			return 0;
+	}
+
+	uint32_t PixelGameEngine::GetFPS() const
+	{ return nLastFPS; }
+
+	bool PixelGameEngine::IsFocused() const
+	{ return bHasInputFocus; }
+
+	HWButton PixelGameEngine::GetKey(Key k) const
+	{ return pKeyboardState[k];	}
+
+	HWButton PixelGameEngine::GetMouse(uint32_t b) const
+	{ return pMouseState[b]; }
+
+	int32_t PixelGameEngine::GetMouseX() const
+	{ return vMousePos.x; }
+
+	int32_t PixelGameEngine::GetMouseY() const
+	{ return vMousePos.y; }
+
+	const olc::vi2d& PixelGameEngine::GetMousePos() const
+	{ return vMousePos; }
+
+	int32_t PixelGameEngine::GetMouseWheel() const
+	{ return nMouseWheelDelta; }
+
+	int32_t PixelGameEngine::ScreenWidth() const
+	{ return vScreenSize.x; }
+
+	int32_t PixelGameEngine::ScreenHeight() const
+	{ return vScreenSize.y; }
+
+	float PixelGameEngine::GetElapsedTime() const
+	{ return fLastElapsed; }
+
+	void PixelGameEngine::SetFrameRateLimit(const uint32_t nFPS)
+	{
+		nFrameRateLimit = nFPS;
+		tpNextFrame = std::chrono::steady_clock::now();
+	}
+
+	uint32_t PixelGameEngine::GetFrameRateLimit() const
+	{ return nFrameRateLimit; }
+
+	void PixelGameEngine::IdleFrame(const float fWakeAfter)
+	{
+		bIdleFrame = true;
+		fIdleWakeAfter = fWakeAfter;
+	}
+
+	void PixelGameEngine::EnableDynamicResolution(const bool bEnable, const float fFrameBudget, const float fMinScale)
+	{
+		bDynamicResolution = bEnable;
+		this->fFrameBudget = fFrameBudget;
+		fMinRenderScale = std::min(std::max(fMinScale, 0.1f), 1.0f);
+		fRenderScale = 1.0f;
+		fFrameTimeAverage = 0.0f;
+		nFramesAtScale = 0;
+	}
+
+	float PixelGameEngine::GetRenderScale() const
+	{ return fRenderScale; }
+
+	const olc::vi2d& PixelGameEngine::GetWindowSize() const
 	{ return vWindowSize; }
 
 	const olc::vi2d& PixelGameEngine::GetPixelSize() const
@@ -2145,6 +3055,21 @@ namespace olc
 	{
 		if (!pDrawTarget) return false;
 
+		if (bDeferDrawing && nPixelMode != Pixel::CUSTOM)
+		{
+			DrawCommand cmd;
+			cmd.type = DrawCommand::Type::PIXEL;
+			cmd.p = p;
+			cmd.pos[0] = { x, y };
+			cmd.vMin = { x, y };
+			cmd.vMax = { x + 1, y + 1 };
+			olc_SubmitDraw(cmd);
+			return x >= 0 && x < pDrawTarget->width && y >= 0 && y < pDrawTarget->height;
+		}
+
+		if (!vDrawCommands.empty()) FlushDrawing();
+		if (bDrawTargetIsLayer) olc_MarkDirty(x, y, x + 1, y + 1);
+
 		if (nPixelMode == Pixel::NORMAL)
 		{
 			return pDrawTarget->SetPixel(x, y, p);
@@ -2158,13 +3083,8 @@ namespace olc
 
 		if (nPixelMode == Pixel::ALPHA)
 		{
-			Pixel d = pDrawTarget->GetPixel(x, y);
-			float a = (float)(p.a / 255.0f) * fBlendFactor;
-			float c = 1.0f - a;
-			float r = a * (float)p.r + c * (float)d.r;
-			float g = a * (float)p.g + c * (float)d.g;
-			float b = a * (float)p.b + c * (float)d.b;
-			return pDrawTarget->SetPixel(x, y, Pixel((uint8_t)r, (uint8_t)g, (uint8_t)b/*, (uint8_t)(p.a * fBlendFactor)*/));
+			// Same arithmetic as the span kernels, so single pixels and spans agree
+			return pDrawTarget->SetPixel(x, y, Span::BlendPixel(pDrawTarget->GetPixel(x, y), p, olc_BlendFactor()));
 		}
 
 		if (nPixelMode == Pixel::CUSTOM)
@@ -2179,7 +3099,9 @@ namespace olc
 	void PixelGameEngine::DrawLine(const olc::vi2d& pos1, const olc::vi2d& pos2, Pixel p, uint32_t pattern)
 	{ DrawLine(pos1.x, pos1.y, pos2.x, pos2.y, p, pattern); }
 
-	void PixelGameEngine::DrawLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Pixel p, uint32_t pattern)
+	// Calls plot(x, y) for each pixel of a line whose pattern bit is set
+	template<typename Plot>
+	void PixelGameEngine::olc_WalkLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t pattern, Plot plot)
 	{
 		int x, y, dx, dy, dx1, dy1, px, py, xe, ye, i;
 		dx = x2 - x1; dy = y2 - y1;
@@ -2196,14 +3118,14 @@ namespace olc
 		if (dx == 0) // Line is vertical
 		{
 			if (y2 < y1) std::swap(y1, y2);
-			for (y = y1; y <= y2; y++) if (rol()) Draw(x1, y, p);
+			for (y = y1; y <= y2; y++) if (rol()) plot(x1, y);
 			return;
 		}
 
 		if (dy == 0) // Line is horizontal
 		{
 			if (x2 < x1) std::swap(x1, x2);
-			for (x = x1; x <= x2; x++) if (rol()) Draw(x, y1, p);
+			for (x = x1; x <= x2; x++) if (rol()) plot(x, y1);
 			return;
 		}
 
@@ -2221,7 +3143,7 @@ namespace olc
 				x = x2; y = y2; xe = x1;
 			}
 
-			if (rol()) Draw(x, y, p);
+			if (rol()) plot(x, y);
 
 			for (i = 0; x < xe; i++)
 			{
@@ -2233,7 +3155,7 @@ namespace olc
 					if ((dx < 0 && dy < 0) || (dx > 0 && dy > 0)) y = y + 1; else y = y - 1;
 					px = px + 2 * (dy1 - dx1);
 				}
-				if (rol()) Draw(x, y, p);
+				if (rol()) plot(x, y);
 			}
 		}
 		else
@@ -2247,7 +3169,7 @@ namespace olc
 				x = x2; y = y2; ye = y1;
 			}
 
-			if (rol()) Draw(x, y, p);
+			if (rol()) plot(x, y);
 
 			for (i = 0; y < ye; i++)
 			{
@@ -2259,19 +3181,38 @@ namespace olc
 					if ((dx < 0 && dy < 0) || (dx > 0 && dy > 0)) x = x + 1; else x = x - 1;
 					py = py + 2 * (dx1 - dy1);
 				}
-				if (rol()) Draw(x, y, p);
+				if (rol()) plot(x, y);
 			}
 		}
 	}
 
+	void PixelGameEngine::DrawLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Pixel p, uint32_t pattern)
+	{
+		// Deferred, a line is one command rather than one per pixel
+		if (bDeferDrawing && nPixelMode != Pixel::CUSTOM)
+		{
+			DrawCommand cmd;
+			cmd.type = DrawCommand::Type::LINE;
+			cmd.p = p;
+			cmd.pos[0] = { x1, y1 };
+			cmd.pos[1] = { x2, y2 };
+			cmd.nPattern = pattern;
+			cmd.vMin = { std::min(x1, x2), std::min(y1, y2) };
+			cmd.vMax = { std::max(x1, x2) + 1, std::max(y1, y2) + 1 };
+			olc_SubmitDraw(cmd);
+			return;
+		}
+
+		olc_WalkLine(x1, y1, x2, y2, pattern, [&](int32_t x, int32_t y) { Draw(x, y, p); });
+	}
+
 	void PixelGameEngine::DrawCircle(const olc::vi2d& pos, int32_t radius, Pixel p, uint8_t mask)
 	{ DrawCircle(pos.x, pos.y, radius, p, mask); }
 
-	void PixelGameEngine::DrawCircle(int32_t x, int32_t y, int32_t radius, Pixel p, uint8_t mask)
+	// Calls plot(x, y) for each pixel of the octants of a circle's outline set in mask
+	template<typename Plot>
+	void PixelGameEngine::olc_WalkCircle(int32_t x, int32_t y, int32_t radius, uint8_t mask, Plot plot)
 	{ // Thanks to IanM-Matrix1 #PR121
-		if (radius < 0 || x < -radius || y < -radius || x - GetDrawTargetWidth() > radius || y - GetDrawTargetHeight() > radius)
-			return;
-
 		if (radius > 0)
 		{
 			int x0 = 0;
@@ -2281,16 +3222,16 @@ namespace olc
 			while (y0 >= x0) // only formulate 1/8 of circle
 			{
 				// Draw even octants
-				if (mask & 0x01) Draw(x + x0, y - y0, p);// Q6 - upper right right
-				if (mask & 0x04) Draw(x + y0, y + x0, p);// Q4 - lower lower right
-				if (mask & 0x10) Draw(x - x0, y + y0, p);// Q2 - lower left left
-				if (mask & 0x40) Draw(x - y0, y - x0, p);// Q0 - upper upper left
+				if (mask & 0x01) plot(x + x0, y - y0);// Q6 - upper right right
+				if (mask & 0x04) plot(x + y0, y + x0);// Q4 - lower lower right
+				if (mask & 0x10) plot(x - x0, y + y0);// Q2 - lower left left
+				if (mask & 0x40) plot(x - y0, y - x0);// Q0 - upper upper left
 				if (x0 != 0 && x0 != y0)
 				{
-					if (mask & 0x02) Draw(x + y0, y - x0, p);// Q7 - upper upper right
-					if (mask & 0x08) Draw(x + x0, y + y0, p);// Q5 - lower right right
-					if (mask & 0x20) Draw(x - y0, y + x0, p);// Q3 - lower lower left
-					if (mask & 0x80) Draw(x - x0, y - y0, p);// Q1 - upper left left
+					if (mask & 0x02) plot(x + y0, y - x0);// Q7 - upper upper right
+					if (mask & 0x08) plot(x + x0, y + y0);// Q5 - lower right right
+					if (mask & 0x20) plot(x - y0, y + x0);// Q3 - lower lower left
+					if (mask & 0x80) plot(x - x0, y - y0);// Q1 - upper left left
 				}
 
 				if (d < 0)
@@ -2300,17 +3241,52 @@ namespace olc
 			}
 		}
 		else
-			Draw(x, y, p);
+			plot(x, y);
+	}
+
+	void PixelGameEngine::DrawCircle(int32_t x, int32_t y, int32_t radius, Pixel p, uint8_t mask)
+	{
+		if (radius < 0 || x < -radius || y < -radius || x - GetDrawTargetWidth() > radius || y - GetDrawTargetHeight() > radius)
+			return;
+
+		// Deferred, an outline is one command rather than one per pixel
+		if (bDeferDrawing && nPixelMode != Pixel::CUSTOM)
+		{
+			DrawCommand cmd;
+			cmd.type = DrawCommand::Type::CIRCLE_OUTLINE;
+			cmd.p = p;
+			cmd.pos[0] = { x, y };
+			cmd.n = radius;
+			cmd.nPattern = mask;
+			cmd.vMin = { x - radius, y - radius };
+			cmd.vMax = { x + radius + 1, y + radius + 1 };
+			olc_SubmitDraw(cmd);
+			return;
+		}
+
+		olc_WalkCircle(x, y, radius, mask, [&](int32_t px, int32_t py) { Draw(px, py, p); });
 	}
 
 	void PixelGameEngine::FillCircle(const olc::vi2d& pos, int32_t radius, Pixel p)
 	{ FillCircle(pos.x, pos.y, radius, p); }
 
 	void PixelGameEngine::FillCircle(int32_t x, int32_t y, int32_t radius, Pixel p)
-	{ // Thanks to IanM-Matrix1 #PR121
+	{
 		if (radius < 0 || x < -radius || y < -radius || x - GetDrawTargetWidth() > radius || y - GetDrawTargetHeight() > radius)
 			return;
 
+		DrawCommand cmd;
+		cmd.type = DrawCommand::Type::CIRCLE;
+		cmd.p = p;
+		cmd.pos[0] = { x, y };
+		cmd.n = radius;
+		cmd.vMin = { x - radius, y - radius };
+		cmd.vMax = { x + radius + 1, y + radius + 1 };
+		olc_SubmitDraw(cmd);
+	}
+
+	void PixelGameEngine::olc_RasterCircle(const RasterTarget& rt, int32_t x, int32_t y, int32_t radius, Pixel p)
+	{ // Thanks to IanM-Matrix1 #PR121
 		if (radius > 0)
 		{
 			int x0 = 0;
@@ -2319,8 +3295,7 @@ namespace olc
 
 			auto drawline = [&](int sx, int ex, int y)
 			{
-				for (int x = sx; x <= ex; x++)
-					Draw(x, y, p);
+				olc_FillSpan(rt, sx, ex + 1, y, p);
 			};
 
 			while (y0 >= x0)
@@ -2342,7 +3317,7 @@ namespace olc
 			}
 		}
 		else
-			Draw(x, y, p);
+			olc_FillSpan(rt, x, x + 1, y, p);
 	}
 
 	void PixelGameEngine::DrawRect(const olc::vi2d& pos, const olc::vi2d& size, Pixel p)
@@ -2358,9 +3333,12 @@ namespace olc
 
 	void PixelGameEngine::Clear(Pixel p)
 	{
-		int pixels = GetDrawTargetWidth() * GetDrawTargetHeight();
-		Pixel* m = GetDrawTarget()->GetData();
-		for (int i = 0; i < pixels; i++) m[i] = p;
+		DrawCommand cmd;
+		cmd.type = DrawCommand::Type::CLEAR;
+		cmd.p = p;
+		cmd.vMin = { 0, 0 };
+		cmd.vMax = { int32_t(GetDrawTargetWidth()), int32_t(GetDrawTargetHeight()) };
+		olc_SubmitDraw(cmd);
 	}
 
 	void PixelGameEngine::ClearBuffer(Pixel p, bool bDepth)
@@ -2426,9 +3404,15 @@ namespace olc
 		if (y2 < 0) y2 = 0;
 		if (y2 >= (int32_t)GetDrawTargetHeight()) y2 = (int32_t)GetDrawTargetHeight();
 
-		for (int i = x; i < x2; i++)
-			for (int j = y; j < y2; j++)
-				Draw(i, j, p);
+		if (x >= x2 || y >= y2) return;
+		DrawCommand cmd;
+		cmd.type = DrawCommand::Type::RECT;
+		cmd.p = p;
+		cmd.pos[0] = { x, y };
+		cmd.size = { x2 - x, y2 - y };
+		cmd.vMin = { x, y };
+		cmd.vMax = { x2, y2 };
+		olc_SubmitDraw(cmd);
 	}
 
 	void PixelGameEngine::DrawTriangle(const olc::vi2d& pos1, const olc::vi2d& pos2, const olc::vi2d& pos3, Pixel p)
@@ -2444,10 +3428,23 @@ namespace olc
 	void PixelGameEngine::FillTriangle(const olc::vi2d& pos1, const olc::vi2d& pos2, const olc::vi2d& pos3, Pixel p)
 	{ FillTriangle(pos1.x, pos1.y, pos2.x, pos2.y, pos3.x, pos3.y, p); }
 
-	// https://www.avrfreaks.net/sites/default/files/triangles.c
 	void PixelGameEngine::FillTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
 	{
-		auto drawline = [&](int sx, int ex, int ny) { for (int i = sx; i <= ex; i++) Draw(i, ny, p); };
+		DrawCommand cmd;
+		cmd.type = DrawCommand::Type::TRIANGLE;
+		cmd.p = p;
+		cmd.pos[0] = { x1, y1 };
+		cmd.pos[1] = { x2, y2 };
+		cmd.pos[2] = { x3, y3 };
+		cmd.vMin = cmd.pos[0].min(cmd.pos[1]).min(cmd.pos[2]);
+		cmd.vMax = cmd.pos[0].max(cmd.pos[1]).max(cmd.pos[2]) + olc::vi2d(1, 1);
+		olc_SubmitDraw(cmd);
+	}
+
+	// https://www.avrfreaks.net/sites/default/files/triangles.c
+	void PixelGameEngine::olc_RasterTriangle(const RasterTarget& rt, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
+	{
+		auto drawline = [&](int sx, int ex, int ny) { olc_FillSpan(rt, sx, ex + 1, ny, p); };
 
 		int t1x, t2x, y, minx, maxx, t1xp, t2xp;
 		bool changed1 = false;
@@ -2750,33 +3747,7 @@ namespace olc
 		if (sprite == nullptr)
 			return;
 
-		int32_t fxs = 0, fxm = 1, fx = 0;
-		int32_t fys = 0, fym = 1, fy = 0;
-		if (flip & olc::Sprite::Flip::HORIZ) { fxs = sprite->width - 1; fxm = -1; }
-		if (flip & olc::Sprite::Flip::VERT) { fys = sprite->height - 1; fym = -1; }
-
-		if (scale > 1)
-		{
-			fx = fxs;
-			for (int32_t i = 0; i < sprite->width; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < sprite->height; j++, fy += fym)
-					for (uint32_t is = 0; is < scale; is++)
-						for (uint32_t js = 0; js < scale; js++)
-							Draw(x + (i * scale) + is, y + (j * scale) + js, sprite->GetPixel(fx, fy));
-			}
-		}
-		else
-		{
-			fx = fxs;
-			for (int32_t i = 0; i < sprite->width; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < sprite->height; j++, fy += fym)
-					Draw(x + i, y + j, sprite->GetPixel(fx, fy));
-			}
-		}
+		DrawPartialSprite(x, y, sprite, 0, 0, sprite->width, sprite->height, scale, flip);
 	}
 
 	void PixelGameEngine::DrawPartialSprite(const olc::vi2d& pos, Sprite* sprite, const olc::vi2d& sourcepos, const olc::vi2d& size, uint32_t scale, uint8_t flip)
@@ -2784,35 +3755,59 @@ namespace olc
 
 	void PixelGameEngine::DrawPartialSprite(int32_t x, int32_t y, Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint32_t scale, uint8_t flip)
 	{
-		if (sprite == nullptr)
+		if (sprite == nullptr || w <= 0 || h <= 0)
 			return;
 
-		int32_t fxs = 0, fxm = 1, fx = 0;
-		int32_t fys = 0, fym = 1, fy = 0;
-		if (flip & olc::Sprite::Flip::HORIZ) { fxs = w - 1; fxm = -1; }
-		if (flip & olc::Sprite::Flip::VERT) { fys = h - 1; fym = -1; }
+		DrawCommand cmd;
+		cmd.type = DrawCommand::Type::SPRITE;
+		cmd.sprite = sprite;
+		cmd.pos[0] = { x, y };
+		cmd.source = { ox, oy };
+		cmd.size = { w, h };
+		cmd.n = int32_t(std::max(scale, 1u));
+		cmd.nFlip = flip;
+		cmd.vMin = { x, y };
+		cmd.vMax = cmd.vMin + cmd.size * cmd.n;
+		olc_SubmitDraw(cmd);
+	}
 
-		if (scale > 1)
-		{
-			fx = fxs;
-			for (int32_t i = 0; i < w; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < h; j++, fy += fym)
-					for (uint32_t is = 0; is < scale; is++)
-						for (uint32_t js = 0; js < scale; js++)
-							Draw(x + (i * scale) + is, y + (j * scale) + js, sprite->GetPixel(fx + ox, fy + oy));
-			}
-		}
-		else
-		{
-			fx = fxs;
-			for (int32_t i = 0; i < w; i++, fx += fxm)
+	void PixelGameEngine::olc_RasterSprite(const RasterTarget& rt, int32_t x, int32_t y, Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, int32_t scale, uint8_t flip)
+	{
+		// Only the source texels that land inside the clip region
+		int32_t i1 = std::max(0, (rt.vClipMin.x - x) / scale);
+		int32_t i2 = std::min(w, (rt.vClipMax.x - x + scale - 1) / scale);
+		int32_t j1 = std::max(0, (rt.vClipMin.y - y) / scale);
+		int32_t j2 = std::min(h, (rt.vClipMax.y - y + scale - 1) / scale);
+		if (i1 >= i2 || j1 >= j2) return;
+
+		// Rows inside the sprite are drawn from it directly, unless they need flipping or
+		// scaling, and rows sampling outside it go through GetPixel() for its sample mode
+		bool bFlipX = flip & olc::Sprite::Flip::HORIZ;
+		bool bFlipY = flip & olc::Sprite::Flip::VERT;
+		bool bInside = ox >= 0 && oy >= 0 && ox + w <= sprite->width && oy + h <= sprite->height;
+		bool bDirect = bInside && !bFlipX && scale == 1;
+		if (!bDirect) rt.pScratch->resize(size_t(i2 - i1) * scale);
+
+		for (int32_t j = j1; j < j2; j++)
+		{
+			int32_t sy = oy + (bFlipY ? h - 1 - j : j);
+			const Pixel* row = nullptr;
+			if (bDirect)
+				row = sprite->GetData() + sy * sprite->width + ox + i1;
+			else
 			{
-				fy = fys;
-				for (int32_t j = 0; j < h; j++, fy += fym)
-					Draw(x + i, y + j, sprite->GetPixel(fx + ox, fy + oy));
+				Pixel* out = rt.pScratch->data();
+				for (int32_t i = i1; i < i2; i++)
+				{
+					int32_t sx = ox + (bFlipX ? w - 1 - i : i);
+					Pixel p = bInside ? sprite->GetData()[sy * sprite->width + sx] : sprite->GetPixel(sx, sy);
+					for (int32_t is = 0; is < scale; is++) *out++ = p;
+				}
+				row = rt.pScratch->data();
 			}
+
+			for (int32_t js = 0; js < scale; js++)
+				olc_DrawSpan(rt, x + i1 * scale, y + j * scale + js, row, (i2 - i1) * scale);
 		}
 	}
 
@@ -2852,7 +3847,7 @@ namespace olc
 		di.w = { 1,1,1,1 };
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		GetDecalTarget().push_back(di);
 	}
 
 	void PixelGameEngine::DrawPartialDecal(const olc::vf2d& pos, const olc::vf2d& size, olc::Decal* decal, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
@@ -2880,7 +3875,7 @@ namespace olc
 		di.w = { 1,1,1,1 };
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		GetDecalTarget().push_back(di);
 	}
 
 
@@ -2907,7 +3902,7 @@ namespace olc
 		di.w = { 1, 1, 1, 1 };
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		GetDecalTarget().push_back(di);
 	}
 
 	void PixelGameEngine::DrawExplicitDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::vf2d* uv, const olc::Pixel* col, uint32_t elements)
@@ -2928,7 +3923,7 @@ namespace olc
 		}
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		GetDecalTarget().push_back(di);
 	}
 
 	void PixelGameEngine::DrawPolygonDecal(olc::Decal* decal, const std::vector<olc::vf2d>& pos, const std::vector<olc::vf2d>& uv, const olc::Pixel tint)
@@ -2949,7 +3944,7 @@ namespace olc
 		}
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		GetDecalTarget().push_back(di);
 	}
 
 	void PixelGameEngine::DrawPolygonDecal(olc::Decal* decal, const std::vector<olc::vf2d>& pos, const std::vector<olc::vf2d>& uv, const std::vector<olc::Pixel> &tint)
@@ -2970,7 +3965,7 @@ namespace olc
 		}
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		GetDecalTarget().push_back(di);
 	}
 
 	void PixelGameEngine::DrawPolygonDecal(olc::Decal* decal, const std::vector<olc::vf2d>& pos, const std::vector<olc::vf2d>& uv, const std::vector<olc::Pixel>& colours, const olc::Pixel tint)
@@ -3000,7 +3995,7 @@ namespace olc
 		}
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		GetDecalTarget().push_back(di);
 	}
 
 #ifdef OLC_ENABLE_EXPERIMENTAL
@@ -3022,7 +4017,7 @@ namespace olc
 			di.tint[i] = col[i];			
 		}
 		di.mode = DecalMode::MODEL3D;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		GetDecalTarget().push_back(di);
 	}
 #endif
 
@@ -3050,7 +4045,7 @@ namespace olc
 		di.w[1] = 1.0f;
 		di.mode = olc::DecalMode::WIREFRAME;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);*/
+		GetDecalTarget().push_back(di);*/
 	}
 
 	void PixelGameEngine::DrawRectDecal(const olc::vf2d& pos, const olc::vf2d& size, const olc::Pixel col)
@@ -3106,7 +4101,7 @@ namespace olc
 		}
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		GetDecalTarget().push_back(di);
 	}
 
 
@@ -3135,7 +4130,7 @@ namespace olc
 		di.uv = { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } };
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		GetDecalTarget().push_back(di);
 	}
 
 	void PixelGameEngine::DrawPartialWarpedDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
@@ -3168,7 +4163,7 @@ namespace olc
 			}
 			di.mode = nDecalMode;
 			di.structure = nDecalStructure;
-			vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+			GetDecalTarget().push_back(di);
 		}
 	}
 
@@ -3200,7 +4195,7 @@ namespace olc
 			}
 			di.mode = nDecalMode;
 			di.structure = nDecalStructure;
-			vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+			GetDecalTarget().push_back(di);
 		}
 	}
 
@@ -3217,6 +4212,85 @@ namespace olc
 	{ DrawPartialWarpedDecal(decal, &pos[0], source_pos, source_size, tint); }
 
 	void PixelGameEngine::DrawStringDecal(const olc::vf2d& pos, const std::string& sText, const Pixel col, const olc::vf2d& scale)
+	{
+		// While recording, the glyphs belong in the list being recorded
+		if (pRecordingList != nullptr)
+		{
+			olc_DrawStringGlyphs(pos, sText, col, scale);
+			return;
+		}
+
+		auto key = std::make_tuple(sText, col.n, scale.x, scale.y, uint8_t(nDecalMode));
+		auto it = mapTextLayouts.find(key);
+		if (it == mapTextLayouts.end())
+		{
+			// Only strings already seen on an earlier frame get a layout. A hash
+			// collision just lays out a string early, which is harmless
+			size_t nHash = std::hash<std::string>()(sText);
+			for (size_t n : { size_t(col.n), std::hash<float>()(scale.x), std::hash<float>()(scale.y), size_t(nDecalMode) })
+				nHash = nHash * 31 + n;
+			TextSighting& sighting = vTextSightings[nHash % vTextSightings.size()];
+			bool bSeenBefore = sighting.nHash == nHash && sighting.nFrame != nTextLayoutFrame;
+			sighting = { nHash, nTextLayoutFrame };
+
+			// Make room by forgetting strings not drawn this frame, those drawn this
+			// frame may still be referenced by decal instances
+			if (bSeenBefore && mapTextLayouts.size() >= nMaxTextLayouts)
+			{
+				for (auto i = mapTextLayouts.begin(); i != mapTextLayouts.end();)
+					i = (i->second->nLastFrame != nTextLayoutFrame) ? mapTextLayouts.erase(i) : std::next(i);
+			}
+
+			if (!bSeenBefore || mapTextLayouts.size() >= nMaxTextLayouts)
+			{
+				olc_DrawStringGlyphs(pos, sText, col, scale);
+				return;
+			}
+
+			it = mapTextLayouts.emplace(key, std::make_unique<TextLayout>()).first;
+			olc_BuildTextLayout(it->second->list, sText, col, scale);
+		}
+
+		TextLayout& layout = *it->second;
+		layout.nLastFrame = nTextLayoutFrame;
+
+		// The layout was quantised at the origin, so keep the offset on whole window pixels
+		olc::vf2d vPixelsPerScreenPixel = olc::vf2d(vViewSize) * vInvScreenSize;
+		DecalInstance di;
+		di.list = &layout.list;
+		di.vListOffset = ((pos * vPixelsPerScreenPixel) + olc::vf2d(0.5f, 0.5f)).floor() / vPixelsPerScreenPixel;
+		GetDecalTarget().push_back(di);
+	}
+
+	void PixelGameEngine::olc_BuildTextLayout(olc::DecalList& list, const std::string& sText, const Pixel col, const olc::vf2d& scale)
+	{
+		// Lay the glyphs out at the origin, then merge their quads into one triangle list
+		BeginDecalList(&list);
+		olc_DrawStringGlyphs({ 0.0f, 0.0f }, sText, col, scale);
+		EndDecalList();
+
+		DecalInstance text;
+		text.decal = fontRenderable.Decal();
+		text.mode = nDecalMode;
+		text.structure = olc::DecalStructure::LIST;
+		for (const auto& glyph : list.vecDecalInstance)
+		{
+			for (uint32_t i : { 0, 1, 2, 0, 2, 3 })
+			{
+				text.pos.push_back(glyph.pos[i]);
+				text.uv.push_back(glyph.uv[i]);
+				text.w.push_back(glyph.w[i]);
+				text.tint.push_back(glyph.tint[i]);
+			}
+		}
+		text.points = uint32_t(text.pos.size());
+
+		list.vecDecalInstance.clear();
+		if (text.points > 0)
+			list.vecDecalInstance.push_back(std::move(text));
+	}
+
+	void PixelGameEngine::olc_DrawStringGlyphs(const olc::vf2d& pos, const std::string& sText, const Pixel col, const olc::vf2d& scale)
 	{
 		olc::vf2d spos = { 0.0f, 0.0f };
 		for (auto c : sText)
@@ -3308,32 +4382,129 @@ namespace olc
 		}
 	}
 
-	olc::vi2d PixelGameEngine::GetTextSize(const std::string& s)
+	std::vector<olc::DecalInstance>& PixelGameEngine::GetDecalTarget()
 	{
-		olc::vi2d size = { 0,1 };
-		olc::vi2d pos = { 0,1 };
-		for (auto c : s)
-		{
-			if (c == '\n') { pos.y++;  pos.x = 0; }
-			else if (c == '\t') { pos.x += nTabSizeInSpaces; }
-			else pos.x++;
-			size.x = std::max(size.x, pos.x);
-			size.y = std::max(size.y, pos.y);
-		}
-		return size * 8;
+		if (pRecordingList != nullptr)
+			return pRecordingList->vecDecalInstance;
+		return vLayers[nTargetLayer].vecDecalInstance;
 	}
 
-	void PixelGameEngine::DrawString(const olc::vi2d& pos, const std::string& sText, Pixel col, uint32_t scale)
-	{ DrawString(pos.x, pos.y, sText, col, scale); }
+	void PixelGameEngine::BeginDecalList(olc::DecalList* list)
+	{
+		if (list == nullptr) return;
+		list->vecDecalInstance.clear();
+		list->nRevision++;
+		pRecordingList = list;
+	}
 
-	void PixelGameEngine::DrawString(int32_t x, int32_t y, const std::string& sText, Pixel col, uint32_t scale)
+	void PixelGameEngine::EndDecalList()
+	{ pRecordingList = nullptr; }
+
+	void PixelGameEngine::DrawDecalList(olc::DecalList* list)
 	{
-		int32_t sx = 0;
-		int32_t sy = 0;
-		Pixel::Mode m = nPixelMode;
-		// Thanks @tucna, spotted bug with col.ALPHA :P
-		if (m != Pixel::CUSTOM) // Thanks @Megarev, required for "shaders"
-		{
+		if (list == nullptr || pRecordingList != nullptr) return;
+		DecalInstance di;
+		di.list = list;
+		di.vListOffset = list->vOffset;
+		di.vListScale = list->vScale;
+		GetDecalTarget().push_back(di);
+	}
+
+	void PixelGameEngine::AddLayerDecalList(uint8_t layer, olc::DecalList* list)
+	{
+		if (layer < vLayers.size() && list != nullptr)
+		{
+			auto& v = vLayers[layer].vecDecalList;
+			if (std::find(v.begin(), v.end(), list) == v.end())
+				v.push_back(list);
+		}
+	}
+
+	void PixelGameEngine::RemoveLayerDecalList(uint8_t layer, olc::DecalList* list)
+	{
+		if (layer < vLayers.size())
+		{
+			auto& v = vLayers[layer].vecDecalList;
+			v.erase(std::remove(v.begin(), v.end(), list), v.end());
+		}
+	}
+
+	void PixelGameEngine::olc_DrawDecalList(const olc::DecalList& list, const olc::vf2d& offset, const olc::vf2d& scale)
+	{
+		// Recorded positions are already in NDC, so express the pixel space
+		// transform p' = p * scale + offset in NDC too (remembering y is flipped)
+		olc::vf2d vNDCOffset =
+		{
+			scale.x - 1.0f + 2.0f * offset.x * vInvScreenSize.x,
+			1.0f - scale.y - 2.0f * offset.y * vInvScreenSize.y
+		};
+		renderer->DrawDecalList(list, vNDCOffset, scale);
+	}
+
+	olc::vi2d PixelGameEngine::GetTextSize(const std::string& s)
+	{
+		olc::vi2d size = { 0,1 };
+		olc::vi2d pos = { 0,1 };
+		for (auto c : s)
+		{
+			if (c == '\n') { pos.y++;  pos.x = 0; }
+			else if (c == '\t') { pos.x += nTabSizeInSpaces; }
+			else pos.x++;
+			size.x = std::max(size.x, pos.x);
+			size.y = std::max(size.y, pos.y);
+		}
+		return size * 8;
+	}
+
+	// Fills the set texels of a w by 8 glyph at (ox, oy) in the font, each as a scale by
+	// scale square, a run of texels along a row at a time
+	void PixelGameEngine::olc_RasterGlyph(const RasterTarget& rt, int32_t x, int32_t y, Sprite* font, int32_t ox, int32_t oy, int32_t w, int32_t scale, Pixel p)
+	{
+		for (int32_t j = 0; j < 8; j++)
+		{
+			int32_t y1 = std::max(y + j * scale, rt.vClipMin.y);
+			int32_t y2 = std::min(y + (j + 1) * scale, rt.vClipMax.y);
+			if (y1 >= y2) continue;
+
+			int32_t i = 0;
+			while (i < w)
+			{
+				if (font->GetPixel(ox + i, oy + j).r == 0) { i++; continue; }
+				int32_t nRun = i;
+				while (i < w && font->GetPixel(ox + i, oy + j).r > 0) i++;
+				for (int32_t row = y1; row < y2; row++)
+					olc_FillSpan(rt, x + nRun * scale, x + i * scale, row, p);
+			}
+		}
+	}
+
+	// Deferred, a character is one command rather than one per pixel
+	void PixelGameEngine::olc_SubmitGlyph(int32_t x, int32_t y, int32_t ox, int32_t oy, int32_t w, uint32_t scale, Pixel col)
+	{
+		DrawCommand cmd;
+		cmd.type = DrawCommand::Type::GLYPH;
+		cmd.p = col;
+		cmd.pos[0] = { x, y };
+		cmd.source = { ox, oy };
+		cmd.size = { w, 8 };
+		cmd.n = int32_t(scale);
+		cmd.sprite = fontRenderable.Sprite();
+		cmd.vMin = { x, y };
+		cmd.vMax = { x + w * int32_t(scale), y + 8 * int32_t(scale) };
+		olc_SubmitDraw(cmd);
+	}
+
+	void PixelGameEngine::DrawString(const olc::vi2d& pos, const std::string& sText, Pixel col, uint32_t scale)
+	{ DrawString(pos.x, pos.y, sText, col, scale); }
+
+	void PixelGameEngine::DrawString(int32_t x, int32_t y, const std::string& sText, Pixel col, uint32_t scale)
+	{
+		int32_t sx = 0;
+		int32_t sy = 0;
+		Pixel::Mode m = nPixelMode;
+		// Thanks @tucna, spotted bug with col.ALPHA :P
+		if (m != Pixel::CUSTOM) // Thanks @Megarev, required for "shaders"
+		{
 			if (col.a != 255)		SetPixelMode(Pixel::ALPHA);
 			else					SetPixelMode(Pixel::MASK);
 		}
@@ -3352,7 +4523,9 @@ namespace olc
 				int32_t ox = (c - 32) % 16;
 				int32_t oy = (c - 32) / 16;
 
-				if (scale > 1)
+				if (bDeferDrawing && nPixelMode != Pixel::CUSTOM)
+					olc_SubmitGlyph(x + sx, y + sy, ox * 8, oy * 8, 8, scale, col);
+				else if (scale > 1)
 				{
 					for (uint32_t i = 0; i < 8; i++)
 						for (uint32_t j = 0; j < 8; j++)
@@ -3420,7 +4593,9 @@ namespace olc
 				int32_t ox = (c - 32) % 16;
 				int32_t oy = (c - 32) / 16;
 
-				if (scale > 1)
+				if (bDeferDrawing && nPixelMode != Pixel::CUSTOM)
+					olc_SubmitGlyph(x + sx, y + sy, ox * 8 + vFontSpacing[c - 32].x, oy * 8, vFontSpacing[c - 32].y, scale, col);
+				else if (scale > 1)
 				{
 					for (int32_t i = 0; i < vFontSpacing[c - 32].y; i++)
 						for (int32_t j = 0; j < 8; j++)
@@ -3712,15 +4887,19 @@ namespace olc
 	{
 		vWindowSize = { x, y };
 		olc_UpdateViewport();
+		// The window contents are stale, even if the game's aren't
+		bForceRedraw = true;
+		olc_WakeFromIdle();
 	}
 
 	void PixelGameEngine::olc_UpdateMouseWheel(int32_t delta)
-	{ nMouseWheelDeltaCache += delta; }
+	{ nMouseWheelDeltaCache += delta; olc_WakeFromIdle(); }
 
 	void PixelGameEngine::olc_UpdateMouse(int32_t x, int32_t y)
 	{
 		// Mouse coords come in screen space
 		// But leave in pixel space
+		olc_WakeFromIdle();
 		bHasMouseFocus = true;
 		vMouseWindowPos = { x, y };
 		// Full Screen mode may have a weird viewport we must clamp to
@@ -3735,19 +4914,20 @@ namespace olc
 	}
 
 	void PixelGameEngine::olc_UpdateMouseState(int32_t button, bool state)
-	{ pMouseNewState[button] = state; }
+	{ pMouseNewState[button] = state; olc_WakeFromIdle(); }
 
 	void PixelGameEngine::olc_UpdateKeyState(int32_t key, bool state)
-	{ pKeyNewState[key] = state; }
+	{ pKeyNewState[key] = state; olc_WakeFromIdle(); }
 
 	void PixelGameEngine::olc_UpdateMouseFocus(bool state)
-	{ bHasMouseFocus = state; }
+	{ bHasMouseFocus = state; olc_WakeFromIdle(); }
 
 	void PixelGameEngine::olc_UpdateKeyFocus(bool state)
-	{ bHasInputFocus = state; }
+	{ bHasInputFocus = state; olc_WakeFromIdle(); }
 
 	void PixelGameEngine::olc_DropFiles(int32_t x, int32_t y, const std::vector<std::string>& vFiles)
 	{ 
+		olc_WakeFromIdle();
 		x -= vViewPos.x;
 		y -= vViewPos.y;
 		vDroppedFilesPointCache.x = (int32_t)(((float)x / (float)(vWindowSize.x - (vViewPos.x * 2)) * (float)vScreenSize.x));
@@ -3766,7 +4946,16 @@ namespace olc
 	{ return bAtomActive; }
 
 	void PixelGameEngine::olc_Terminate()
-	{ bAtomActive = false; }
+	{ bAtomActive = false; olc_WakeFromIdle(); }
+
+	void PixelGameEngine::olc_WakeFromIdle()
+	{
+		{
+			std::lock_guard<std::mutex> lock(muxIdle);
+			bIdleWake = true;
+		}
+		cvIdle.notify_one();
+	}
 
 	void PixelGameEngine::EngineThread()
 	{
@@ -3784,8 +4973,8 @@ namespace olc
 
 		while (bAtomActive)
 		{
-			// Run as fast as possible
-			while (bAtomActive) { olc_CoreUpdate(); }
+			// Run as fast as the frame rate limit and idle frames allow
+			while (bAtomActive) { olc_CoreUpdate(); olc_PaceFrame(); }
 
 			// Allow the user to free resources if they have overrided the destroy function
 			if (!OnUserDestroy())
@@ -3798,6 +4987,44 @@ namespace olc
 		platform->ThreadCleanUp();
 	}
 
+	void PixelGameEngine::olc_PaceFrame()
+	{
+		using namespace std::chrono;
+		auto tpNow = steady_clock::now();
+
+		if (bIdleFrame)
+		{
+			// Some platforms only collect input when asked, so the wait is sliced
+			// to pump their events, others wake it as soon as input arrives
+			auto tpWake = tpNow + duration_cast<steady_clock::duration>(duration<float>(fIdleWakeAfter));
+			std::unique_lock<std::mutex> lock(muxIdle);
+			while (bAtomActive && !bIdleWake && steady_clock::now() < tpWake)
+			{
+				cvIdle.wait_until(lock, std::min(tpWake, steady_clock::now() + milliseconds(10)), [&] { return bIdleWake.load(); });
+				lock.unlock();
+				platform->HandleSystemEvent();
+				lock.lock();
+			}
+			bIdleWake = false;
+			tpNextFrame = steady_clock::now();
+			return;
+		}
+
+		bIdleWake = false;
+		if (nFrameRateLimit == 0) return;
+
+		// Late by more than a frame (vsync, a slow frame), so start again from now
+		// rather than rushing frames out to catch up
+		auto tpPeriod = duration_cast<steady_clock::duration>(duration<double>(1.0 / double(nFrameRateLimit)));
+		tpNextFrame += tpPeriod;
+		if (tpNextFrame + tpPeriod < tpNow) tpNextFrame = tpNow;
+		if (tpNextFrame <= tpNow) return;
+
+		// Sleeping can overshoot a little, but frames are scheduled from tpNextFrame
+		// rather than from when the sleep ended, so it doesn't add up over frames
+		std::this_thread::sleep_until(tpNextFrame);
+	}
+
 	void PixelGameEngine::olc_PrepareEngine()
 	{
 		// Start OpenGL, the context is owned by the game thread
@@ -3812,15 +5039,16 @@ namespace olc
 		vLayers[0].bShow = true;
 		SetDrawTarget(nullptr);
 
-		m_tp1 = std::chrono::system_clock::now();
-		m_tp2 = std::chrono::system_clock::now();
+		m_tp1 = std::chrono::steady_clock::now();
+		m_tp2 = std::chrono::steady_clock::now();
+		tpNextFrame = m_tp2;
 	}
 
 
 	void PixelGameEngine::olc_CoreUpdate()
 	{
 		// Handle Timing
-		m_tp2 = std::chrono::system_clock::now();
+		m_tp2 = std::chrono::steady_clock::now();
 		std::chrono::duration<float> elapsedTime = m_tp2 - m_tp1;
 		m_tp1 = m_tp2;
 
@@ -3834,6 +5062,14 @@ namespace olc
 		// Some platforms will need to check for events
 		platform->HandleSystemEvent();
 
+		// Text layouts are in NDC, so a new screen or window size invalidates them
+		nTextLayoutFrame++;
+		if (bTextLayoutsStale)
+		{
+			mapTextLayouts.clear();
+			bTextLayoutsStale = false;
+		}
+
 		// Compare hardware input states from previous frame
 		auto ScanHardware = [&](HWButton* pKeys, bool* pStateOld, bool* pStateNew, uint32_t nKeyCount)
 		{
@@ -3876,6 +5112,7 @@ namespace olc
 		}
 
 		// Handle Frame Update
+		bIdleFrame = false;
 		bool bExtensionBlockFrame = false;		
 		for (auto& ext : vExtensions) bExtensionBlockFrame |= ext->OnBeforeUserUpdate(fElapsedTime);
 		if (!bExtensionBlockFrame)
@@ -3891,14 +5128,48 @@ namespace olc
 			UpdateConsole();
 		}
 
-		
+		// Deferred CPU drawing has to land before the layers are uploaded
+		FlushDrawing();
+
+		// The console and a resized window always need drawing
+		if (bForceRedraw.exchange(false) || bConsoleShow)
+			bIdleFrame = false;
+
+		if (bIdleFrame)
+		{
+			// Nothing changed, so the last frame stays on screen. Layers drawn to
+			// keep their dirty regions for the next frame that is shown
+			for (auto& layer : vLayers) layer.vecDecalInstance.clear();
+		}
+		else
+			olc_PresentFrame();
+
+		// Update Title Bar
+		fFrameTimer += fElapsedTime;
+		if (fFrameTimer >= 1.0f)
+		{
+			nLastFPS = nFrameCount;
+			fFrameTimer -= 1.0f;
+			std::string sTitle = "OneLoneCoder.com - Pixel Game Engine - " + sAppName + " - FPS: " + std::to_string(nFrameCount);
+			platform->SetWindowTitle(sTitle);
+			nFrameCount = 0;
+		}
+	}
 
+	void PixelGameEngine::olc_PresentFrame()
+	{
 		// Display Frame
 		renderer->UpdateViewport(vViewPos, vViewSize);
 		renderer->ClearBuffer(olc::BLACK, true);
 
-		// Layer 0 must always exist
-		vLayers[0].bUpdate = true;
+		bool bScaled = false;
+		if (bDynamicResolution && fRenderScale < 1.0f)
+		{
+			olc::vi2d vRenderSize = { std::max(int32_t(float(vViewSize.x) * fRenderScale), 1), std::max(int32_t(float(vViewSize.y) * fRenderScale), 1) };
+			bScaled = renderer->BeginScaledFrame(vRenderSize);
+		}
+
+		// Layer 0 must always exist, but is only uploaded if it was drawn to
 		vLayers[0].bShow = true;
 		SetDecalMode(DecalMode::NORMAL);
 		renderer->PrepareDrawing();
@@ -3910,17 +5181,23 @@ namespace olc
 				if (layer->funcHook == nullptr)
 				{
 					renderer->ApplyTexture(layer->pDrawTarget.Decal()->id);
-					if (!bSuspendTextureTransfer && layer->bUpdate)
-					{
-						layer->pDrawTarget.Decal()->Update();
-						layer->bUpdate = false;
-					}
+					if (!bSuspendTextureTransfer)
+						olc_UploadLayer(*layer);
 
 					renderer->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
 
+					// Display retained decal lists kept on this layer
+					for (auto& list : layer->vecDecalList)
+						if (list->bShow) olc_DrawDecalList(*list, list->vOffset, list->vScale);
+
 					// Display Decals in order for this layer
 					for (auto& decal : layer->vecDecalInstance)
-						renderer->DrawDecal(decal);
+					{
+						if (decal.list != nullptr)
+							olc_DrawDecalList(*decal.list, decal.vListOffset, decal.vListScale);
+						else
+							renderer->DrawDecal(decal);
+					}
 					layer->vecDecalInstance.clear();
 				}
 				else
@@ -3933,20 +5210,34 @@ namespace olc
 
 		
 
-		// Present Graphics to screen
-		renderer->DisplayFrame();
+		if (bScaled) renderer->EndScaledFrame();
 
-		// Update Title Bar
-		fFrameTimer += fElapsedTime;
+		// Present Graphics to screen. The present can wait for the display even with
+		// vsync off (compositor, driver forced vsync), which would make every frame
+		// measure one refresh, so dynamic resolution goes by the time up to here
+		auto tpDrawn = std::chrono::steady_clock::now();
+		renderer->DisplayFrame();
 		nFrameCount++;
-		if (fFrameTimer >= 1.0f)
-		{
-			nLastFPS = nFrameCount;
-			fFrameTimer -= 1.0f;
-			std::string sTitle = "OneLoneCoder.com - Pixel Game Engine - " + sAppName + " - FPS: " + std::to_string(nFrameCount);
-			platform->SetWindowTitle(sTitle);
-			nFrameCount = 0;
-		}
+		if (bDynamicResolution) olc_UpdateRenderScale(std::chrono::duration<float>(tpDrawn - m_tp2).count());
+	}
+
+	void PixelGameEngine::olc_UpdateRenderScale(float fFrameTime)
+	{
+		fFrameTimeAverage = (nFramesAtScale == 0) ? fFrameTime : fFrameTimeAverage + (fFrameTime - fFrameTimeAverage) * 0.1f;
+		if (++nFramesAtScale < 20) return;
+
+		// Drawing cost follows the area, so correct the side by the square root of
+		// how far the frame is from its target, a little under budget. Scale down as
+		// soon as it's over budget, but only back up with some room to spare, so it
+		// doesn't hunt around the budget
+		float fTarget = fRenderScale;
+		if (fFrameTimeAverage > fFrameBudget || fFrameTimeAverage < fFrameBudget * 0.7f)
+			fTarget = fRenderScale * std::sqrt(fFrameBudget * 0.85f / std::max(fFrameTimeAverage, 1e-4f));
+		fTarget = std::min(std::max(fTarget, fMinRenderScale), 1.0f);
+		if (std::abs(fTarget - fRenderScale) < 0.02f) return;
+
+		fRenderScale = fTarget;
+		nFramesAtScale = 0;
 	}
 
 	void PixelGameEngine::olc_ConstructFontSheet()
@@ -3998,100 +5289,1323 @@ namespace olc
 			0x24,0x18,0x17,0x17,0x17,0x17,0x17,0x17,0x17,0x33,0x17,0x17,0x33,0x18,0x17,0x17,
 			0x17,0x17,0x17,0x17,0x07,0x17,0x17,0x18,0x18,0x17,0x17,0x07,0x33,0x07,0x08,0x00, } };
 
-		for (auto c : vSpacing) vFontSpacing.push_back({ c >> 4, c & 15 });
+		for (auto c : vSpacing) vFontSpacing.push_back({ c >> 4, c & 15 });
+
+		// UK Standard Layout
+#ifdef OLC_KEYBOARD_UK
+		vKeyboardMap =
+		{
+			{olc::Key::A, "a", "A"}, {olc::Key::B, "b", "B"}, {olc::Key::C, "c", "C"}, {olc::Key::D, "d", "D"}, {olc::Key::E, "e", "E"},
+			{olc::Key::F, "f", "F"}, {olc::Key::G, "g", "G"}, {olc::Key::H, "h", "H"}, {olc::Key::I, "i", "I"}, {olc::Key::J, "j", "J"},
+			{olc::Key::K, "k", "K"}, {olc::Key::L, "l", "L"}, {olc::Key::M, "m", "M"}, {olc::Key::N, "n", "N"}, {olc::Key::O, "o", "O"},
+			{olc::Key::P, "p", "P"}, {olc::Key::Q, "q", "Q"}, {olc::Key::R, "r", "R"}, {olc::Key::S, "s", "S"}, {olc::Key::T, "t", "T"},
+			{olc::Key::U, "u", "U"}, {olc::Key::V, "v", "V"}, {olc::Key::W, "w", "W"}, {olc::Key::X, "x", "X"}, {olc::Key::Y, "y", "Y"},
+			{olc::Key::Z, "z", "Z"},
+
+			{olc::Key::K0, "0", ")"}, {olc::Key::K1, "1", "!"}, {olc::Key::K2, "2", "\""}, {olc::Key::K3, "3", "#"},	{olc::Key::K4, "4", "$"},
+			{olc::Key::K5, "5", "%"}, {olc::Key::K6, "6", "^"}, {olc::Key::K7, "7", "&"}, {olc::Key::K8, "8", "*"},	{olc::Key::K9, "9", "("},
+
+			{olc::Key::NP0, "0", "0"}, {olc::Key::NP1, "1", "1"}, {olc::Key::NP2, "2", "2"}, {olc::Key::NP3, "3", "3"},	{olc::Key::NP4, "4", "4"},
+			{olc::Key::NP5, "5", "5"}, {olc::Key::NP6, "6", "6"}, {olc::Key::NP7, "7", "7"}, {olc::Key::NP8, "8", "8"},	{olc::Key::NP9, "9", "9"},
+			{olc::Key::NP_MUL, "*", "*"}, {olc::Key::NP_DIV, "/", "/"}, {olc::Key::NP_ADD, "+", "+"}, {olc::Key::NP_SUB, "-", "-"},	{olc::Key::NP_DECIMAL, ".", "."},
+
+			{olc::Key::PERIOD, ".", ">"}, {olc::Key::EQUALS, "=", "+"}, {olc::Key::COMMA, ",", "<"}, {olc::Key::MINUS, "-", "_"}, {olc::Key::SPACE, " ", " "},
+
+			{olc::Key::OEM_1, ";", ":"}, {olc::Key::OEM_2, "/", "?"}, {olc::Key::OEM_3, "\'", "@"}, {olc::Key::OEM_4, "[", "{"},
+			{olc::Key::OEM_5, "\\", "|"}, {olc::Key::OEM_6, "]", "}"}, {olc::Key::OEM_7, "#", "~"}, 
+			
+			// {olc::Key::TAB, "\t", "\t"}
+		};
+#endif
+	}
+
+	void PixelGameEngine::pgex_Register(olc::PGEX* pgex)
+	{
+		if (std::find(vExtensions.begin(), vExtensions.end(), pgex) == vExtensions.end())
+			vExtensions.push_back(pgex);			
+	}
+
+
+	PGEX::PGEX(bool bHook) { if(bHook) pge->pgex_Register(this); }
+	void PGEX::OnBeforeUserCreate() {}
+	void PGEX::OnAfterUserCreate()	{}
+	bool PGEX::OnBeforeUserUpdate(float& fElapsedTime) { return false; }
+	void PGEX::OnAfterUserUpdate(float fElapsedTime) {}
+
+	// Need a couple of statics as these are singleton instances
+	// read from multiple locations
+	std::atomic<bool> PixelGameEngine::bAtomActive{ false };
+	olc::PixelGameEngine* olc::PGEX::pge = nullptr;
+	olc::PixelGameEngine* olc::Platform::ptrPGE = nullptr;
+	olc::PixelGameEngine* olc::Renderer::ptrPGE = nullptr;
+	std::unique_ptr<ImageLoader> olc::Sprite::loader = nullptr;
+};
+#pragma endregion 
+
+
+#pragma region platform_headless
+namespace olc
+{
+#if defined(OLC_GFX_HEADLESS)
+	class Renderer_Headless : public olc::Renderer
+	{
+	public:
+		virtual void       PrepareDevice() {};
+		virtual olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) { return olc::rcode::OK;		}
+		virtual olc::rcode DestroyDevice() { return olc::rcode::OK; }
+		virtual void       DisplayFrame() {}
+		virtual void       PrepareDrawing() {}
+		virtual void	   SetDecalMode(const olc::DecalMode& mode) {}
+		virtual void       DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) {}
+		virtual void       DrawDecal(const olc::DecalInstance& decal) {}
+		virtual uint32_t   CreateTexture(const uint32_t width, const uint32_t height, const bool filtered = false, const bool clamp = true) {return 1;};
+		virtual void       UpdateTexture(uint32_t id, olc::Sprite* spr) {}
+		virtual void       ReadTexture(uint32_t id, olc::Sprite* spr) {}
+		virtual uint32_t   DeleteTexture(const uint32_t id) {return 1;}
+		virtual void       ApplyTexture(uint32_t id) {}
+		virtual void       UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) {}
+		virtual void       ClearBuffer(olc::Pixel p, bool bDepth) {}
+	};
+#endif
+#if defined(OLC_PLATFORM_HEADLESS)
+	class Platform_Headless : public olc::Platform
+	{
+	public:
+		virtual olc::rcode ApplicationStartUp() { return olc::rcode::OK; }
+		virtual olc::rcode ApplicationCleanUp() { return olc::rcode::OK; }
+		virtual olc::rcode ThreadStartUp() { return olc::rcode::OK; }
+		virtual olc::rcode ThreadCleanUp() { return olc::rcode::OK; }
+		virtual olc::rcode CreateGraphics(bool bFullScreen, bool bEnableVSYNC, const olc::vi2d& vViewPos, const olc::vi2d& vViewSize) { return olc::rcode::OK; }
+		virtual olc::rcode CreateWindowPane(const olc::vi2d& vWindowPos, olc::vi2d& vWindowSize, bool bFullScreen) { return olc::rcode::OK; }
+		virtual olc::rcode SetWindowTitle(const std::string& s) { return olc::rcode::OK; }
+		virtual olc::rcode StartSystemEventLoop() { return olc::rcode::OK; }
+		virtual olc::rcode HandleSystemEvent() { return olc::rcode::OK; }
+	};
+#endif
+}
+#pragma endregion
+
+#pragma region renderer_software
+// O------------------------------------------------------------------------------O
+// | START RENDERER: Software, tiled and multithreaded, no GPU required          |
+// O------------------------------------------------------------------------------O
+// Rasterizes layers and decals on the CPU into a framebuffer sprite. Intended for
+// headless builds (servers, golden images, draw pipeline benchmarks):
+//
+// #define OLC_PGE_HEADLESS
+// #define OLC_GFX_SOFTWARE
+// #define OLC_IMAGE_LIBPNG  // to still load (and save) images when headless
+//
+// Drawing is deferred until DisplayFrame(), or until a texture changes. Then the
+// primitives are binned into 64x64 pixel tiles, and the tiles are rasterized in
+// parallel, each drawing its primitives in submission order. The finished frame
+// is available from PixelGameEngine::GetFramebuffer()
+#if defined(OLC_GFX_SOFTWARE)
+
+namespace olc
+{
+	class Renderer_Software : public olc::Renderer
+	{
+	private:
+		struct swTexture
+		{
+			int32_t width = 0;
+			int32_t height = 0;
+			bool bFiltered = false;
+			bool bClamp = true;
+			std::vector<olc::Pixel> data;
+			std::vector<swTexture> vMips; // Levels 1 and up, when mipmapped
+		};
+
+		struct swVertex
+		{
+			float x, y;     // Framebuffer pixels
+			float attr[7];  // u, v, w (uv is divided by w per pixel), then r, g, b, a tint
+		};
+
+		enum class swType { CLEAR, TRIANGLE, LINE };
+
+		struct swPrimitive
+		{
+			swType type = swType::TRIANGLE;
+			swVertex v[3];
+			const swTexture* tex = nullptr;
+			olc::DecalMode mode = olc::DecalMode::NORMAL;
+			olc::Pixel col; // Clear colour
+			int32_t x0 = 0, y0 = 0, x1 = 0, y1 = 0; // Inclusive pixel bounds
+		};
+
+		static constexpr int32_t nTileSize = 64;
+
+		std::map<uint32_t, swTexture> mapTextures;
+		uint32_t nNextTexture = 1;
+		uint32_t nBoundTexture = 0;
+		olc::DecalMode nDecalMode = olc::DecalMode::NORMAL;
+
+		std::unique_ptr<olc::Sprite> sprFramebuffer;
+		olc::vi2d vViewPos = { 0, 0 };
+		olc::vi2d vViewSize = { 0, 0 };
+		olc::vi2d vFullViewSize = { 0, 0 }; // While a scaled frame is drawn
+		bool bScaledFrame = false;
+		std::vector<olc::Pixel> vScaledFrame;
+		int32_t nTilesX = 0;
+		int32_t nTilesY = 0;
+		std::vector<swPrimitive> vPrimitives;
+		std::vector<std::vector<uint32_t>> vTileBins;
+		olc::WorkerPool pool;
+
+	public:
+		void PrepareDevice() override
+		{}
+
+		olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) override
+		{
+			UNUSED(params);
+			UNUSED(bFullScreen);
+			UNUSED(bVSYNC);
+			return olc::rcode::OK;
+		}
+
+		olc::rcode DestroyDevice() override
+		{
+			vPrimitives.clear();
+			mapTextures.clear();
+			return olc::rcode::OK;
+		}
+
+		void DisplayFrame() override
+		{ Flush(); }
+
+		void PrepareDrawing() override
+		{ nDecalMode = olc::DecalMode::NORMAL; }
+
+		void SetDecalMode(const olc::DecalMode& mode) override
+		{ nDecalMode = mode; }
+
+		void DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) override
+		{
+			auto it = mapTextures.find(nBoundTexture);
+			const swTexture* tex = (it != mapTextures.end()) ? &it->second : nullptr;
+
+			swVertex v[4] = {
+				MakeVertex({ -1.0f, -1.0f }, { 0.0f * scale.x + offset.x, 1.0f * scale.y + offset.y }, 1.0f, tint),
+				MakeVertex({ +1.0f, -1.0f }, { 1.0f * scale.x + offset.x, 1.0f * scale.y + offset.y }, 1.0f, tint),
+				MakeVertex({ -1.0f, +1.0f }, { 0.0f * scale.x + offset.x, 0.0f * scale.y + offset.y }, 1.0f, tint),
+				MakeVertex({ +1.0f, +1.0f }, { 1.0f * scale.x + offset.x, 0.0f * scale.y + offset.y }, 1.0f, tint),
+			};
+
+			SubmitTriangle(v[0], v[1], v[2], tex);
+			SubmitTriangle(v[1], v[2], v[3], tex);
+		}
+
+		void DrawDecal(const olc::DecalInstance& decal) override
+		{
+			SetDecalMode(decal.mode);
+			if (nDecalMode == olc::DecalMode::MODEL3D || decal.points < 2) return;
+
+			const swTexture* tex = nullptr;
+			if (decal.decal != nullptr)
+			{
+				auto it = mapTextures.find(decal.decal->id);
+				if (it != mapTextures.end()) tex = &it->second;
+			}
+
+			std::vector<swVertex> v(decal.points);
+			for (uint32_t i = 0; i < decal.points; i++)
+				v[i] = MakeVertex(decal.pos[i], decal.uv[i], decal.w[i], decal.tint[i]);
+
+			if (nDecalMode == olc::DecalMode::WIREFRAME)
+			{
+				for (uint32_t i = 0; i < decal.points; i++)
+					SubmitLine(v[i], v[(i + 1) % decal.points], tex);
+			}
+			else if (decal.structure == olc::DecalStructure::FAN)
+			{
+				for (uint32_t i = 1; i + 1 < decal.points; i++)
+					SubmitTriangle(v[0], v[i], v[i + 1], tex);
+			}
+			else if (decal.structure == olc::DecalStructure::STRIP)
+			{
+				for (uint32_t i = 0; i + 2 < decal.points; i++)
+					SubmitTriangle(v[i], v[i + 1], v[i + 2], tex);
+			}
+			else if (decal.structure == olc::DecalStructure::LIST)
+			{
+				for (uint32_t i = 0; i + 2 < decal.points; i += 3)
+					SubmitTriangle(v[i], v[i + 1], v[i + 2], tex);
+			}
+		}
+
+		uint32_t CreateTexture(const uint32_t width, const uint32_t height, const bool filtered, const bool clamp) override
+		{
+			uint32_t id = nNextTexture++;
+			swTexture& tex = mapTextures[id];
+			tex.width = int32_t(width);
+			tex.height = int32_t(height);
+			tex.bFiltered = filtered;
+			tex.bClamp = clamp;
+			tex.data.resize(size_t(width) * size_t(height));
+			return id;
+		}
+
+		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
+		{
+			auto it = mapTextures.find(id);
+			if (it == mapTextures.end() || spr == nullptr) return;
+
+			// Queued primitives must see the texture as it was when they were drawn
+			Flush();
+			it->second.width = spr->width;
+			it->second.height = spr->height;
+			it->second.data = spr->pColData;
+			it->second.vMips.clear();
+		}
+
+		void UpdateTextureMipLevels(uint32_t id, const std::vector<std::unique_ptr<olc::Sprite>>& vLevels) override
+		{
+			auto it = mapTextures.find(id);
+			if (it == mapTextures.end()) return;
+
+			Flush();
+			swTexture& tex = it->second;
+			tex.vMips.resize(vLevels.size());
+			for (size_t i = 0; i < vLevels.size(); i++)
+			{
+				tex.vMips[i].width = vLevels[i]->width;
+				tex.vMips[i].height = vLevels[i]->height;
+				tex.vMips[i].bFiltered = tex.bFiltered;
+				tex.vMips[i].bClamp = tex.bClamp;
+				tex.vMips[i].data = vLevels[i]->pColData;
+			}
+		}
+
+		void UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			auto it = mapTextures.find(id);
+			if (it == mapTextures.end() || spr == nullptr) return;
+
+			swTexture& tex = it->second;
+			if (tex.width != spr->width || tex.height != spr->height)
+			{
+				UpdateTexture(id, spr);
+				return;
+			}
+
+			Flush();
+			for (int32_t y = pos.y; y < pos.y + size.y; y++)
+				std::memcpy(&tex.data[y * tex.width + pos.x], spr->GetData() + y * spr->width + pos.x, sizeof(olc::Pixel) * size.x);
+		}
+
+		void ReadTexture(uint32_t id, olc::Sprite* spr) override
+		{
+			auto it = mapTextures.find(id);
+			if (it == mapTextures.end() || spr == nullptr) return;
+
+			Flush();
+			spr->width = it->second.width;
+			spr->height = it->second.height;
+			spr->pColData = it->second.data;
+		}
+
+		uint32_t DeleteTexture(const uint32_t id) override
+		{
+			Flush();
+			mapTextures.erase(id);
+			return id;
+		}
+
+		void ApplyTexture(uint32_t id) override
+		{ nBoundTexture = id; }
+
+		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			vViewPos = pos;
+			vViewSize = size;
+
+			// The framebuffer covers the whole window, which centres the viewport
+			olc::vi2d vFrameSize = size + pos * 2;
+			if (!sprFramebuffer || sprFramebuffer->width != vFrameSize.x || sprFramebuffer->height != vFrameSize.y)
+			{
+				Flush();
+				sprFramebuffer = std::make_unique<olc::Sprite>(vFrameSize.x, vFrameSize.y);
+				nTilesX = (vFrameSize.x + nTileSize - 1) / nTileSize;
+				nTilesY = (vFrameSize.y + nTileSize - 1) / nTileSize;
+				vTileBins.resize(size_t(nTilesX) * size_t(nTilesY));
+			}
+		}
+
+		void ClearBuffer(olc::Pixel p, bool bDepth) override
+		{
+			UNUSED(bDepth);
+			if (!sprFramebuffer) return;
+			swPrimitive prim;
+			prim.type = swType::CLEAR;
+			prim.col = p;
+			prim.x1 = sprFramebuffer->width - 1;
+			prim.y1 = sprFramebuffer->height - 1;
+			vPrimitives.push_back(prim);
+		}
+
+		bool BeginScaledFrame(const olc::vi2d& vRenderSize) override
+		{
+			if (!sprFramebuffer) return false;
+			vFullViewSize = vViewSize;
+			vViewSize = vViewSize.min(vRenderSize);
+			bScaledFrame = true;
+			return true;
+		}
+
+		void EndScaledFrame() override
+		{
+			if (!bScaledFrame) return;
+			Flush();
+
+			// Nearest neighbour, from a copy as the stretch covers its source
+			olc::vi2d vSrc = vViewSize;
+			vScaledFrame.resize(size_t(vSrc.x) * size_t(vSrc.y));
+			for (int32_t y = 0; y < vSrc.y; y++)
+				std::memcpy(&vScaledFrame[size_t(y) * vSrc.x], sprFramebuffer->GetData() + (vViewPos.y + y) * sprFramebuffer->width + vViewPos.x, sizeof(olc::Pixel) * vSrc.x);
+
+			vViewSize = vFullViewSize;
+			bScaledFrame = false;
+
+			std::vector<int32_t> vColumn(vViewSize.x);
+			for (int32_t x = 0; x < vViewSize.x; x++)
+				vColumn[x] = int32_t(((int64_t(x) * 2 + 1) * vSrc.x) / (int64_t(vViewSize.x) * 2));
+
+			uint32_t nBands = uint32_t(nTilesY);
+			pool.ParallelFor(nBands, [&](uint32_t nBand)
+			{
+				int32_t y1 = int32_t(nBand) * nTileSize, y2 = std::min(y1 + nTileSize, vViewSize.y);
+				for (int32_t y = y1; y < y2; y++)
+				{
+					const olc::Pixel* src = &vScaledFrame[size_t((int64_t(y) * 2 + 1) * vSrc.y / (int64_t(vViewSize.y) * 2)) * vSrc.x];
+					olc::Pixel* dst = sprFramebuffer->GetData() + (vViewPos.y + y) * sprFramebuffer->width + vViewPos.x;
+					for (int32_t x = 0; x < vViewSize.x; x++)
+						dst[x] = src[vColumn[x]];
+				}
+			});
+		}
+
+		olc::Sprite* GetFramebuffer() override
+		{ return sprFramebuffer.get(); }
+
+	private:
+		swVertex MakeVertex(const olc::vf2d& pos, const olc::vf2d& uv, const float w, const olc::Pixel& tint) const
+		{
+			swVertex v;
+			v.x = (pos.x + 1.0f) * 0.5f * float(vViewSize.x) + float(vViewPos.x);
+			v.y = (1.0f - pos.y) * 0.5f * float(vViewSize.y) + float(vViewPos.y);
+			v.attr[0] = uv.x; v.attr[1] = uv.y; v.attr[2] = w;
+			v.attr[3] = tint.r; v.attr[4] = tint.g; v.attr[5] = tint.b; v.attr[6] = tint.a;
+			return v;
+		}
+
+		bool ClipBounds(swPrimitive& prim, float minx, float miny, float maxx, float maxy) const
+		{
+			if (!sprFramebuffer || !(minx == minx) || !(maxx == maxx) || !(miny == miny) || !(maxy == maxy)) return false;
+			// Clipped to the viewport, as GL does
+			prim.x0 = int32_t(std::max(std::floor(minx), float(vViewPos.x)));
+			prim.y0 = int32_t(std::max(std::floor(miny), float(vViewPos.y)));
+			prim.x1 = int32_t(std::min(std::ceil(maxx), float(std::min(vViewPos.x + vViewSize.x, sprFramebuffer->width) - 1)));
+			prim.y1 = int32_t(std::min(std::ceil(maxy), float(std::min(vViewPos.y + vViewSize.y, sprFramebuffer->height) - 1)));
+			return prim.x0 <= prim.x1 && prim.y0 <= prim.y1;
+		}
+
+		void SubmitTriangle(const swVertex& a, const swVertex& b, const swVertex& c, const swTexture* tex)
+		{
+			// Nothing is culled, so wind every triangle the same way
+			float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+			if (area == 0.0f || !(area == area)) return;
+
+			swPrimitive prim;
+			prim.type = swType::TRIANGLE;
+			prim.v[0] = a;
+			prim.v[1] = area > 0.0f ? b : c;
+			prim.v[2] = area > 0.0f ? c : b;
+			prim.tex = (tex != nullptr && !tex->vMips.empty()) ? SelectMipLevel(tex, a, b, c, std::abs(area)) : tex;
+			prim.mode = nDecalMode;
+			if (ClipBounds(prim, std::min({ a.x, b.x, c.x }), std::min({ a.y, b.y, c.y }), std::max({ a.x, b.x, c.x }), std::max({ a.y, b.y, c.y })))
+				vPrimitives.push_back(prim);
+		}
+
+		// One level for the whole triangle, the one nearest a texel per pixel, as
+		// GL_*_MIPMAP_NEAREST would choose for a triangle drawn without perspective
+		static const swTexture* SelectMipLevel(const swTexture* tex, const swVertex& a, const swVertex& b, const swVertex& c, float fPixelArea)
+		{
+			float u0 = a.attr[0] / a.attr[2], v0 = a.attr[1] / a.attr[2];
+			float u1 = b.attr[0] / b.attr[2] - u0, v1 = b.attr[1] / b.attr[2] - v0;
+			float u2 = c.attr[0] / c.attr[2] - u0, v2 = c.attr[1] / c.attr[2] - v0;
+			float fTexelArea = std::abs(u1 * v2 - v1 * u2) * float(tex->width) * float(tex->height);
+			if (!(fTexelArea > fPixelArea)) return tex;
+
+			float fLod = std::min(0.5f * std::log2(fTexelArea / fPixelArea), float(tex->vMips.size()));
+			int32_t nLevel = int32_t(fLod + 0.5f);
+			return nLevel > 0 ? &tex->vMips[nLevel - 1] : tex;
+		}
+
+		void SubmitLine(const swVertex& a, const swVertex& b, const swTexture* tex)
+		{
+			swPrimitive prim;
+			prim.type = swType::LINE;
+			prim.v[0] = a;
+			prim.v[1] = b;
+			prim.tex = tex;
+			prim.mode = olc::DecalMode::NORMAL;
+			if (ClipBounds(prim, std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y)))
+				vPrimitives.push_back(prim);
+		}
+
+		void Flush()
+		{
+			if (vPrimitives.empty() || !sprFramebuffer)
+			{
+				vPrimitives.clear();
+				return;
+			}
+
+			for (auto& bin : vTileBins) bin.clear();
+			for (uint32_t i = 0; i < uint32_t(vPrimitives.size()); i++)
+			{
+				const swPrimitive& prim = vPrimitives[i];
+				for (int32_t ty = prim.y0 / nTileSize; ty <= prim.y1 / nTileSize; ty++)
+					for (int32_t tx = prim.x0 / nTileSize; tx <= prim.x1 / nTileSize; tx++)
+						vTileBins[ty * nTilesX + tx].push_back(i);
+			}
+
+			pool.ParallelFor(uint32_t(vTileBins.size()), [&](uint32_t nTile) { RasterizeTile(nTile); });
+			vPrimitives.clear();
+		}
+
+		void RasterizeTile(uint32_t nTile)
+		{
+			const std::vector<uint32_t>& bin = vTileBins[nTile];
+			if (bin.empty()) return;
+
+			int32_t tx0 = int32_t(nTile % nTilesX) * nTileSize;
+			int32_t ty0 = int32_t(nTile / nTilesX) * nTileSize;
+			int32_t tx1 = std::min(tx0 + nTileSize, sprFramebuffer->width) - 1;
+			int32_t ty1 = std::min(ty0 + nTileSize, sprFramebuffer->height) - 1;
+
+			for (uint32_t i : bin)
+			{
+				const swPrimitive& prim = vPrimitives[i];
+				int32_t x0 = std::max(tx0, prim.x0), y0 = std::max(ty0, prim.y0);
+				int32_t x1 = std::min(tx1, prim.x1), y1 = std::min(ty1, prim.y1);
+
+				switch (prim.type)
+				{
+				case swType::CLEAR:
+					for (int32_t y = y0; y <= y1; y++)
+						olc::Span::Fill(sprFramebuffer->GetData() + y * sprFramebuffer->width + x0, prim.col, x1 - x0 + 1);
+					break;
+				case swType::TRIANGLE:
+					RasterizeTriangle(prim, x0, y0, x1, y1);
+					break;
+				case swType::LINE:
+					RasterizeLine(prim, x0, y0, x1, y1);
+					break;
+				}
+			}
+		}
+
+		void RasterizeTriangle(const swPrimitive& prim, int32_t cx0, int32_t cy0, int32_t cx1, int32_t cy1)
+		{
+			const swVertex& A = prim.v[0];
+			const swVertex& B = prim.v[1];
+			const swVertex& C = prim.v[2];
+
+			// Edge functions E(x, y) = ex * x + ey * y + ec, positive inside. They are
+			// evaluated exactly in 24.8 fixed point, as in floating point a pixel centre on
+			// an edge shared by two triangles can land outside both of them
+			auto snap = [](float f) { return int64_t(std::llround(std::max(-1048576.0f, std::min(1048576.0f, f)) * 256.0f)); };
+			const swVertex* ev[3][2] = { { &A, &B }, { &B, &C }, { &C, &A } };
+			int64_t ex[3], ey[3], ec[3];
+			bool bTopLeft[3];
+			for (int e = 0; e < 3; e++)
+			{
+				int64_t px = snap(ev[e][0]->x), py = snap(ev[e][0]->y);
+				int64_t qx = snap(ev[e][1]->x), qy = snap(ev[e][1]->y);
+				ex[e] = -(qy - py);
+				ey[e] = (qx - px);
+				ec[e] = -(ex[e] * px + ey[e] * py);
+				// Pixels exactly on an edge belong to the left or top triangle only
+				bTopLeft[e] = ex[e] > 0 || (ex[e] == 0 && ey[e] > 0);
+			}
+
+			// Attribute gradients across the screen
+			float dx1 = B.x - A.x, dy1 = B.y - A.y, dx2 = C.x - A.x, dy2 = C.y - A.y;
+			float fInvArea = 1.0f / (dx1 * dy2 - dy1 * dx2);
+			const float* pA = A.attr; const float* pB = B.attr; const float* pC = C.attr;
+			float dadx[7], dady[7];
+			for (int i = 0; i < 7; i++)
+			{
+				float d1 = pB[i] - pA[i], d2 = pC[i] - pA[i];
+				dadx[i] = (d1 * dy2 - d2 * dy1) * fInvArea;
+				dady[i] = (d2 * dx1 - d1 * dx2) * fInvArea;
+			}
+
+			olc::Pixel span[nTileSize];
+			for (int32_t y = cy0; y <= cy1; y++)
+			{
+				float py = float(y) + 0.5f;
+
+				// Find the run of pixel centres inside all three edges on this row
+				int32_t xl = cx0, xr = cx1;
+				for (int e = 0; e < 3 && xl <= xr; e++)
+				{
+					int64_t c = ey[e] * (int64_t(y) * 256 + 128) + ec[e];
+					auto inside = [&](int32_t x) { int64_t v = ex[e] * (int64_t(x) * 256 + 128) + c; return v > 0 || (v == 0 && bTopLeft[e]); };
+
+					if (ex[e] == 0)
+					{
+						if (!inside(xl)) xr = xl - 1;
+						continue;
+					}
+
+					// Estimate where the edge crosses the row, then settle it with exact tests
+					float fCross = float(-double(c) / double(ex[e]) / 256.0 - 0.5);
+					fCross = std::max(std::min(fCross, float(cx1 + 1)), float(cx0 - 1));
+					if (ex[e] > 0)
+					{
+						int32_t x = std::max(xl, int32_t(std::ceil(fCross)));
+						while (x > xl && inside(x - 1)) x--;
+						while (x <= xr && !inside(x)) x++;
+						xl = x;
+					}
+					else
+					{
+						int32_t x = std::min(xr, int32_t(std::floor(fCross)));
+						while (x < xr && inside(x + 1)) x++;
+						while (x >= xl && !inside(x)) x--;
+						xr = x;
+					}
+				}
+
+				if (xl > xr) continue;
+
+				float px = float(xl) + 0.5f;
+				float attr[7];
+				for (int i = 0; i < 7; i++)
+					attr[i] = pA[i] + dadx[i] * (px - A.x) + dady[i] * (py - A.y);
+
+				int32_t n = xr - xl + 1;
+				ShadeSpan(span, n, prim.tex, attr, dadx);
+				BlendSpan(sprFramebuffer->GetData() + y * sprFramebuffer->width + xl, span, n, prim.mode);
+			}
+		}
+
+		void RasterizeLine(const swPrimitive& prim, int32_t cx0, int32_t cy0, int32_t cx1, int32_t cy1)
+		{
+			const swVertex& A = prim.v[0];
+			const swVertex& B = prim.v[1];
+			int32_t nSteps = int32_t(std::ceil(std::max(std::abs(B.x - A.x), std::abs(B.y - A.y))));
+			if (nSteps <= 0) nSteps = 1;
+			const float* pA = A.attr; const float* pB = B.attr;
+			for (int32_t i = 0; i <= nSteps; i++)
+			{
+				float t = float(i) / float(nSteps);
+				int32_t x = int32_t(std::floor(A.x + (B.x - A.x) * t));
+				int32_t y = int32_t(std::floor(A.y + (B.y - A.y) * t));
+				if (x < cx0 || x > cx1 || y < cy0 || y > cy1) continue;
+
+				float attr[7], none[7] = { 0 };
+				for (int k = 0; k < 7; k++) attr[k] = pA[k] + (pB[k] - pA[k]) * t;
+				olc::Pixel p;
+				ShadeSpan(&p, 1, prim.tex, attr, none);
+				BlendSpan(sprFramebuffer->GetData() + y * sprFramebuffer->width + x, &p, 1, prim.mode);
+			}
+		}
+
+		static olc::Pixel Fetch(const swTexture* tex, int32_t x, int32_t y)
+		{
+			if (tex->bClamp)
+			{
+				x = std::max(0, std::min(x, tex->width - 1));
+				y = std::max(0, std::min(y, tex->height - 1));
+			}
+			else
+			{
+				x = ((x % tex->width) + tex->width) % tex->width;
+				y = ((y % tex->height) + tex->height) % tex->height;
+			}
+			return tex->data[y * tex->width + x];
+		}
+
+		static olc::Pixel Sample(const swTexture* tex, float u, float v)
+		{
+			// Keep wild coordinates inside integer range
+			u = std::max(std::min(u, 65536.0f), -65536.0f);
+			v = std::max(std::min(v, 65536.0f), -65536.0f);
+			if (!(u == u)) u = 0.0f;
+			if (!(v == v)) v = 0.0f;
+
+			float fx = u * float(tex->width);
+			float fy = v * float(tex->height);
+			if (!tex->bFiltered)
+				return Fetch(tex, int32_t(std::floor(fx)), int32_t(std::floor(fy)));
+
+			// Bilinear, between texel centres
+			fx -= 0.5f; fy -= 0.5f;
+			int32_t x = int32_t(std::floor(fx)), y = int32_t(std::floor(fy));
+			int32_t wx = int32_t((fx - float(x)) * 256.0f), wy = int32_t((fy - float(y)) * 256.0f);
+			olc::Pixel p00 = Fetch(tex, x, y), p10 = Fetch(tex, x + 1, y);
+			olc::Pixel p01 = Fetch(tex, x, y + 1), p11 = Fetch(tex, x + 1, y + 1);
+			auto lerp = [&](uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+			{
+				int32_t top = a * (256 - wx) + b * wx;
+				int32_t bot = c * (256 - wx) + d * wx;
+				return uint8_t((top * (256 - wy) + bot * wy) >> 16);
+			};
+			return olc::Pixel(lerp(p00.r, p10.r, p01.r, p11.r), lerp(p00.g, p10.g, p01.g, p11.g),
+				lerp(p00.b, p10.b, p01.b, p11.b), lerp(p00.a, p10.a, p01.a, p11.a));
+		}
+
+		// Produces source colours for a span: texture * tint, attributes are u v w r g b a
+		static void ShadeSpan(olc::Pixel* out, int32_t n, const swTexture* tex, float* attr, const float* dadx)
+		{
+			bool bFlatTint = dadx[3] == 0.0f && dadx[4] == 0.0f && dadx[5] == 0.0f && dadx[6] == 0.0f;
+			if (tex == nullptr && bFlatTint)
+			{
+				olc::Span::Fill(out, olc::Pixel(uint8_t(attr[3]), uint8_t(attr[4]), uint8_t(attr[5]), uint8_t(attr[6])), n);
+				return;
+			}
+
+			for (int32_t i = 0; i < n; i++)
+			{
+				olc::Pixel s = olc::WHITE;
+				if (tex != nullptr)
+				{
+					float iw = 1.0f / attr[2];
+					s = Sample(tex, attr[0] * iw, attr[1] * iw);
+				}
+				int32_t r = std::max(0, std::min(255, int32_t(attr[3] + 0.5f)));
+				int32_t g = std::max(0, std::min(255, int32_t(attr[4] + 0.5f)));
+				int32_t b = std::max(0, std::min(255, int32_t(attr[5] + 0.5f)));
+				int32_t a = std::max(0, std::min(255, int32_t(attr[6] + 0.5f)));
+				out[i] = olc::Pixel(Mul255(s.r, r), Mul255(s.g, g), Mul255(s.b, b), Mul255(s.a, a));
+				for (int k = 0; k < 7; k++) attr[k] += dadx[k];
+			}
+		}
+
+		static inline uint8_t Mul255(int32_t a, int32_t b)
+		{
+			int32_t t = a * b + 128;
+			return uint8_t((t + (t >> 8)) >> 8);
+		}
+
+#if defined(OLC_SIMD_SSE2)
+		// 16 bit lanes holding 0 - 255, (a * b) / 255 rounded
+		static inline __m128i Mul255x8(__m128i a, __m128i b)
+		{
+			__m128i t = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		}
+
+		static inline __m128i Blend2(__m128i s, __m128i d, olc::DecalMode mode)
+		{
+			__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			__m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+			switch (mode)
+			{
+			case olc::DecalMode::ADDITIVE: return _mm_add_epi16(Mul255x8(s, a), d);
+			case olc::DecalMode::MULTIPLICATIVE: return _mm_add_epi16(Mul255x8(s, d), Mul255x8(d, ia));
+			case olc::DecalMode::STENCIL: return Mul255x8(d, a);
+			case olc::DecalMode::ILLUMINATE: return _mm_add_epi16(Mul255x8(s, ia), Mul255x8(d, a));
+			default: return _mm_add_epi16(Mul255x8(s, a), Mul255x8(d, ia));
+			}
+		}
+#endif
+
+		// Blends a span of source colours onto the framebuffer, following the
+		// glBlendFunc() setup of the OpenGL renderers for each DecalMode
+		static void BlendSpan(olc::Pixel* dst, const olc::Pixel* src, int32_t n, olc::DecalMode mode)
+		{
+			int32_t i = 0;
+#if defined(OLC_SIMD_SSE2)
+			__m128i zero = _mm_setzero_si128();
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+				__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+				__m128i lo = Blend2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), mode);
+				__m128i hi = Blend2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), mode);
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+			}
+#endif
+			for (; i < n; i++)
+			{
+				const olc::Pixel s = src[i];
+				olc::Pixel& d = dst[i];
+				int32_t a = s.a, ia = 255 - s.a;
+				auto blend = [&](int32_t sc, int32_t dc) -> uint8_t
+				{
+					int32_t v;
+					switch (mode)
+					{
+					case olc::DecalMode::ADDITIVE: v = Mul255(sc, a) + dc; break;
+					case olc::DecalMode::MULTIPLICATIVE: v = Mul255(sc, dc) + Mul255(dc, ia); break;
+					case olc::DecalMode::STENCIL: v = Mul255(dc, a); break;
+					case olc::DecalMode::ILLUMINATE: v = Mul255(sc, ia) + Mul255(dc, a); break;
+					default: v = Mul255(sc, a) + Mul255(dc, ia); break;
+					}
+					return uint8_t(std::min(v, 255));
+				};
+				d = olc::Pixel(blend(s.r, d.r), blend(s.g, d.g), blend(s.b, d.b), blend(s.a, d.a));
+			}
+		}
+	};
+}
+#endif
+// O------------------------------------------------------------------------------O
+// | END RENDERER: Software                                                       |
+// O------------------------------------------------------------------------------O
+#pragma endregion
+
+#pragma region renderer_capture
+// O------------------------------------------------------------------------------O
+// | START RENDERER: Capture, records the renderer call stream to a file          |
+// O------------------------------------------------------------------------------O
+// Wraps the configured renderer. Every call is forwarded to it and also serialized
+// with its data (decal instances, retained lists, layer quads, texture uploads)
+// into a file, one chunk per displayed frame. olc::RenderReplay feeds a capture
+// back into whichever renderer the replaying program was built with, so renderer
+// changes can be timed on real frames without running the application.
+//
+// Enable with PixelGameEngine::EnableRenderCapture("frames.olccap") before Start()
+namespace olc
+{
+	enum class CaptureOp : uint8_t
+	{
+		PREPARE_DRAWING = 1, DISPLAY_FRAME, SET_DECAL_MODE, DRAW_LAYER_QUAD,
+		DRAW_DECAL, DRAW_DECAL_LIST, RELEASE_DECAL_LIST, CREATE_TEXTURE,
+		UPDATE_TEXTURE, UPDATE_TEXTURE_REGION, READ_TEXTURE, DELETE_TEXTURE,
+		APPLY_TEXTURE, UPDATE_VIEWPORT, CLEAR_BUFFER, UPDATE_TEXTURE_MIP_LEVELS,
+		BEGIN_SCALED_FRAME, END_SCALED_FRAME
+	};
+
+	// File: { magic, version, screen size, pixel size }, then per frame
+	// { uint32_t bytes, records... }, a record being { CaptureOp, payload }
+	static constexpr uint32_t nCaptureMagic = 0x50434C4F; // "OLCP"
+	static constexpr uint32_t nCaptureVersion = 3;
+	static constexpr uint32_t nCaptureNoTexture = 0xFFFFFFFF;
+
+	class Renderer_Capture : public olc::Renderer
+	{
+	public:
+		Renderer_Capture(std::unique_ptr<olc::Renderer> inner, std::ofstream&& file)
+			: pInner(std::move(inner)), ofs(std::move(file))
+		{}
+
+	private:
+		std::unique_ptr<olc::Renderer> pInner;
+		std::ofstream ofs;
+		bool bHeaderWritten = false;
+		// Records of the current frame, written out when it is displayed
+		std::vector<uint8_t> vFrame;
+		// Last revision of each retained list written, so contents are only stored on change
+		std::map<uint32_t, uint32_t> mapListRevision;
+
+		template<typename T> void Put(const T& v)
+		{
+			const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+			vFrame.insert(vFrame.end(), p, p + sizeof(T));
+		}
+
+		void Put(const olc::vf2d& v) { Put(v.x); Put(v.y); }
+		void Put(const olc::vi2d& v) { Put(v.x); Put(v.y); }
+		void Put(const olc::Pixel& p) { Put(p.n); }
+		void Put(const CaptureOp op) { Put(uint8_t(op)); }
+
+		void PutInstance(const olc::DecalInstance& decal)
+		{
+			Put(decal.decal != nullptr ? uint32_t(decal.decal->id) : nCaptureNoTexture);
+			Put(uint8_t(decal.mode));
+			Put(uint8_t(decal.structure));
+			Put(decal.points);
+			for (uint32_t i = 0; i < decal.points; i++)
+			{
+				Put(decal.pos[i]); Put(decal.uv[i]); Put(decal.w[i]); Put(decal.tint[i]);
+			}
+		}
+
+	public:
+		void PrepareDevice() override
+		{
+			pInner->PrepareDevice();
+		}
+
+		olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) override
+		{
+			return pInner->CreateDevice(params, bFullScreen, bVSYNC);
+		}
+
+		olc::rcode DestroyDevice() override
+		{
+			// Anything after the last displayed frame is teardown, not worth replaying
+			vFrame.clear();
+			ofs.flush();
+			return pInner->DestroyDevice();
+		}
+
+		void DisplayFrame() override
+		{
+			// Not every platform creates a device, so the header waits for the first frame
+			if (!bHeaderWritten)
+			{
+				const olc::vi2d vScreen = ptrPGE->GetScreenSize();
+				const olc::vi2d vPixel = ptrPGE->GetPixelSize();
+				uint32_t header[] = { nCaptureMagic, nCaptureVersion, uint32_t(vScreen.x), uint32_t(vScreen.y), uint32_t(vPixel.x), uint32_t(vPixel.y) };
+				ofs.write(reinterpret_cast<const char*>(header), sizeof(header));
+				bHeaderWritten = true;
+			}
+
+			Put(CaptureOp::DISPLAY_FRAME);
+			uint32_t nBytes = uint32_t(vFrame.size());
+			ofs.write(reinterpret_cast<const char*>(&nBytes), sizeof(nBytes));
+			ofs.write(reinterpret_cast<const char*>(vFrame.data()), vFrame.size());
+			vFrame.clear();
+			pInner->DisplayFrame();
+		}
+
+		void PrepareDrawing() override
+		{
+			Put(CaptureOp::PREPARE_DRAWING);
+			pInner->PrepareDrawing();
+		}
+
+		void SetDecalMode(const olc::DecalMode& mode) override
+		{
+			Put(CaptureOp::SET_DECAL_MODE); Put(uint8_t(mode));
+			pInner->SetDecalMode(mode);
+		}
+
+		void DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) override
+		{
+			Put(CaptureOp::DRAW_LAYER_QUAD); Put(offset); Put(scale); Put(tint);
+			pInner->DrawLayerQuad(offset, scale, tint);
+		}
+
+		void DrawDecal(const olc::DecalInstance& decal) override
+		{
+			Put(CaptureOp::DRAW_DECAL); PutInstance(decal);
+			pInner->DrawDecal(decal);
+		}
+
+		void DrawDecalList(const olc::DecalList& list, const olc::vf2d& offset, const olc::vf2d& scale) override
+		{
+			Put(CaptureOp::DRAW_DECAL_LIST); Put(list.nID); Put(offset); Put(scale);
+			auto it = mapListRevision.find(list.nID);
+			if (it == mapListRevision.end() || it->second != list.nRevision)
+			{
+				mapListRevision[list.nID] = list.nRevision;
+				Put(uint8_t(1)); Put(uint32_t(list.vecDecalInstance.size()));
+				for (const auto& decal : list.vecDecalInstance) PutInstance(decal);
+			}
+			else
+				Put(uint8_t(0));
+			pInner->DrawDecalList(list, offset, scale);
+		}
+
+		void ReleaseDecalList(const uint32_t id) override
+		{
+			Put(CaptureOp::RELEASE_DECAL_LIST); Put(id);
+			mapListRevision.erase(id);
+			pInner->ReleaseDecalList(id);
+		}
+
+		uint32_t CreateTexture(const uint32_t width, const uint32_t height, const bool filtered, const bool clamp) override
+		{
+			uint32_t id = pInner->CreateTexture(width, height, filtered, clamp);
+			Put(CaptureOp::CREATE_TEXTURE); Put(width); Put(height); Put(uint8_t(filtered)); Put(uint8_t(clamp)); Put(id);
+			return id;
+		}
+
+		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
+		{
+			Put(CaptureOp::UPDATE_TEXTURE); Put(id); Put(spr->width); Put(spr->height);
+			const uint8_t* p = reinterpret_cast<const uint8_t*>(spr->GetData());
+			vFrame.insert(vFrame.end(), p, p + size_t(spr->width) * size_t(spr->height) * sizeof(olc::Pixel));
+			pInner->UpdateTexture(id, spr);
+		}
+
+		void UpdateTextureMipLevels(uint32_t id, const std::vector<std::unique_ptr<olc::Sprite>>& vLevels) override
+		{
+			Put(CaptureOp::UPDATE_TEXTURE_MIP_LEVELS); Put(id); Put(uint32_t(vLevels.size()));
+			for (const auto& level : vLevels)
+			{
+				Put(level->width); Put(level->height);
+				const uint8_t* p = reinterpret_cast<const uint8_t*>(level->GetData());
+				vFrame.insert(vFrame.end(), p, p + size_t(level->width) * size_t(level->height) * sizeof(olc::Pixel));
+			}
+			pInner->UpdateTextureMipLevels(id, vLevels);
+		}
+
+		void UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			Put(CaptureOp::UPDATE_TEXTURE_REGION); Put(id); Put(spr->width); Put(spr->height); Put(pos); Put(size);
+			for (int32_t y = pos.y; y < pos.y + size.y; y++)
+			{
+				const uint8_t* p = reinterpret_cast<const uint8_t*>(spr->GetData() + size_t(y) * spr->width + pos.x);
+				vFrame.insert(vFrame.end(), p, p + size_t(size.x) * sizeof(olc::Pixel));
+			}
+			pInner->UpdateTextureRegion(id, spr, pos, size);
+		}
+
+		void ReadTexture(uint32_t id, olc::Sprite* spr) override
+		{
+			Put(CaptureOp::READ_TEXTURE); Put(id); Put(spr->width); Put(spr->height);
+			pInner->ReadTexture(id, spr);
+		}
+
+		uint32_t DeleteTexture(const uint32_t id) override
+		{
+			Put(CaptureOp::DELETE_TEXTURE); Put(id);
+			return pInner->DeleteTexture(id);
+		}
+
+		void ApplyTexture(uint32_t id) override
+		{
+			Put(CaptureOp::APPLY_TEXTURE); Put(id);
+			pInner->ApplyTexture(id);
+		}
+
+		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			Put(CaptureOp::UPDATE_VIEWPORT); Put(pos); Put(size);
+			pInner->UpdateViewport(pos, size);
+		}
+
+		void ClearBuffer(olc::Pixel p, bool bDepth) override
+		{
+			Put(CaptureOp::CLEAR_BUFFER); Put(p); Put(uint8_t(bDepth));
+			pInner->ClearBuffer(p, bDepth);
+		}
+
+		bool BeginScaledFrame(const olc::vi2d& vRenderSize) override
+		{
+			if (!pInner->BeginScaledFrame(vRenderSize)) return false;
+			Put(CaptureOp::BEGIN_SCALED_FRAME); Put(vRenderSize);
+			return true;
+		}
+
+		void EndScaledFrame() override
+		{
+			Put(CaptureOp::END_SCALED_FRAME);
+			pInner->EndScaledFrame();
+		}
+
+		olc::Sprite* GetFramebuffer() override
+		{
+			return pInner->GetFramebuffer();
+		}
+	};
+
+	olc::rcode PixelGameEngine::EnableRenderCapture(const std::string& sFile)
+	{
+		std::ofstream file(sFile, std::ios::out | std::ios::binary);
+		if (!file.is_open()) return olc::rcode::FAIL;
+		renderer = std::make_unique<olc::Renderer_Capture>(std::move(renderer), std::move(file));
+		return olc::rcode::OK;
+	}
+
+	// O------------------------------------------------------------------------------O
+	// | olc::RenderReplay - Plays a capture back through the current renderer        |
+	// O------------------------------------------------------------------------------O
+	// Textures and retained lists are recreated on the replaying renderer, and the
+	// captured ids are mapped onto the new ones. The first frame also carries the
+	// uploads of the captured application's OnUserCreate(), so timings usually skip it
+	class RenderReplay
+	{
+	public:
+		RenderReplay() = default;
+		~RenderReplay() { Clear(); }
+
+		olc::rcode Load(const std::string& sFile)
+		{
+			Clear();
+			vData.clear(); vFrames.clear();
+
+			std::ifstream ifs(sFile, std::ios::in | std::ios::binary);
+			if (!ifs.is_open()) return olc::rcode::NO_FILE;
+			vData.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+
+			uint32_t header[6];
+			if (vData.size() < sizeof(header)) return olc::rcode::FAIL;
+			std::memcpy(header, vData.data(), sizeof(header));
+			if (header[0] != nCaptureMagic || header[1] != nCaptureVersion) return olc::rcode::FAIL;
+			vScreenSize = { int32_t(header[2]), int32_t(header[3]) };
+			vPixelSize = { int32_t(header[4]), int32_t(header[5]) };
+
+			size_t p = sizeof(header);
+			while (p + sizeof(uint32_t) <= vData.size())
+			{
+				uint32_t nBytes;
+				std::memcpy(&nBytes, vData.data() + p, sizeof(nBytes));
+				p += sizeof(nBytes);
+				if (p + nBytes > vData.size()) break; // truncated capture, drop the partial frame
+				vFrames.push_back({ p, p + nBytes });
+				p += nBytes;
+			}
+			return olc::rcode::OK;
+		}
+
+		const olc::vi2d& GetScreenSize() const { return vScreenSize; }
+		const olc::vi2d& GetPixelSize() const { return vPixelSize; }
+		size_t FrameCount() const { return vFrames.size(); }
+
+		// Submits every renderer call of a captured frame, ending with DisplayFrame()
+		void PlayFrame(size_t nFrame)
+		{
+			if (nFrame >= vFrames.size()) return;
+			size_t p = vFrames[nFrame].first;
+			const size_t pEnd = vFrames[nFrame].second;
+			while (p < pEnd)
+			{
+				switch (CaptureOp(Get<uint8_t>(p)))
+				{
+				case CaptureOp::PREPARE_DRAWING:
+					renderer->PrepareDrawing();
+					break;
+
+				case CaptureOp::DISPLAY_FRAME:
+					renderer->DisplayFrame();
+					break;
+
+				case CaptureOp::SET_DECAL_MODE:
+					renderer->SetDecalMode(olc::DecalMode(Get<uint8_t>(p)));
+					break;
+
+				case CaptureOp::DRAW_LAYER_QUAD:
+				{
+					olc::vf2d offset = GetVf2d(p);
+					olc::vf2d scale = GetVf2d(p);
+					olc::Pixel tint = Get<uint32_t>(p);
+					renderer->DrawLayerQuad(offset, scale, tint);
+				}
+				break;
+
+				case CaptureOp::DRAW_DECAL:
+					GetInstance(p, diScratch);
+					renderer->DrawDecal(diScratch);
+					break;
+
+				case CaptureOp::DRAW_DECAL_LIST:
+				{
+					uint32_t nID = Get<uint32_t>(p);
+					olc::vf2d offset = GetVf2d(p);
+					olc::vf2d scale = GetVf2d(p);
+					if (Get<uint8_t>(p) != 0)
+					{
+						auto& list = mapLists[nID];
+						if (!list) list = std::make_unique<olc::DecalList>();
+						list->vecDecalInstance.resize(Get<uint32_t>(p));
+						for (auto& decal : list->vecDecalInstance) GetInstance(p, decal);
+						list->nRevision++;
+					}
+					auto it = mapLists.find(nID);
+					if (it != mapLists.end())
+						renderer->DrawDecalList(*it->second, offset, scale);
+				}
+				break;
+
+				case CaptureOp::RELEASE_DECAL_LIST:
+					mapLists.erase(Get<uint32_t>(p));
+					break;
+
+				case CaptureOp::CREATE_TEXTURE:
+				{
+					uint32_t w = Get<uint32_t>(p);
+					uint32_t h = Get<uint32_t>(p);
+					bool bFiltered = Get<uint8_t>(p) != 0;
+					bool bClamp = Get<uint8_t>(p) != 0;
+					uint32_t nCapturedID = Get<uint32_t>(p);
+					// Replaying the same frames again recreates their textures
+					mapTextures.erase(nCapturedID);
+					auto& tex = mapTextures[nCapturedID];
+					tex.sprite = std::make_unique<olc::Sprite>(w, h);
+					tex.decal = std::make_unique<olc::Decal>(renderer->CreateTexture(w, h, bFiltered, bClamp), tex.sprite.get());
+				}
+				break;
+
+				case CaptureOp::UPDATE_TEXTURE:
+				{
+					ReplayTexture* tex = GetTexture(p);
+					olc::vi2d size = GetVi2d(p);
+					const size_t nBytes = size_t(size.x) * size_t(size.y) * sizeof(olc::Pixel);
+					if (tex != nullptr)
+					{
+						Stage(*tex, size);
+						std::memcpy(tex->sprite->GetData(), vData.data() + p, nBytes);
+						renderer->UpdateTexture(tex->decal->id, tex->sprite.get());
+					}
+					p += nBytes;
+				}
+				break;
+
+				case CaptureOp::UPDATE_TEXTURE_MIP_LEVELS:
+				{
+					ReplayTexture* tex = GetTexture(p);
+					uint32_t nLevels = Get<uint32_t>(p);
+					std::vector<std::unique_ptr<olc::Sprite>> vLevels;
+					for (uint32_t i = 0; i < nLevels; i++)
+					{
+						olc::vi2d size = GetVi2d(p);
+						vLevels.push_back(std::make_unique<olc::Sprite>(size.x, size.y));
+						std::memcpy(vLevels.back()->GetData(), vData.data() + p, size_t(size.x) * size_t(size.y) * sizeof(olc::Pixel));
+						p += size_t(size.x) * size_t(size.y) * sizeof(olc::Pixel);
+					}
+					if (tex != nullptr)
+						renderer->UpdateTextureMipLevels(tex->decal->id, vLevels);
+				}
+				break;
+
+				case CaptureOp::UPDATE_TEXTURE_REGION:
+				{
+					ReplayTexture* tex = GetTexture(p);
+					olc::vi2d size = GetVi2d(p);
+					olc::vi2d region_pos = GetVi2d(p);
+					olc::vi2d region_size = GetVi2d(p);
+					const size_t nRowBytes = size_t(region_size.x) * sizeof(olc::Pixel);
+					if (tex != nullptr)
+					{
+						Stage(*tex, size);
+						for (int32_t y = 0; y < region_size.y; y++)
+							std::memcpy(tex->sprite->GetData() + size_t(region_pos.y + y) * size.x + region_pos.x,
+								vData.data() + p + nRowBytes * y, nRowBytes);
+						renderer->UpdateTextureRegion(tex->decal->id, tex->sprite.get(), region_pos, region_size);
+					}
+					p += nRowBytes * region_size.y;
+				}
+				break;
+
+				case CaptureOp::READ_TEXTURE:
+				{
+					ReplayTexture* tex = GetTexture(p);
+					olc::vi2d size = GetVi2d(p);
+					if (tex != nullptr)
+					{
+						Stage(*tex, size);
+						renderer->ReadTexture(tex->decal->id, tex->sprite.get());
+					}
+				}
+				break;
+
+				case CaptureOp::DELETE_TEXTURE:
+					// The decal owns the replayed texture, and deletes it
+					mapTextures.erase(Get<uint32_t>(p));
+					break;
+
+				case CaptureOp::APPLY_TEXTURE:
+				{
+					ReplayTexture* tex = GetTexture(p);
+					if (tex != nullptr) renderer->ApplyTexture(tex->decal->id);
+				}
+				break;
 
-		// UK Standard Layout
-#ifdef OLC_KEYBOARD_UK
-		vKeyboardMap =
-		{
-			{olc::Key::A, "a", "A"}, {olc::Key::B, "b", "B"}, {olc::Key::C, "c", "C"}, {olc::Key::D, "d", "D"}, {olc::Key::E, "e", "E"},
-			{olc::Key::F, "f", "F"}, {olc::Key::G, "g", "G"}, {olc::Key::H, "h", "H"}, {olc::Key::I, "i", "I"}, {olc::Key::J, "j", "J"},
-			{olc::Key::K, "k", "K"}, {olc::Key::L, "l", "L"}, {olc::Key::M, "m", "M"}, {olc::Key::N, "n", "N"}, {olc::Key::O, "o", "O"},
-			{olc::Key::P, "p", "P"}, {olc::Key::Q, "q", "Q"}, {olc::Key::R, "r", "R"}, {olc::Key::S, "s", "S"}, {olc::Key::T, "t", "T"},
-			{olc::Key::U, "u", "U"}, {olc::Key::V, "v", "V"}, {olc::Key::W, "w", "W"}, {olc::Key::X, "x", "X"}, {olc::Key::Y, "y", "Y"},
-			{olc::Key::Z, "z", "Z"},
+				case CaptureOp::UPDATE_VIEWPORT:
+				{
+					olc::vi2d pos = GetVi2d(p);
+					olc::vi2d size = GetVi2d(p);
+					renderer->UpdateViewport(pos, size);
+				}
+				break;
 
-			{olc::Key::K0, "0", ")"}, {olc::Key::K1, "1", "!"}, {olc::Key::K2, "2", "\""}, {olc::Key::K3, "3", "#"},	{olc::Key::K4, "4", "$"},
-			{olc::Key::K5, "5", "%"}, {olc::Key::K6, "6", "^"}, {olc::Key::K7, "7", "&"}, {olc::Key::K8, "8", "*"},	{olc::Key::K9, "9", "("},
+				case CaptureOp::CLEAR_BUFFER:
+				{
+					olc::Pixel col = Get<uint32_t>(p);
+					bool bDepth = Get<uint8_t>(p) != 0;
+					renderer->ClearBuffer(col, bDepth);
+				}
+				break;
 
-			{olc::Key::NP0, "0", "0"}, {olc::Key::NP1, "1", "1"}, {olc::Key::NP2, "2", "2"}, {olc::Key::NP3, "3", "3"},	{olc::Key::NP4, "4", "4"},
-			{olc::Key::NP5, "5", "5"}, {olc::Key::NP6, "6", "6"}, {olc::Key::NP7, "7", "7"}, {olc::Key::NP8, "8", "8"},	{olc::Key::NP9, "9", "9"},
-			{olc::Key::NP_MUL, "*", "*"}, {olc::Key::NP_DIV, "/", "/"}, {olc::Key::NP_ADD, "+", "+"}, {olc::Key::NP_SUB, "-", "-"},	{olc::Key::NP_DECIMAL, ".", "."},
+				case CaptureOp::BEGIN_SCALED_FRAME:
+					renderer->BeginScaledFrame(GetVi2d(p));
+					break;
 
-			{olc::Key::PERIOD, ".", ">"}, {olc::Key::EQUALS, "=", "+"}, {olc::Key::COMMA, ",", "<"}, {olc::Key::MINUS, "-", "_"}, {olc::Key::SPACE, " ", " "},
+				case CaptureOp::END_SCALED_FRAME:
+					renderer->EndScaledFrame();
+					break;
 
-			{olc::Key::OEM_1, ";", ":"}, {olc::Key::OEM_2, "/", "?"}, {olc::Key::OEM_3, "\'", "@"}, {olc::Key::OEM_4, "[", "{"},
-			{olc::Key::OEM_5, "\\", "|"}, {olc::Key::OEM_6, "]", "}"}, {olc::Key::OEM_7, "#", "~"}, 
-			
-			// {olc::Key::TAB, "\t", "\t"}
+				default:
+					// Unknown record, the rest of the frame cannot be decoded
+					return;
+				}
+			}
+		}
+
+		// Releases everything the replay created on the renderer
+		void Clear()
+		{
+			// Once the renderer is gone there is nothing left to delete the textures from
+			if (!renderer)
+				for (auto& tex : mapTextures) tex.second.decal->id = -1;
+			mapLists.clear();
+			mapTextures.clear();
+		}
+
+	private:
+		struct ReplayTexture
+		{
+			std::unique_ptr<olc::Sprite> sprite;
+			std::unique_ptr<olc::Decal> decal;
 		};
-#endif
-	}
 
-	void PixelGameEngine::pgex_Register(olc::PGEX* pgex)
-	{
-		if (std::find(vExtensions.begin(), vExtensions.end(), pgex) == vExtensions.end())
-			vExtensions.push_back(pgex);			
-	}
+		std::vector<uint8_t> vData;
+		std::vector<std::pair<size_t, size_t>> vFrames;
+		olc::vi2d vScreenSize = { 0, 0 };
+		olc::vi2d vPixelSize = { 1, 1 };
+		std::map<uint32_t, ReplayTexture> mapTextures;
+		std::map<uint32_t, std::unique_ptr<olc::DecalList>> mapLists;
+		olc::DecalInstance diScratch;
 
+		template<typename T> T Get(size_t& p)
+		{
+			T v;
+			std::memcpy(&v, vData.data() + p, sizeof(T));
+			p += sizeof(T);
+			return v;
+		}
 
-	PGEX::PGEX(bool bHook) { if(bHook) pge->pgex_Register(this); }
-	void PGEX::OnBeforeUserCreate() {}
-	void PGEX::OnAfterUserCreate()	{}
-	bool PGEX::OnBeforeUserUpdate(float& fElapsedTime) { return false; }
-	void PGEX::OnAfterUserUpdate(float fElapsedTime) {}
+		olc::vf2d GetVf2d(size_t& p) { float x = Get<float>(p); return { x, Get<float>(p) }; }
+		olc::vi2d GetVi2d(size_t& p) { int32_t x = Get<int32_t>(p); return { x, Get<int32_t>(p) }; }
 
-	// Need a couple of statics as these are singleton instances
-	// read from multiple locations
-	std::atomic<bool> PixelGameEngine::bAtomActive{ false };
-	olc::PixelGameEngine* olc::PGEX::pge = nullptr;
-	olc::PixelGameEngine* olc::Platform::ptrPGE = nullptr;
-	olc::PixelGameEngine* olc::Renderer::ptrPGE = nullptr;
-	std::unique_ptr<ImageLoader> olc::Sprite::loader = nullptr;
-};
-#pragma endregion 
+		ReplayTexture* GetTexture(size_t& p)
+		{
+			auto it = mapTextures.find(Get<uint32_t>(p));
+			return it != mapTextures.end() ? &it->second : nullptr;
+		}
 
+		// Keeps the staging sprite the size of what the capture uploaded
+		void Stage(ReplayTexture& tex, const olc::vi2d& size)
+		{
+			if (tex.sprite->width != size.x || tex.sprite->height != size.y)
+				tex.sprite = std::make_unique<olc::Sprite>(size.x, size.y);
+		}
 
-#pragma region platform_headless
-namespace olc
-{
-#if defined(OLC_GFX_HEADLESS)
-	class Renderer_Headless : public olc::Renderer
-	{
-	public:
-		virtual void       PrepareDevice() {};
-		virtual olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) { return olc::rcode::OK;		}
-		virtual olc::rcode DestroyDevice() { return olc::rcode::OK; }
-		virtual void       DisplayFrame() {}
-		virtual void       PrepareDrawing() {}
-		virtual void	   SetDecalMode(const olc::DecalMode& mode) {}
-		virtual void       DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) {}
-		virtual void       DrawDecal(const olc::DecalInstance& decal) {}
-		virtual uint32_t   CreateTexture(const uint32_t width, const uint32_t height, const bool filtered = false, const bool clamp = true) {return 1;};
-		virtual void       UpdateTexture(uint32_t id, olc::Sprite* spr) {}
-		virtual void       ReadTexture(uint32_t id, olc::Sprite* spr) {}
-		virtual uint32_t   DeleteTexture(const uint32_t id) {return 1;}
-		virtual void       ApplyTexture(uint32_t id) {}
-		virtual void       UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) {}
-		virtual void       ClearBuffer(olc::Pixel p, bool bDepth) {}
-	};
-#endif
-#if defined(OLC_PLATFORM_HEADLESS)
-	class Platform_Headless : public olc::Platform
-	{
-	public:
-		virtual olc::rcode ApplicationStartUp() { return olc::rcode::OK; }
-		virtual olc::rcode ApplicationCleanUp() { return olc::rcode::OK; }
-		virtual olc::rcode ThreadStartUp() { return olc::rcode::OK; }
-		virtual olc::rcode ThreadCleanUp() { return olc::rcode::OK; }
-		virtual olc::rcode CreateGraphics(bool bFullScreen, bool bEnableVSYNC, const olc::vi2d& vViewPos, const olc::vi2d& vViewSize) { return olc::rcode::OK; }
-		virtual olc::rcode CreateWindowPane(const olc::vi2d& vWindowPos, olc::vi2d& vWindowSize, bool bFullScreen) { return olc::rcode::OK; }
-		virtual olc::rcode SetWindowTitle(const std::string& s) { return olc::rcode::OK; }
-		virtual olc::rcode StartSystemEventLoop() { return olc::rcode::OK; }
-		virtual olc::rcode HandleSystemEvent() { return olc::rcode::OK; }
+		void GetInstance(size_t& p, olc::DecalInstance& decal)
+		{
+			uint32_t nTexture = Get<uint32_t>(p);
+			auto it = mapTextures.find(nTexture);
+			decal.decal = it != mapTextures.end() ? it->second.decal.get() : nullptr;
+			decal.mode = olc::DecalMode(Get<uint8_t>(p));
+			decal.structure = olc::DecalStructure(Get<uint8_t>(p));
+			decal.points = Get<uint32_t>(p);
+			decal.pos.resize(decal.points); decal.uv.resize(decal.points);
+			decal.w.resize(decal.points); decal.tint.resize(decal.points);
+			for (uint32_t i = 0; i < decal.points; i++)
+			{
+				decal.pos[i] = GetVf2d(p);
+				decal.uv[i] = GetVf2d(p);
+				decal.w[i] = Get<float>(p);
+				decal.tint[i] = Get<uint32_t>(p);
+			}
+		}
 	};
-#endif
 }
+// O------------------------------------------------------------------------------O
+// | END RENDERER: Capture                                                        |
+// O------------------------------------------------------------------------------O
 #pragma endregion
 
 // O------------------------------------------------------------------------------O
@@ -4219,7 +6733,14 @@ namespace olc
 
 		bool bSync = false;
 		olc::DecalMode nDecalMode = olc::DecalMode(-1); // Thanks Gusgo & Bispoo
+		// Dynamic resolution copies the scaled frame into a texture to stretch it
+		olc::vi2d vViewPos, vViewSize, vRenderSize;
+		uint32_t nScaledFrameTexture = 0;
+		olc::vi2d vScaledFrameTextureSize = { 0, 0 };
 		olc::DecalStructure nDecalStructure = olc::DecalStructure(-1);
+		// Retained decal lists are compiled into GL display lists, id -> { list, revision }
+		std::map<uint32_t, std::pair<GLuint, uint32_t>> mapDecalLists;
+		std::vector<GLuint> vReleasedDecalLists;
 #if defined(OLC_PLATFORM_X11)
 		X11::Display* olc_Display = nullptr;
 		X11::Window* olc_Window = nullptr;
@@ -4353,6 +6874,10 @@ namespace olc
 		{
 			
 			//ClearBuffer(olc::GREEN, true);
+			// Lists may be released from any thread, but GL objects die here
+			for (auto l : vReleasedDecalLists) glDeleteLists(l, 1);
+			vReleasedDecalLists.clear();
+
 			glEnable(GL_BLEND);
 			nDecalMode = DecalMode::NORMAL;
 			nDecalStructure = DecalStructure::FAN;
@@ -4482,6 +7007,46 @@ namespace olc
 			//glDisable(GL_DEPTH_TEST);
 		}
 
+		void DrawDecalList(const olc::DecalList& list, const olc::vf2d& offset, const olc::vf2d& scale) override
+		{
+			if (list.vecDecalInstance.empty()) return;
+
+			auto& cache = mapDecalLists[list.nID];
+			if (cache.first == 0 || cache.second != list.nRevision)
+			{
+				if (cache.first == 0) cache.first = glGenLists(1);
+
+				// The list will be called in any blend state, so make sure
+				// it sets its own rather than relying on what is cached now
+				nDecalMode = olc::DecalMode(-1);
+				glNewList(cache.first, GL_COMPILE);
+				for (const auto& decal : list.vecDecalInstance)
+					DrawDecal(decal);
+				glEndList();
+				cache.second = list.nRevision;
+			}
+
+			glMatrixMode(GL_MODELVIEW);
+			glPushMatrix();
+			glTranslatef(offset.x, offset.y, 0.0f);
+			glScalef(scale.x, scale.y, 1.0f);
+			glCallList(cache.first);
+			glPopMatrix();
+
+			// Calling the list left the blend state of its last decal
+			nDecalMode = list.vecDecalInstance.back().mode;
+		}
+
+		void ReleaseDecalList(const uint32_t id) override
+		{
+			auto it = mapDecalLists.find(id);
+			if (it != mapDecalLists.end())
+			{
+				vReleasedDecalLists.push_back(it->second.first);
+				mapDecalLists.erase(it);
+			}
+		}
+
 		uint32_t CreateTexture(const uint32_t width, const uint32_t height, const bool filtered, const bool clamp) override
 		{
 			UNUSED(width);
@@ -4527,6 +7092,29 @@ namespace olc
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
 		}
 
+		void UpdateTextureMipLevels(uint32_t id, const std::vector<std::unique_ptr<olc::Sprite>>& vLevels) override
+		{
+			UNUSED(id);
+			for (size_t i = 0; i < vLevels.size(); i++)
+				glTexImage2D(GL_TEXTURE_2D, GLint(i + 1), GL_RGBA, vLevels[i]->width, vLevels[i]->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, vLevels[i]->GetData());
+
+			// The magnification filter still says whether the texture was made filtered
+			GLint nFilter = GL_NEAREST;
+			glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, &nFilter);
+			if (vLevels.empty())
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, nFilter);
+			else
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, nFilter == GL_LINEAR ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST);
+		}
+
+		void UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			UNUSED(id);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, spr->width);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData() + pos.y * spr->width + pos.x);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		}
+
 		void ReadTexture(uint32_t id, olc::Sprite* spr) override
 		{
 			glReadPixels(0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
@@ -4547,6 +7135,36 @@ namespace olc
 		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override
 		{
 			glViewport(pos.x, pos.y, size.x, size.y);
+			vViewPos = pos;
+			vViewSize = size;
+		}
+
+		bool BeginScaledFrame(const olc::vi2d& vRenderSize) override
+		{
+			this->vRenderSize = vViewSize.min(vRenderSize);
+			glViewport(vViewPos.x, vViewPos.y, this->vRenderSize.x, this->vRenderSize.y);
+			return true;
+		}
+
+		void EndScaledFrame() override
+		{
+			if (nScaledFrameTexture == 0 || vScaledFrameTextureSize != vViewSize)
+			{
+				if (nScaledFrameTexture != 0) DeleteTexture(nScaledFrameTexture);
+				nScaledFrameTexture = CreateTexture(vViewSize.x, vViewSize.y, true, true);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, vViewSize.x, vViewSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+				vScaledFrameTextureSize = vViewSize;
+			}
+			else
+				ApplyTexture(nScaledFrameTexture);
+
+			// The copy is bottom up, so the quad samples it upside down
+			glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, vViewPos.x, vViewPos.y, vRenderSize.x, vRenderSize.y);
+			glViewport(vViewPos.x, vViewPos.y, vViewSize.x, vViewSize.y);
+			olc::vf2d vExtent = olc::vf2d(vRenderSize) / olc::vf2d(vViewSize);
+			glDisable(GL_BLEND);
+			DrawLayerQuad({ 0.0f, vExtent.y }, { vExtent.x, -vExtent.y }, olc::WHITE);
+			glEnable(GL_BLEND);
 		}
 	};
 }
@@ -4670,6 +7288,10 @@ namespace olc
 #endif
 		bool bSync = false;
 		olc::DecalMode nDecalMode = olc::DecalMode(-1); // Thanks Gusgo & Bispoo
+		// Dynamic resolution copies the scaled frame into a texture to stretch it
+		olc::vi2d vViewPos, vViewSize, vRenderSize;
+		uint32_t nScaledFrameTexture = 0;
+		olc::vi2d vScaledFrameTextureSize = { 0, 0 };
 #if defined(OLC_PLATFORM_X11)
 		X11::Display* olc_Display = nullptr;
 		X11::Window* olc_Window = nullptr;
@@ -4695,12 +7317,24 @@ namespace olc
 		locGenVertexArrays_t* locGenVertexArrays = nullptr;
 		locSwapInterval_t* locSwapInterval = nullptr;
 		locGetShaderInfoLog_t* locGetShaderInfoLog = nullptr;
+		locGetUniformLocation_t* locGetUniformLocation = nullptr;
+		locUniform2fv_t* locUniform2fv = nullptr;
+		locDeleteBuffers_t* locDeleteBuffers = nullptr;
+		locDeleteVertexArrays_t* locDeleteVertexArrays = nullptr;
+		locBufferSubData_t* locBufferSubData = nullptr;
+		locBufferStorage_t* locBufferStorage = nullptr;
+		locMapBufferRange_t* locMapBufferRange = nullptr;
+		locFenceSync_t* locFenceSync = nullptr;
+		locClientWaitSync_t* locClientWaitSync = nullptr;
+		locDeleteSync_t* locDeleteSync = nullptr;
 
 		uint32_t m_nFS = 0;
 		uint32_t m_nVS = 0;
 		uint32_t m_nQuadShader = 0;
 		uint32_t m_vbQuad = 0;
 		uint32_t m_vaQuad = 0;
+		int32_t m_nUniformOffset = -1;
+		int32_t m_nUniformScale = -1;
 
 		struct locVertex
 		{
@@ -4709,8 +7343,39 @@ namespace olc
 			olc::Pixel col;
 		};
 
+		// Retained decal lists live in their own static vertex buffers, drawn as
+		// a handful of batches with the list transform applied in the shader
+		struct locDecalListBatch
+		{
+			uint32_t first = 0;
+			uint32_t count = 0;
+			olc::Decal* decal = nullptr;
+			olc::DecalMode mode = olc::DecalMode::NORMAL;
+			olc::DecalStructure structure = olc::DecalStructure::FAN;
+		};
+
+		struct locDecalListCache
+		{
+			uint32_t nRevision = 0;
+			uint32_t vb = 0;
+			uint32_t va = 0;
+			std::vector<locDecalListBatch> vBatches;
+		};
+
+		std::map<uint32_t, locDecalListCache> mapDecalLists;
+		std::vector<locDecalListCache> vReleasedDecalLists;
+
 		locVertex pVertexMem[OLC_MAX_VERTS];
 
+		// m_vbQuad is a streaming ring of vertices, decals are appended to it rather
+		// than re-specifying the buffer per draw. It is split into segments which
+		// are fenced once full, so mapped writes never overtake the GPU
+		static constexpr uint32_t nRingSegments = 4;
+		static constexpr uint32_t nRingSegmentVerts = 8192;
+		locVertex* pRingMapped = nullptr; // Persistent mapping, else glBufferSubData is used
+		locGLsync pRingFence[nRingSegments] = { nullptr };
+		uint32_t nRingHead = 0;
+
 		olc::Renderable rendBlankQuad;
 
 	public:
@@ -4836,12 +7501,18 @@ namespace olc
 			locEnableVertexAttribArray = OGL_LOAD(locEnableVertexAttribArray_t, glEnableVertexAttribArray);
 			locUseProgram = OGL_LOAD(locUseProgram_t, glUseProgram);
 			locGetShaderInfoLog = OGL_LOAD(locGetShaderInfoLog_t, glGetShaderInfoLog);
+			locGetUniformLocation = OGL_LOAD(locGetUniformLocation_t, glGetUniformLocation);
+			locUniform2fv = OGL_LOAD(locUniform2fv_t, glUniform2fv);
+			locDeleteBuffers = OGL_LOAD(locDeleteBuffers_t, glDeleteBuffers);
+			locBufferSubData = OGL_LOAD(locBufferSubData_t, glBufferSubData);
 #if !defined(OLC_PLATFORM_EMSCRIPTEN)
 			locBindVertexArray = OGL_LOAD(locBindVertexArray_t, glBindVertexArray);
 			locGenVertexArrays = OGL_LOAD(locGenVertexArrays_t, glGenVertexArrays);
+			locDeleteVertexArrays = OGL_LOAD(locDeleteVertexArrays_t, glDeleteVertexArrays);
 #else
 			locBindVertexArray = glBindVertexArrayOES;
 			locGenVertexArrays = glGenVertexArraysOES;
+			locDeleteVertexArrays = glDeleteVertexArraysOES;
 #endif
 
 			// Load & Compile Quad Shader - assumes no errors
@@ -4868,7 +7539,8 @@ namespace olc
 #endif
 				"layout(location = 0) in vec3 aPos;\n""layout(location = 1) in vec2 aTex;\n"
 				"layout(location = 2) in vec4 aCol;\n""out vec2 oTex;\n""out vec4 oCol;\n"
-				"void main(){ float p = 1.0 / aPos.z; gl_Position = p * vec4(aPos.x, aPos.y, 0.0, 1.0); oTex = p * aTex; oCol = aCol;}";
+				"uniform vec2 uOffset;\n""uniform vec2 uScale;\n"
+				"void main(){ float p = 1.0 / aPos.z; gl_Position = p * vec4(aPos.xy * uScale + uOffset, 0.0, 1.0); oTex = p * aTex; oCol = aCol;}";
 			locShaderSource(m_nVS, 1, &strVS, NULL);
 			locCompileShader(m_nVS);
 
@@ -4876,6 +7548,25 @@ namespace olc
 			locAttachShader(m_nQuadShader, m_nFS);
 			locAttachShader(m_nQuadShader, m_nVS);
 			locLinkProgram(m_nQuadShader);
+			m_nUniformOffset = locGetUniformLocation(m_nQuadShader, "uOffset");
+			m_nUniformScale = locGetUniformLocation(m_nQuadShader, "uScale");
+
+			// Persistent mapping needs buffer storage (GL 4.4) and sync objects (GL 3.2)
+			bool bPersistent = false;
+#if !defined(OLC_PLATFORM_EMSCRIPTEN)
+			locBufferStorage = OGL_LOAD(locBufferStorage_t, glBufferStorage);
+			locMapBufferRange = OGL_LOAD(locMapBufferRange_t, glMapBufferRange);
+			locFenceSync = OGL_LOAD(locFenceSync_t, glFenceSync);
+			locClientWaitSync = OGL_LOAD(locClientWaitSync_t, glClientWaitSync);
+			locDeleteSync = OGL_LOAD(locDeleteSync_t, glDeleteSync);
+
+			const char* sVersion = (const char*)glGetString(GL_VERSION);
+			const char* sExtensions = (const char*)glGetString(GL_EXTENSIONS);
+			int nVersion = (sVersion != nullptr) ? (sVersion[0] - '0') * 10 + (sVersion[2] - '0') : 0;
+			bool bStorage = nVersion >= 44 || (sExtensions != nullptr && strstr(sExtensions, "GL_ARB_buffer_storage"));
+			bool bFences = nVersion >= 32 || (sExtensions != nullptr && strstr(sExtensions, "GL_ARB_sync"));
+			bPersistent = bStorage && bFences && locBufferStorage && locMapBufferRange && locFenceSync && locClientWaitSync && locDeleteSync;
+#endif
 
 			// Create Quad
 			locGenBuffers(1, &m_vbQuad);
@@ -4883,8 +7574,23 @@ namespace olc
 			locBindVertexArray(m_vaQuad);
 			locBindBuffer(0x8892, m_vbQuad);
 
-			locVertex verts[OLC_MAX_VERTS];
-			locBufferData(0x8892, sizeof(locVertex) * OLC_MAX_VERTS, verts, 0x88E0);
+			const GLsizeiptr nRingBytes = sizeof(locVertex) * nRingSegments * nRingSegmentVerts;
+			if (bPersistent)
+			{
+				// GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT
+				locBufferStorage(0x8892, nRingBytes, nullptr, 0x0002 | 0x0040 | 0x0080);
+				pRingMapped = (locVertex*)locMapBufferRange(0x8892, 0, nRingBytes, 0x0002 | 0x0040 | 0x0080);
+				if (pRingMapped == nullptr)
+				{
+					// Storage is immutable, so start again with a fresh buffer
+					locDeleteBuffers(1, &m_vbQuad);
+					locGenBuffers(1, &m_vbQuad);
+					locBindBuffer(0x8892, m_vbQuad);
+				}
+			}
+
+			if (pRingMapped == nullptr)
+				locBufferData(0x8892, nRingBytes, nullptr, 0x88E0);
 			locVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(locVertex), 0); locEnableVertexAttribArray(0);
 			locVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(locVertex), (void*)(3 * sizeof(float))); locEnableVertexAttribArray(1);
 			locVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(locVertex), (void*)(5 * sizeof(float)));	locEnableVertexAttribArray(2);
@@ -4947,10 +7653,19 @@ namespace olc
 
 		void PrepareDrawing() override
 		{
+			// Lists may be released at any time, but their GL objects die here
+			for (auto& cache : vReleasedDecalLists)
+			{
+				locDeleteBuffers(1, &cache.vb);
+				locDeleteVertexArrays(1, &cache.va);
+			}
+			vReleasedDecalLists.clear();
+
 			glEnable(GL_BLEND);
 			nDecalMode = DecalMode::NORMAL;
 			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 			locUseProgram(m_nQuadShader);
+			SetListTransform({ 0.0f, 0.0f }, { 1.0f, 1.0f });
 			locBindVertexArray(m_vaQuad);
 
 #if defined(OLC_PLATFORM_EMSCRIPTEN)
@@ -4960,6 +7675,43 @@ namespace olc
 #endif
 		}
 
+		// Appends vertices to the streaming ring (m_vbQuad must be bound),
+		// returning the index of the first one for glDrawArrays()
+		uint32_t StreamVertices(const locVertex* verts, const uint32_t count)
+		{
+			uint32_t nSegment = nRingHead / nRingSegmentVerts;
+			if ((nRingHead % nRingSegmentVerts) + count > nRingSegmentVerts)
+			{
+				uint32_t nNext = (nSegment + 1) % nRingSegments;
+				if (pRingMapped != nullptr)
+				{
+					// Fence the full segment, and wait until the GPU is done with the next
+					pRingFence[nSegment] = locFenceSync(0x9117, 0); // GL_SYNC_GPU_COMMANDS_COMPLETE
+					if (pRingFence[nNext] != nullptr)
+					{
+						// GL_SYNC_FLUSH_COMMANDS_BIT, 1ms timeout, until not GL_TIMEOUT_EXPIRED
+						while (locClientWaitSync(pRingFence[nNext], 0x00000001, 1000000) == 0x911B);
+						locDeleteSync(pRingFence[nNext]);
+						pRingFence[nNext] = nullptr;
+					}
+				}
+				else if (nNext == 0)
+				{
+					// Orphan the buffer once per lap, so sub-data writes need not wait
+					locBufferData(0x8892, sizeof(locVertex) * nRingSegments * nRingSegmentVerts, nullptr, 0x88E0);
+				}
+				nRingHead = nNext * nRingSegmentVerts;
+			}
+
+			uint32_t nFirst = nRingHead;
+			if (pRingMapped != nullptr)
+				std::copy(verts, verts + count, pRingMapped + nFirst);
+			else
+				locBufferSubData(0x8892, sizeof(locVertex) * nFirst, sizeof(locVertex) * count, verts);
+			nRingHead += count;
+			return nFirst;
+		}
+
 		void SetDecalMode(const olc::DecalMode& mode) override
 		{
 			if (mode != nDecalMode)
@@ -4988,8 +7740,8 @@ namespace olc
 				{{+1.0f, +1.0f, 1.0}, {1.0f * scale.x + offset.x, 0.0f * scale.y + offset.y}, tint},
 			};
 
-			locBufferData(0x8892, sizeof(locVertex) * 4, verts, 0x88E0);
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			uint32_t nFirst = StreamVertices(verts, 4);
+			glDrawArrays(GL_TRIANGLE_STRIP, nFirst, 4);
 		}
 
 		void DrawDecal(const olc::DecalInstance& decal) override
@@ -5005,18 +7757,112 @@ namespace olc
 			for (uint32_t i = 0; i < decal.points; i++)
 				pVertexMem[i] = { { decal.pos[i].x, decal.pos[i].y, decal.w[i] }, { decal.uv[i].x, decal.uv[i].y }, decal.tint[i] };
 
-			locBufferData(0x8892, sizeof(locVertex) * decal.points, pVertexMem, 0x88E0);
+			uint32_t nFirst = StreamVertices(pVertexMem, decal.points);
 
 			if (nDecalMode == DecalMode::WIREFRAME)
-				glDrawArrays(GL_LINE_LOOP, 0, decal.points);
+				glDrawArrays(GL_LINE_LOOP, nFirst, decal.points);
 			else
 			{
 				if (decal.structure == olc::DecalStructure::FAN)
-					glDrawArrays(GL_TRIANGLE_FAN, 0, decal.points);
+					glDrawArrays(GL_TRIANGLE_FAN, nFirst, decal.points);
 				else if (decal.structure == olc::DecalStructure::STRIP)
-					glDrawArrays(GL_TRIANGLE_STRIP, 0, decal.points);
+					glDrawArrays(GL_TRIANGLE_STRIP, nFirst, decal.points);
 				else if (decal.structure == olc::DecalStructure::LIST)
-					glDrawArrays(GL_TRIANGLES, 0, decal.points);
+					glDrawArrays(GL_TRIANGLES, nFirst, decal.points);
+			}
+		}
+
+		void SetListTransform(const olc::vf2d& offset, const olc::vf2d& scale)
+		{
+			float vOffset[2] = { offset.x, offset.y };
+			float vScale[2] = { scale.x, scale.y };
+			locUniform2fv(m_nUniformOffset, 1, vOffset);
+			locUniform2fv(m_nUniformScale, 1, vScale);
+		}
+
+		void DrawDecalList(const olc::DecalList& list, const olc::vf2d& offset, const olc::vf2d& scale) override
+		{
+			if (list.vecDecalInstance.empty()) return;
+
+			auto& cache = mapDecalLists[list.nID];
+			bool bNewBuffer = false;
+			if (cache.vb == 0)
+			{
+				locGenBuffers(1, &cache.vb);
+				locGenVertexArrays(1, &cache.va);
+				bNewBuffer = true;
+			}
+
+			locBindVertexArray(cache.va);
+			locBindBuffer(0x8892, cache.vb);
+
+			if (cache.nRevision != list.nRevision || bNewBuffer)
+			{
+				// Pack every instance into one static buffer, one batch per instance
+				std::vector<locVertex> vVerts;
+				cache.vBatches.clear();
+				for (const auto& decal : list.vecDecalInstance)
+				{
+					locDecalListBatch batch;
+					batch.first = uint32_t(vVerts.size());
+					batch.count = decal.points;
+					batch.decal = decal.decal;
+					batch.mode = decal.mode;
+					batch.structure = decal.structure;
+					for (uint32_t i = 0; i < decal.points; i++)
+						vVerts.push_back({ { decal.pos[i].x, decal.pos[i].y, decal.w[i] }, { decal.uv[i].x, decal.uv[i].y }, decal.tint[i] });
+					cache.vBatches.push_back(batch);
+				}
+
+				locBufferData(0x8892, sizeof(locVertex) * vVerts.size(), vVerts.data(), 0x88E4);
+				cache.nRevision = list.nRevision;
+			}
+
+#if !defined(OLC_PLATFORM_EMSCRIPTEN)
+			if (bNewBuffer)
+#endif
+			{
+				locVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(locVertex), 0); locEnableVertexAttribArray(0);
+				locVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(locVertex), (void*)(3 * sizeof(float))); locEnableVertexAttribArray(1);
+				locVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(locVertex), (void*)(5 * sizeof(float)));	locEnableVertexAttribArray(2);
+			}
+
+			SetListTransform(offset, scale);
+			for (const auto& batch : cache.vBatches)
+			{
+				SetDecalMode(batch.mode);
+				if (batch.decal == nullptr)
+					glBindTexture(GL_TEXTURE_2D, rendBlankQuad.Decal()->id);
+				else
+					glBindTexture(GL_TEXTURE_2D, batch.decal->id);
+
+				if (nDecalMode == DecalMode::WIREFRAME)
+					glDrawArrays(GL_LINE_LOOP, batch.first, batch.count);
+				else if (batch.structure == olc::DecalStructure::FAN)
+					glDrawArrays(GL_TRIANGLE_FAN, batch.first, batch.count);
+				else if (batch.structure == olc::DecalStructure::STRIP)
+					glDrawArrays(GL_TRIANGLE_STRIP, batch.first, batch.count);
+				else if (batch.structure == olc::DecalStructure::LIST)
+					glDrawArrays(GL_TRIANGLES, batch.first, batch.count);
+			}
+			SetListTransform({ 0.0f, 0.0f }, { 1.0f, 1.0f });
+
+			locBindVertexArray(m_vaQuad);
+#if defined(OLC_PLATFORM_EMSCRIPTEN)
+			locBindBuffer(0x8892, m_vbQuad);
+			locVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(locVertex), 0); locEnableVertexAttribArray(0);
+			locVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(locVertex), (void*)(3 * sizeof(float))); locEnableVertexAttribArray(1);
+			locVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(locVertex), (void*)(5 * sizeof(float)));	locEnableVertexAttribArray(2);
+#endif
+		}
+
+		void ReleaseDecalList(const uint32_t id) override
+		{
+			auto it = mapDecalLists.find(id);
+			if (it != mapDecalLists.end())
+			{
+				vReleasedDecalLists.push_back(it->second);
+				mapDecalLists.erase(it);
 			}
 		}
 
@@ -5067,6 +7913,39 @@ namespace olc
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
 		}
 
+		void UpdateTextureMipLevels(uint32_t id, const std::vector<std::unique_ptr<olc::Sprite>>& vLevels) override
+		{
+			UNUSED(id);
+#if defined(OLC_PLATFORM_EMSCRIPTEN)
+			// WebGL 1 only mipmaps power of two textures
+			auto isPow2 = [](int32_t n) { return (n & (n - 1)) == 0; };
+			if (!vLevels.empty() && !(isPow2(vLevels[0]->width * 2) && isPow2(vLevels[0]->height * 2))) return;
+#endif
+			for (size_t i = 0; i < vLevels.size(); i++)
+				glTexImage2D(GL_TEXTURE_2D, GLint(i + 1), GL_RGBA, vLevels[i]->width, vLevels[i]->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, vLevels[i]->GetData());
+
+			// The magnification filter still says whether the texture was made filtered
+			GLint nFilter = GL_NEAREST;
+			glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, &nFilter);
+			if (vLevels.empty())
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, nFilter);
+			else
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, nFilter == GL_LINEAR ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST);
+		}
+
+		void UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			UNUSED(id);
+#if defined(OLC_PLATFORM_EMSCRIPTEN)
+			// No GL_UNPACK_ROW_LENGTH in GLES2, so send whole rows
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, pos.y, spr->width, size.y, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData() + pos.y * spr->width);
+#else
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, spr->width);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData() + pos.y * spr->width + pos.x);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#endif
+		}
+
 		void ReadTexture(uint32_t id, olc::Sprite* spr) override
 		{
 			glReadPixels(0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
@@ -5087,6 +7966,36 @@ namespace olc
 		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override
 		{
 			glViewport(pos.x, pos.y, size.x, size.y);
+			vViewPos = pos;
+			vViewSize = size;
+		}
+
+		bool BeginScaledFrame(const olc::vi2d& vRenderSize) override
+		{
+			this->vRenderSize = vViewSize.min(vRenderSize);
+			glViewport(vViewPos.x, vViewPos.y, this->vRenderSize.x, this->vRenderSize.y);
+			return true;
+		}
+
+		void EndScaledFrame() override
+		{
+			if (nScaledFrameTexture == 0 || vScaledFrameTextureSize != vViewSize)
+			{
+				if (nScaledFrameTexture != 0) DeleteTexture(nScaledFrameTexture);
+				nScaledFrameTexture = CreateTexture(vViewSize.x, vViewSize.y, true, true);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, vViewSize.x, vViewSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+				vScaledFrameTextureSize = vViewSize;
+			}
+			else
+				ApplyTexture(nScaledFrameTexture);
+
+			// The copy is bottom up, so the quad samples it upside down
+			glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, vViewPos.x, vViewPos.y, vRenderSize.x, vRenderSize.y);
+			glViewport(vViewPos.x, vViewPos.y, vViewSize.x, vViewSize.y);
+			olc::vf2d vExtent = olc::vf2d(vRenderSize) / olc::vf2d(vViewSize);
+			glDisable(GL_BLEND);
+			DrawLayerQuad({ 0.0f, vExtent.y }, { vExtent.x, -vExtent.y }, olc::WHITE);
+			glEnable(GL_BLEND);
 		}
 	};
 }
@@ -5221,6 +8130,8 @@ namespace olc
 // O------------------------------------------------------------------------------O
 #pragma endregion
 
+#endif // Headless
+
 #pragma region image_libpng
 // O------------------------------------------------------------------------------O
 // | START IMAGE LOADER: libpng, default on linux, requires -lpng  (libpng-dev)   |
@@ -5335,6 +8246,29 @@ namespace olc
 
 		olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) override
 		{
+			FILE* f = fopen(sImageFile.c_str(), "wb");
+			if (!f) return olc::rcode::NO_FILE;
+
+			png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+			png_infop info = png ? png_create_info_struct(png) : nullptr;
+			if (!png || !info || setjmp(png_jmpbuf(png)))
+			{
+				png_destroy_write_struct(&png, &info);
+				fclose(f);
+				return olc::rcode::FAIL;
+			}
+
+			// olc::Pixel is laid out as RGBA bytes, so rows can be written directly
+			png_init_io(png, f);
+			png_set_IHDR(png, info, spr->width, spr->height, 8, PNG_COLOR_TYPE_RGBA,
+				PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+			png_write_info(png, info);
+			for (int y = 0; y < spr->height; y++)
+				png_write_row(png, (png_bytep)(spr->GetData() + y * spr->width));
+			png_write_end(png, nullptr);
+
+			png_destroy_write_struct(&png, &info);
+			fclose(f);
 			return olc::rcode::OK;
 		}
 	};
@@ -5346,6 +8280,8 @@ namespace olc
 #pragma endregion
 
 
+#if !defined(OLC_PGE_HEADLESS)
+
 // O------------------------------------------------------------------------------O
 // | olcPixelGameEngine Platforms                                                 |
 // O------------------------------------------------------------------------------O
@@ -6651,6 +9587,10 @@ namespace olc
 		renderer = std::make_unique<olc::Renderer_Headless>();
 #endif
 
+#if defined(OLC_GFX_SOFTWARE)
+		renderer = std::make_unique<olc::Renderer_Software>();
+#endif
+
 #if defined(OLC_GFX_OPENGL10)
 		renderer = std::make_unique<olc::Renderer_OGL10>();
 #endif
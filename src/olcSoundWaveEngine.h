@@ -161,7 +161,11 @@
 #include <cstring>
 #include <vector>
 #include <list>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
 #include <condition_variable>
 #include <mutex>
 #include <thread>
@@ -170,12 +174,14 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <filesystem>
+#include <type_traits>
 
 // Compiler/System Sensitivity
 #if !defined(SOUNDWAVE_USING_WINMM) && !defined(SOUNDWAVE_USING_WASAPI) &&  \
     !defined(SOUNDWAVE_USING_XAUDIO) && !defined(SOUNDWAVE_USING_OPENAL) && \
     !defined(SOUNDWAVE_USING_ALSA) && !defined(SOUNDWAVE_USING_SDLMIXER) && \
-    !defined(SOUNDWAVE_USING_PULSE)                                         \
+    !defined(SOUNDWAVE_USING_PULSE) && !defined(SOUNDWAVE_USING_NULL)       \
 
 	#if defined(_WIN32)
 		#define SOUNDWAVE_USING_WINMM
@@ -192,11 +198,258 @@
 
 #endif
 
+// Mixing kernels use the widest instruction set the compiler targets,
+// define SOUNDWAVE_SIMD_NONE to force the scalar ones
+#if !defined(SOUNDWAVE_SIMD_NONE)
+	#if defined(__AVX2__)
+		#include <immintrin.h>
+		#define SOUNDWAVE_SIMD_AVX2
+	#endif
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+		#define SOUNDWAVE_SIMD_SSE2
+	#endif
+#endif
+
 namespace olc::sound
 {
 
 	namespace wave
 	{
+	// Writes the 44 byte header of a WAV file holding nSamples samples of nChannels channels,
+	// PCM with nSampleSize bytes per sample, or IEEE float if bFloat
+	inline void WriteHeader(std::ostream& os, const size_t nChannels, const size_t nSampleRate, const size_t nSampleSize, const size_t nSamples, const bool bFloat)
+	{
+		auto write16 = [&](uint16_t n) { os.write((const char*)&n, sizeof(n)); };
+		auto write32 = [&](uint32_t n) { os.write((const char*)&n, sizeof(n)); };
+
+		uint32_t nDataBytes = uint32_t(nSamples * nChannels * nSampleSize);
+		os.write("RIFF", 4);
+		write32(36 + nDataBytes);
+		os.write("WAVE", 4);
+		os.write("fmt ", 4);
+		write32(16);
+		write16(bFloat ? 3 : 1);
+		write16(uint16_t(nChannels));
+		write32(uint32_t(nSampleRate));
+		write32(uint32_t(nSampleRate * nChannels * nSampleSize));
+		write16(uint16_t(nChannels * nSampleSize));
+		write16(uint16_t(nSampleSize * 8));
+		os.write("data", 4);
+		write32(nDataBytes);
+	}
+
+	// How a WAV file's samples are stored
+	struct Format
+	{
+		size_t nChannels = 0;
+		size_t nSampleRate = 0;
+		size_t nSampleSize = 0;		// Bytes per sample of one channel
+		bool bFloat = false;		// IEEE float rather than PCM
+		bool bAdpcm = false;		// IMA ADPCM, 4 bits a sample in blocks, nSampleSize is 0
+		size_t nBlockAlign = 0;		// Bytes per frame, or per block if bAdpcm
+		size_t nFramesPerBlock = 0;	// If bAdpcm
+		size_t nFrames = 0;			// If bAdpcm and the file says, otherwise worked out from nDataBytes
+		size_t nDataBytes = 0;
+	};
+
+	// IMA ADPCM. Each sample is stored as a 4 bit step from the one before, sized by how
+	// big the last few steps were. Samples are stored in blocks which each start with a
+	// sample in full, so any block can be decoded without the ones before it. Blocks are
+	// laid out as in WAV files: for each channel the first sample and step index, then
+	// the channels take turns with 8 samples (4 bytes) at a time
+	namespace adpcm
+	{
+		// Most samples (frames times channels) in a block, and channels, of a wave that will
+		// be played without decoding the whole of it first
+		constexpr size_t nMaxBlockSamples = 16384;
+		constexpr size_t nMaxChannels = 8;
+
+		// A channel's decoder at some frame of a block. The predictor is that frame's sample
+		struct State
+		{
+			int32_t nPredictor = 0;
+			int32_t nIndex = 0;
+		};
+
+		constexpr size_t FramesPerBlock(const size_t nBlockAlign, const size_t nChannels)
+		{
+			return (nBlockAlign / nChannels - 4) * 2 + 1;
+		}
+
+		// Decodes the first nFrames frames of a block into interleaved samples
+		void DecodeBlock(const uint8_t* pBlock, const size_t nChannels, const size_t nFrames, float* pOutput);
+		// Sets each channel's state to the first frame of a block
+		void StartBlock(const uint8_t* pBlock, const size_t nChannels, State* pState);
+		// Decodes on from frame nFrame, where the states are, to frame nTo, and leaves them there.
+		// Frames from nOut on are written to pOutput as interleaved samples, frame nOut first
+		void DecodeFrames(const uint8_t* pBlock, const size_t nChannels, State* pState, const size_t nFrame, const size_t nTo, const size_t nOut, float* pOutput);
+		// Encodes nFrames interleaved frames, padded out to nFramesPerBlock, into a block.
+		// pIndex holds a step index for each channel, which carries on to the next block
+		void EncodeBlock(const float* pInput, const size_t nChannels, const size_t nFrames, const size_t nFramesPerBlock, int32_t* pIndex, uint8_t* pBlock);
+	}
+
+	// Reads a WAV file's header, leaving the stream at the start of its samples
+	inline bool ReadHeader(std::istream& is, Format& format)
+	{
+		struct WaveFormatHeader
+		{
+			uint16_t wFormatTag;         /* format type */
+			uint16_t nChannels;          /* number of channels (i.e. mono, stereo...) */
+			uint32_t nSamplesPerSec;     /* sample rate */
+			uint32_t nAvgBytesPerSec;    /* for buffer estimation */
+			uint16_t nBlockAlign;        /* block size of data */
+			uint16_t wBitsPerSample;     /* number of bits per sample of mono data */
+		};
+
+		WaveFormatHeader header{};
+
+		char dump[4];
+		is.read(dump, sizeof(uint8_t) * 4); // Read "RIFF"
+		if (strncmp(dump, "RIFF", 4) != 0) return false;
+
+		is.read(dump, sizeof(uint8_t) * 4); // Not Interested
+		is.read(dump, sizeof(uint8_t) * 4); // Read "WAVE"
+		if (strncmp(dump, "WAVE", 4) != 0) return false;
+
+		// Read Wave description chunk, and the samples per block from its extension
+		// if there is one, skipping the rest
+		uint32_t nFormatSize = 0;
+		uint16_t nExtension[2] = { 0, 0 };
+		is.read(dump, sizeof(uint8_t) * 4); // Read "fmt "
+		is.read((char*)&nFormatSize, sizeof(uint32_t));
+		is.read((char*)&header, sizeof(WaveFormatHeader)); // Read Wave Format Structure chunk
+		if (nFormatSize >= sizeof(WaveFormatHeader) + sizeof(nExtension))
+		{
+			is.read((char*)nExtension, sizeof(nExtension));
+			nFormatSize -= sizeof(nExtension);
+		}
+		if (nFormatSize > sizeof(WaveFormatHeader))
+			is.seekg(nFormatSize - sizeof(WaveFormatHeader), std::ios::cur);
+
+		// Search for audio data chunk
+		uint32_t nChunksize = 0;
+		uint32_t nFrames = 0;
+		is.read(dump, sizeof(uint8_t) * 4); // Read chunk header
+		is.read((char*)&nChunksize, sizeof(uint32_t)); // Read chunk size
+
+		while (is.good() && strncmp(dump, "data", 4) != 0)
+		{
+			// Compressed files say how many frames they hold
+			if (strncmp(dump, "fact", 4) == 0 && nChunksize >= sizeof(uint32_t))
+			{
+				is.read((char*)&nFrames, sizeof(uint32_t));
+				nChunksize -= sizeof(uint32_t);
+			}
+
+			// Not audio data, so just skip it
+			is.seekg(nChunksize, std::ios::cur);
+			is.read(dump, sizeof(uint8_t) * 4); // Read next chunk header
+			is.read((char*)&nChunksize, sizeof(uint32_t)); // Read next chunk size
+		}
+
+		format.nChannels = header.nChannels;
+		format.nSampleRate = header.nSamplesPerSec;
+		format.nSampleSize = header.wBitsPerSample >> 3;
+		format.bFloat = header.wFormatTag == 3;
+		format.bAdpcm = header.wFormatTag == 0x11;
+		format.nBlockAlign = header.nBlockAlign;
+		format.nDataBytes = nChunksize;
+		if (!is.good() || format.nChannels == 0)
+			return false;
+
+		if (format.bAdpcm)
+		{
+			if (header.wBitsPerSample != 4 || format.nBlockAlign <= 4 * format.nChannels)
+				return false;
+			format.nSampleSize = 0;
+			format.nFramesPerBlock = adpcm::FramesPerBlock(format.nBlockAlign, format.nChannels);
+			if (nExtension[0] >= sizeof(uint16_t) && nExtension[1] > 0)
+				format.nFramesPerBlock = std::min(format.nFramesPerBlock, size_t(nExtension[1]));
+			size_t nBlocks = (format.nDataBytes + format.nBlockAlign - 1) / format.nBlockAlign;
+			format.nFrames = (nFrames > 0) ? std::min(size_t(nFrames), nBlocks * format.nFramesPerBlock) : nBlocks * format.nFramesPerBlock;
+			return true;
+		}
+
+		format.nFrames = format.nDataBytes / std::max(format.nChannels * format.nSampleSize, size_t(1));
+		return format.nSampleSize >= 1 && format.nSampleSize <= 4;
+	}
+
+	// Converts nSamples samples stored as format describes to normalised values
+	template<class T>
+	void ConvertSamples(const char* pRaw, const size_t nSamples, const Format& format, T* pSample)
+	{
+		for (size_t i = 0; i < nSamples; i++, pRaw += format.nSampleSize)
+		{
+			switch (format.nSampleSize)
+			{
+			case 1:
+			{
+				int8_t s = 0;
+				std::memcpy(&s, pRaw, sizeof(int8_t));
+				pSample[i] = T(s) / T(std::numeric_limits<int8_t>::max());
+			}
+			break;
+
+			case 2:
+			{
+				int16_t s = 0;
+				std::memcpy(&s, pRaw, sizeof(int16_t));
+				pSample[i] = T(s) / T(std::numeric_limits<int16_t>::max());
+			}
+			break;
+
+			case 3: // 24-bit
+			{
+				int32_t s = 0;
+				std::memcpy(&s, pRaw, 3);
+				if (s & (1 << 23)) s |= 0xFF000000;
+				pSample[i] = T(s) / T(std::pow(2, 23)-1);
+			}
+			break;
+
+			case 4:
+			{
+				if (format.bFloat)
+				{
+					float s = 0.0f;
+					std::memcpy(&s, pRaw, sizeof(float));
+					pSample[i] = T(s);
+				}
+				else
+				{
+					int32_t s = 0;
+					std::memcpy(&s, pRaw, sizeof(int32_t));
+					pSample[i] = T(s) / T(std::numeric_limits<int32_t>::max());
+				}
+			}
+			break;
+			}
+		}
+	}
+
+	// A whole file mapped into memory. Pages are shared with anyone else mapping
+	// the file, and are only copied if written to
+	class Mapping
+	{
+	public:
+		Mapping() = default;
+		~Mapping();
+		Mapping(const Mapping&) = delete;
+		Mapping& operator=(const Mapping&) = delete;
+
+	public:
+		bool Open(const std::string& sFilename);
+		void Close();
+
+		char* data() const { return m_pData; }
+		size_t size() const { return m_nSize; }
+
+	private:
+		char* m_pData = nullptr;
+		size_t m_nSize = 0;
+	};
+
 	// Physically represents a .WAV file, but the data is stored
 	// as normalised floating point values
 	template<class T = float>
@@ -215,12 +468,13 @@ namespace olc::sound
 			m_dDurationInSamples = double(m_nSamples);
 
 			m_pRawData = std::make_unique<T[]>(m_nSamples * m_nChannels);
+			m_pData = m_pRawData.get();
 		}
 
 	public:
 		T* data() const
 		{
-			return m_pRawData.get();
+			return m_pData;
 		}
 
 		size_t samples() const
@@ -259,112 +513,189 @@ namespace olc::sound
 			if (!ifs.is_open())
 				return false;
 
-			struct WaveFormatHeader
-			{
-				uint16_t wFormatTag;         /* format type */
-				uint16_t nChannels;          /* number of channels (i.e. mono, stereo...) */
-				uint32_t nSamplesPerSec;     /* sample rate */
-				uint32_t nAvgBytesPerSec;    /* for buffer estimation */
-				uint16_t nBlockAlign;        /* block size of data */
-				uint16_t wBitsPerSample;     /* number of bits per sample of mono data */
-			};
-
-			WaveFormatHeader header{ 0 };
-
 			m_pRawData.reset();
+			m_pMapping.reset();
+			m_pData = nullptr;
 
-			char dump[4];
-			ifs.read(dump, sizeof(uint8_t) * 4); // Read "RIFF"
-			if (strncmp(dump, "RIFF", 4) != 0) return false;
-
-			ifs.read(dump, sizeof(uint8_t) * 4); // Not Interested
-			ifs.read(dump, sizeof(uint8_t) * 4); // Read "WAVE"
-			if (strncmp(dump, "WAVE", 4) != 0) return false;
-
-			// Read Wave description chunk
-			ifs.read(dump, sizeof(uint8_t) * 4); // Read "fmt "
-			ifs.read(dump, sizeof(uint8_t) * 4); // Not Interested
-			ifs.read((char*)&header, sizeof(WaveFormatHeader)); // Read Wave Format Structure chunk
-
-			// Search for audio data chunk
-			int32_t nChunksize = 0;
-			ifs.read(dump, sizeof(uint8_t) * 4); // Read chunk header
-			ifs.read((char*)&nChunksize, sizeof(uint32_t)); // Read chunk size
-
-			while (strncmp(dump, "data", 4) != 0)
-			{
-				// Not audio data, so just skip it
-				ifs.seekg(nChunksize, std::ios::cur);
-				ifs.read(dump, sizeof(uint8_t) * 4); // Read next chunk header
-				ifs.read((char*)&nChunksize, sizeof(uint32_t)); // Read next chunk size
-			}
+			Format format;
+			if (!ReadHeader(ifs, format))
+				return false;
 
 			// Finally got to data, so read it all in and convert to float samples
-			m_nSampleSize = header.wBitsPerSample >> 3;
-			m_nSamples = nChunksize / (header.nChannels * m_nSampleSize);
-			m_nChannels = header.nChannels;
-			m_nSampleRate = header.nSamplesPerSec;
+			m_nSampleSize = format.bAdpcm ? 2 : format.nSampleSize;
+			m_nSamples = format.nFrames;
+			m_nChannels = format.nChannels;
+			m_nSampleRate = format.nSampleRate;
 			m_pRawData = std::make_unique<T[]>(m_nSamples * m_nChannels);			
+			m_pData = m_pRawData.get();
 			m_dDuration =  double(m_nSamples) / double(m_nSampleRate);
 			m_dDurationInSamples = double(m_nSamples);
 
-			T* pSample = m_pRawData.get();
+			if (format.bAdpcm)
+			{
+				// Decoded a block at a time
+				std::vector<char> vBlock(format.nBlockAlign);
+				std::vector<float> vDecoded(format.nFramesPerBlock * m_nChannels);
+				for (size_t nFrame = 0; nFrame < m_nSamples; nFrame += format.nFramesPerBlock)
+				{
+					size_t nCount = std::min(format.nFramesPerBlock, m_nSamples - nFrame);
+					ifs.read(vBlock.data(), vBlock.size());
+					std::fill(vBlock.begin() + ifs.gcount(), vBlock.end(), 0);
+					adpcm::DecodeBlock((const uint8_t*)vBlock.data(), m_nChannels, nCount, vDecoded.data());
+					std::copy(vDecoded.begin(), vDecoded.begin() + nCount * m_nChannels, m_pData + nFrame * m_nChannels);
+				}
+				return true;
+			}
+
+			// Read in audio data and normalise, a chunk at a time
+			std::vector<char> vRaw(65536 - 65536 % (m_nSampleSize * m_nChannels));
+			size_t nRead = 0;
+			while (nRead < m_nSamples * m_nChannels)
+			{
+				size_t nCount = std::min(vRaw.size() / m_nSampleSize, m_nSamples * m_nChannels - nRead);
+				ifs.read(vRaw.data(), nCount * m_nSampleSize);
+				// A truncated file reads as silence
+				std::fill(vRaw.begin() + ifs.gcount(), vRaw.begin() + nCount * m_nSampleSize, 0);
+				ConvertSamples(vRaw.data(), nCount, format, m_pRawData.get() + nRead);
+				nRead += nCount;
+			}
+			return true;
+		}
 
-			// Read in audio data and normalise
-			for (long i = 0; i < m_nSamples; i++)
+		// Maps a float32 file into memory instead of reading it, and uses its samples where
+		// they lie. Other formats are converted once into a float32 copy beside the file,
+		// sFilename + ".f32", which is mapped instead, and made again if the file is newer.
+		// The samples may be written to, but the changes stay in this process
+		bool MapFile(const std::string& sFilename)
+		{
+			if constexpr (!std::is_same_v<T, float>)
+				return LoadFile(sFilename);
+			else
 			{
-				for (int c = 0; c < m_nChannels; c++)
+				if (MapFloatFile(sFilename))
+					return true;
+
+				std::error_code ec;
+				const std::string sCache = sFilename + ".f32";
+				auto tSource = std::filesystem::last_write_time(sFilename, ec);
+				if (ec)
+					return false;
+				auto tCache = std::filesystem::last_write_time(sCache, ec);
+				if (!ec && tCache >= tSource && MapFloatFile(sCache))
+					return true;
+
+				if (!LoadFile(sFilename))
+					return false;
+
+				// Written aside and renamed, so a half written cache is never mapped
+				const std::string sTemp = sCache + ".tmp";
 				{
-					switch (m_nSampleSize)
+					std::ofstream ofs(sTemp, std::ios::binary);
+					WriteHeader(ofs, m_nChannels, m_nSampleRate, sizeof(float), m_nSamples, true);
+					ofs.write((const char*)m_pData, m_nSamples * m_nChannels * sizeof(float));
+					if (!ofs.good())
 					{
-					case 1:
-					{
-						int8_t s = 0;
-						ifs.read((char*)&s, sizeof(int8_t));
-						*pSample = T(s) / T(std::numeric_limits<int8_t>::max());
+						ofs.close();
+						std::filesystem::remove(sTemp, ec);
+						return true;
 					}
-					break;
+				}
+				std::filesystem::rename(sTemp, sCache, ec);
 
-					case 2:
-					{
-						int16_t s = 0;
-						ifs.read((char*)&s, sizeof(int16_t));
-						*pSample = T(s) / T(std::numeric_limits<int16_t>::max());
-					}
-					break;
+				// If the cache cannot be used, the samples just loaded will do
+				File<T> cache;
+				if (!ec && cache.MapFloatFile(sCache))
+					*this = std::move(cache);
+				return true;
+			}
+		}
 
-					case 3: // 24-bit
-					{
-						int32_t s = 0;
-						ifs.read((char*)&s, 3);
-						if (s & (1 << 23)) s |= 0xFF000000;
-						*pSample = T(s) / T(std::pow(2, 23)-1);
-					}
-					break;
+		// Whether the samples are those of a mapped file
+		bool mapped() const
+		{
+			return m_pMapping != nullptr;
+		}
 
-					case 4:
-					{
-						int32_t s = 0;
-						ifs.read((char*)&s, sizeof(int32_t));
-						*pSample = T(s) / T(std::numeric_limits<int32_t>::max());
-					}
-					break;
-					}
+		// Saves as PCM of the sample size the file was loaded or made with, scaled as
+		// LoadFile() reads it. 8 bit files are saved as 16 bit
+		bool SaveFile(const std::string& sFilename)
+		{
+			if (m_pData == nullptr)
+				return false;
+
+			std::ofstream ofs(sFilename, std::ios::binary);
+			if (!ofs.is_open())
+				return false;
+
+			const size_t nSampleSize = (m_nSampleSize >= 2 && m_nSampleSize <= 4) ? m_nSampleSize : 2;
+			WriteHeader(ofs, m_nChannels, m_nSampleRate, nSampleSize, m_nSamples, false);
+
+			const T* pSample = m_pData;
+			for (size_t i = 0; i < m_nSamples * m_nChannels; i++)
+			{
+				double d = std::clamp(double(pSample[i]), -1.0, 1.0);
+				switch (nSampleSize)
+				{
+				case 2:
+				{
+					int16_t s = int16_t(std::round(d * std::numeric_limits<int16_t>::max()));
+					ofs.write((const char*)&s, sizeof(int16_t));
+				}
+				break;
+
+				case 3: // 24-bit
+				{
+					int32_t s = int32_t(std::round(d * (std::pow(2, 23) - 1)));
+					ofs.write((const char*)&s, 3);
+				}
+				break;
 
-					pSample++;
+				case 4:
+				{
+					int32_t s = int32_t(std::round(d * std::numeric_limits<int32_t>::max()));
+					ofs.write((const char*)&s, sizeof(int32_t));
+				}
+				break;
 				}
 			}
-			return true;
+			return ofs.good();
 		}
 
-		bool SaveFile(const std::string& sFilename)
+
+	private:
+		// Maps sFilename if its samples are float32, stored where floats can be read
+		bool MapFloatFile(const std::string& sFilename)
 		{
-			return false;
-		}
+			std::ifstream ifs(sFilename, std::ios::binary);
+			Format format;
+			if (!ifs.is_open() || !ReadHeader(ifs, format) || !format.bFloat || format.nSampleSize != sizeof(float))
+				return false;
+			size_t nOffset = size_t(ifs.tellg());
+			ifs.close();
+
+			auto pMapping = std::make_unique<Mapping>();
+			if (nOffset % alignof(float) != 0 || !pMapping->Open(sFilename) || nOffset > pMapping->size())
+				return false;
+
+			// Only as many samples as the file really holds
+			m_nChannels = format.nChannels;
+			m_nSampleSize = sizeof(float);
+			m_nSampleRate = format.nSampleRate;
+			m_nSamples = std::min(format.nDataBytes, pMapping->size() - nOffset) / (m_nChannels * sizeof(float));
+			m_dDuration = double(m_nSamples) / double(m_nSampleRate);
+			m_dDurationInSamples = double(m_nSamples);
 
+			m_pRawData.reset();
+			m_pData = reinterpret_cast<T*>(pMapping->data() + nOffset);
+			m_pMapping = std::move(pMapping);
+			return true;
+		}
 
 	protected:
 		std::unique_ptr<T[]> m_pRawData;
+		std::unique_ptr<Mapping> m_pMapping;
+		// The samples, either m_pRawData or in m_pMapping
+		T* m_pData = nullptr;
 		size_t m_nSamples = 0;
 		size_t m_nChannels = 0;
 		size_t m_nSampleRate = 0;
@@ -486,7 +817,22 @@ namespace olc::sound
 			return false;
 		}
 
-		
+		// Loads a wave with File::MapFile(), the channel views read the mapped samples
+		bool MapAudioWaveform(std::string sWavFile)
+		{
+			vChannelView.clear();
+
+			if (file.MapFile(sWavFile))
+			{
+				vChannelView.resize(file.channels());
+				for (uint32_t c = 0; c < file.channels(); c++)
+					vChannelView[c].SetData(file.data(), file.samples(), file.channels(), c);
+
+				return true;
+			}
+
+			return false;
+		}
 
 		bool LoadAudioWaveform(std::istream& sStream) { return false; }
 		bool LoadAudioWaveform(const char* pData, const size_t nBytes) { return false; }
@@ -497,18 +843,271 @@ namespace olc::sound
 
 	typedef Wave_generic<float> Wave;
 
+	// Plays a WAV file without loading all of it. A thread reads and converts the file a
+	// chunk at a time into a ring of samples, a few hundred milliseconds long, which the
+	// mixer plays from. A stream plays in one voice at a time, playing it again restarts it
+	class WaveStream
+	{
+	public:
+		WaveStream() = default;
+		WaveStream(const std::string& sWavFile, const double dBufferSeconds = 0.3);
+		~WaveStream();
+
+	public:
+		// Opens a WAV file and starts reading it ahead of the mixer, keeping
+		// dBufferSeconds of it converted
+		bool Open(const std::string& sWavFile, const double dBufferSeconds = 0.3);
+		// Stops reading the file. Stop any voice playing the stream first
+		void Close();
+
+		bool IsOpen() const;
+		size_t channels() const;
+		size_t samplerate() const;
+		double duration() const;
+
+		// Times the mixer has run out of samples, and played silence instead
+		uint32_t GetUnderruns() const;
+
+	private:
+		void ReaderLoop();
+		// Reader thread, converts up to nFrames frames into the ring, going back
+		// to the start of the file if looping. Returns frames converted
+		size_t ReadFrames(size_t nFrames);
+		void SeekStart();
+
+		static constexpr size_t nChunkFrames = 1024;
+		static constexpr size_t nLocalFrames = 4096;
+
+		std::ifstream m_ifs;
+		wave::Format m_format;
+		std::streampos m_posData;
+		size_t m_nFrames = 0;
+		size_t m_nFramesLeft = 0;
+		std::vector<char> m_vRaw;
+
+		// m_nWrite and m_nRead count samples ever written to and read from the ring
+		std::vector<float> m_vRing;
+		std::atomic<size_t> m_nWrite{ 0 };
+		std::atomic<size_t> m_nRead{ 0 };
+		// The reader has converted the last frame, and is not looping
+		std::atomic<bool> m_bEnded{ false };
+		std::atomic<bool> m_bLoop{ false };
+		// Set by the mixer to have the reader empty the ring and go back to the start. The
+		// mixer leaves the ring alone until the reader clears it
+		std::atomic<bool> m_bRewind{ false };
+		std::atomic<bool> m_bReading{ false };
+		std::atomic<uint32_t> m_nUnderruns{ 0 };
+		std::thread m_thReader;
+		std::mutex m_muxReader;
+		std::condition_variable m_cvReader;
+
+		// Mixer side. Frames taken from the ring which are still needed for LERPing, and the
+		// position in them of the next sample
+		std::vector<float> m_vLocal;
+		size_t m_nLocalFrames = 0;
+		double m_dLocalPosition = 0.0;
+		bool m_bPlayed = false;
+
+		friend class WaveEngine;
+	};
+
+	// A wave kept in memory as IMA ADPCM, a quarter of the size of 16 bit samples and an
+	// eighth of the size of a Wave's floats. The mixer decodes the blocks it plays as it
+	// plays them
+	class WaveAdpcm
+	{
+	public:
+		WaveAdpcm() = default;
+		WaveAdpcm(const std::string& sWavFile) { LoadAudioWaveform(sWavFile); }
+
+	public:
+		// Loads an IMA ADPCM WAV file as it is stored. Other WAV files are compressed as
+		// they are loaded
+		bool LoadAudioWaveform(const std::string& sWavFile);
+		// Compresses the samples of a wave, in blocks of nBlockAlign bytes (by default
+		// 512 bytes for each channel, about 1000 frames)
+		bool Encode(const Wave& wave, size_t nBlockAlign = 0);
+		// Saves as an IMA ADPCM WAV file
+		bool SaveFile(const std::string& sWavFile) const;
+		// Decodes every sample into a wave
+		Wave Decode() const;
+
+		size_t samples() const { return m_nSamples; }
+		size_t channels() const { return m_nChannels; }
+		size_t samplerate() const { return m_nSampleRate; }
+		double duration() const { return m_nSampleRate > 0 ? double(m_nSamples) / double(m_nSampleRate) : 0.0; }
+		size_t bytes() const { return m_vData.size(); }
+
+		size_t blockalign() const { return m_nBlockAlign; }
+		size_t framesperblock() const { return m_nFramesPerBlock; }
+		const uint8_t* block(const size_t nBlock) const { return m_vData.data() + nBlock * m_nBlockAlign; }
+
+	private:
+		std::vector<uint8_t> m_vData;
+		size_t m_nSamples = 0;
+		size_t m_nChannels = 0;
+		size_t m_nSampleRate = 0;
+		size_t m_nBlockAlign = 0;
+		size_t m_nFramesPerBlock = 0;
+	};
+
+	// Kernels the mixer is built from. Buffers are float samples, interleaved
+	// where there is more than one channel
+	namespace mix
+	{
+		// Instruction set the kernels were built for, "AVX2", "SSE2" or "scalar"
+		const char* Path();
+
+		// dst[n] += src[n] * fGain
+		void Accumulate(float* dst, const float* src, size_t nCount, float fGain);
+
+		// dst[n] *= fGain
+		void Scale(float* dst, size_t nCount, float fGain);
+
+		// dst[n] = sin(2 pi src[n]) * fGain, to within about 1e-7 of fGain, for src[n] in cycles
+		void SineCycles(float* dst, const float* src, size_t nCount, float fGain);
+
+		// Adds a mono stream to both channels of stereo output
+		void AccumulateMonoToStereo(float* dst, const float* src, size_t nFrames, float fGain);
+
+		// Writes one channel of an interleaved source LERPed at nFrames positions, starting at
+		// nFixedStart and nFixedStep apart (32.32 fixed point, in samples). The sample after
+		// every position, plus one, must be in the source
+		void Resample(float* dst, const float* src, size_t nSrcChannels, size_t nChannel, uint64_t nFixedStart, uint64_t nFixedStep, size_t nFrames);
+
+		// Adds a stereo source, LERPed at positions as Resample() takes them, to stereo output.
+		// As there, the sample after every position, plus one, must be in the source
+		void AccumulateResampledStereo(float* dst, const float* src, uint64_t nFixedStart, uint64_t nFixedStep, size_t nFrames, float fGain);
+
+		// A windowed sinc filter, as nSincPhases + 1 rows of nTaps coefficients. Row r holds the
+		// taps for a position r / nSincPhases of a sample past a whole one, the frame at the
+		// position being tap nTaps / 2 - 1. Positions between rows LERP between their taps
+		constexpr size_t nSincPhases = 128;
+
+		struct SincTable
+		{
+			double dMaxStep = 1.0;	// Fastest a source can be stepped through without aliasing
+			size_t nTaps = 0;		// A multiple of 8
+			std::vector<float> vCoefficients;
+		};
+
+		// The table with the fewest taps that can filter a source stepped through dStep samples
+		// at a time, or nullptr if it is stepped too fast for any. Tables are made on the first
+		// call, which should not be from the audio thread
+		const SincTable* FindSincTable(double dStep);
+
+		// Writes nFrames frames of an interleaved source of nSrcFrames frames, filtered with a
+		// sinc table at positions as Resample() takes them. Frames outside the source are silent
+		void ResampleSinc(float* dst, const float* src, size_t nSrcFrames, size_t nSrcChannels, const SincTable& table, uint64_t nFixedStart, uint64_t nFixedStep, size_t nFrames);
+	}
+
+	// Handle to a playing wave. Each call to PlayWaveform() gets a new one, so a handle
+	// to a wave that has finished never refers to anything else. 0 is no wave
+	typedef uint64_t PlayingWave;
+
 	struct WaveInstance
 	{
+		PlayingWave nID = 0;
 		Wave* pWave = nullptr;
+		WaveStream* pStream = nullptr;
+		WaveAdpcm* pAdpcm = nullptr;
 		double dInstanceTime = 0.0;
 		double dDuration = 0.0;
+		double dSpeed = 1.0;
 		double dSpeedModifier = 1.0;
+		float fVolume = 1.0f;
+		int32_t nPriority = 0;
 		bool bFinished = false;
 		bool bLoop = false;
 		bool bFlagForStop = false;
+
+		// How far a compressed wave has been decoded: a block, a frame in it, and each
+		// channel's decoder at that frame
+		size_t nAdpcmBlock = std::numeric_limits<size_t>::max();
+		size_t nAdpcmFrame = 0;
+		std::array<wave::adpcm::State, wave::adpcm::nMaxChannels> adpcmState;
+
+		// The rate and length of whichever source the voice plays
+		double SourceRate() const;
+		double SourceDuration() const;
+	};
+
+	// Fixed size queue between exactly one producer thread and one consumer thread,
+	// without locks. N must be a power of 2
+	template<typename T, size_t N>
+	class SPSCQueue
+	{
+		static_assert(N > 0 && (N & (N - 1)) == 0, "SPSCQueue size must be a power of 2");
+
+	public:
+		// Producer only. Returns false if the queue is full
+		bool Push(const T& item)
+		{
+			size_t nTail = m_nTail.load(std::memory_order_relaxed);
+			if (nTail - m_nHead.load(std::memory_order_acquire) == N)
+				return false;
+			m_items[nTail & (N - 1)] = item;
+			m_nTail.store(nTail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer only. Returns false if the queue is empty
+		bool Pop(T& item)
+		{
+			size_t nHead = m_nHead.load(std::memory_order_relaxed);
+			if (nHead == m_nTail.load(std::memory_order_acquire))
+				return false;
+			item = m_items[nHead & (N - 1)];
+			m_nHead.store(nHead + 1, std::memory_order_release);
+			return true;
+		}
+
+	private:
+		std::array<T, N> m_items{};
+		// Apart, so the two threads are not fighting over one cache line
+		alignas(64) std::atomic<size_t> m_nHead{ 0 };
+		alignas(64) std::atomic<size_t> m_nTail{ 0 };
+	};
+
+	// Something the game thread asks of the audio thread
+	struct WaveCommand
+	{
+		enum class Type : uint8_t
+		{
+			Play,
+			Stop,
+			StopAll,
+			SetVolume,
+			SetSpeed,
+			SetOutputVolume,
+		};
+
+		Type type = Type::Play;
+		PlayingWave nID = 0;
+		Wave* pWave = nullptr;
+		WaveStream* pStream = nullptr;
+		WaveAdpcm* pAdpcm = nullptr;
+		bool bLoop = false;
+		double dSpeed = 1.0;
+		float fVolume = 1.0f;
+		int32_t nPriority = 0;
+	};
+
+	// Which voice a wave takes when every voice is playing. Only voices whose priority is no
+	// higher than the new wave's are considered, the lowest priority first
+	enum class VoiceSteal : uint8_t
+	{
+		Never,		// Nothing is stolen, the new wave does not play
+		Quietest,	// The voice with the lowest volume, then the oldest
+		Oldest,		// The voice that started playing first
 	};
 
-	typedef std::list<WaveInstance>::iterator PlayingWave;
+	// How waves are read between their samples, when they play at other than the output's rate
+	enum class Interpolation : uint8_t
+	{
+		Linear,		// LERPed between neighbouring samples. Cheapest, but aliases
+		Sinc,		// Filtered with a windowed sinc. Streams and compressed waves are still LERPed
+	};
 
 	namespace driver
 	{
@@ -543,28 +1142,82 @@ namespace olc::sound
 		// Specify a device for audio input prior to calling InitialiseAudio()
 		void UseInputDevice(const std::string& sDeviceOut);
 
+		// Replace the platform's driver prior to calling InitialiseAudio(), e.g. with a
+		// driver::Null or driver::WaveWriter made for this engine
+		void UseDriver(std::unique_ptr<driver::Base> pDriver);
+
+		// Specify how many waves can play at once prior to calling InitialiseAudio(). The
+		// voices are allocated there, so mixing never allocates
+		void SetVoiceLimit(const uint32_t nVoices);
+
+		// Choose what happens when a wave is played with every voice taken
+		void SetVoiceStealing(const VoiceSteal steal);
+
+		// Number of voices playing as of the last block mixed
+		uint32_t GetActiveVoices() const;
+
+		// Choose how waves played from memory are resampled
+		void SetInterpolation(const Interpolation interpolation);
+
 
 		void SetCallBack_NewSample(std::function<void(double)> func);
 		void SetCallBack_SynthFunction(std::function<float(uint32_t, double)> func);
 		void SetCallBack_FilterFunction(std::function<float(uint32_t, double, float)> func);
 
+		// Block versions of the above, called for each channel with its run of samples as
+		// (channel, time of the first sample, time per sample, samples, count). The synth
+		// function adds to samples that start silent, which are then added to the output. The
+		// filter function changes the channel's samples in place. Block synthesis runs before
+		// the per sample functions, and block filtering after them
+		void SetCallBack_SynthBlock(std::function<void(uint32_t, double, double, float*, uint32_t)> func);
+		void SetCallBack_FilterBlock(std::function<void(uint32_t, double, double, float*, uint32_t)> func);
+
 	public:
+		// These are thread safe with respect to the audio thread, but should all be called from one
+		// thread (usually the game's). They queue a command which the audio thread carries out
+		// before it mixes its next block
 		void SetOutputVolume(const float fVolume);
 
-
-
-		PlayingWave PlayWaveform(Wave* pWave, bool bLoop = false, double dSpeed = 1.0);
-		void StopWaveform(const PlayingWave& w);
+		PlayingWave PlayWaveform(Wave* pWave, bool bLoop = false, double dSpeed = 1.0, float fVolume = 1.0f, int32_t nPriority = 0);
+		PlayingWave PlayWaveform(WaveAdpcm* pWave, bool bLoop = false, double dSpeed = 1.0, float fVolume = 1.0f, int32_t nPriority = 0);
+		PlayingWave PlayStream(WaveStream* pStream, bool bLoop = false, double dSpeed = 1.0, float fVolume = 1.0f, int32_t nPriority = 0);
+		void StopWaveform(const PlayingWave w);
 		void StopAll();
+		void SetWaveVolume(const PlayingWave w, const float fVolume);
+		void SetWaveSpeed(const PlayingWave w, const double dSpeed);
 
 	private:
+		// Queues a command, waiting for room while audio is running. Returns false if it could not
+		bool PostCommand(const WaveCommand& cmd);
+		// Audio thread, carries out every command queued so far
+		void ApplyCommands();
+		void ApplyCommand(const WaveCommand& cmd);
+		// Audio thread, the voice playing a wave, or nullptr
+		WaveInstance* FindVoice(const PlayingWave w);
+		// Audio thread, a free voice for a new wave, stealing one if need be. -1 if there is none
+		int32_t AllocateVoice(const int32_t nPriority);
+
 		uint32_t FillOutputBuffer(std::vector<float>& vBuffer, const uint32_t nBufferOffset, const uint32_t nRequiredSamples);
+		// Adds nSamples of a wave instance, scaled by its volume, to interleaved output,
+		// starting dPosition samples into the wave
+		void MixWave(WaveInstance& wave, float* pOutput, const uint32_t nSamples, const double dPosition);
+		// The same for any interleaved samples, stepping dStep samples at a time
+		void MixSamples(const float* pData, const size_t nWaveSamples, const size_t nWaveChannels, const double dStep, const float fGain,
+			float* pOutput, const uint32_t nSamples, const double dPosition) const;
+		// As MixSamples(), filtering with a windowed sinc rather than LERPing
+		void MixSinc(const float* pData, const size_t nWaveSamples, const size_t nWaveChannels, const double dStep, const float fGain,
+			float* pOutput, const uint32_t nSamples, const double dPosition) const;
+		// Adds nSamples of a streaming wave instance to interleaved output. Returns
+		// false once the stream has finished
+		bool MixStream(WaveInstance& wave, float* pOutput, const uint32_t nSamples);
 
 	private:
 		std::unique_ptr<driver::Base> m_driver;
 		std::function<void(double)> m_funcNewSample;
 		std::function<float(uint32_t, double)> m_funcUserSynth;
 		std::function<float(uint32_t, double, float)> m_funcUserFilter;
+		std::function<void(uint32_t, double, double, float*, uint32_t)> m_funcUserSynthBlock;
+		std::function<void(uint32_t, double, double, float*, uint32_t)> m_funcUserFilterBlock;
 
 
 	private:
@@ -581,7 +1234,23 @@ namespace olc::sound
 		std::string m_sOutputDevice;
 
 	private:
-		std::list<WaveInstance> m_listWaves;
+		// Only touched by the audio thread while audio is running. m_vActiveVoices and
+		// m_vFreeVoices index m_vVoices, and have room reserved for all of them
+		std::vector<WaveInstance> m_vVoices;
+		std::vector<uint32_t> m_vActiveVoices;
+		std::vector<uint32_t> m_vFreeVoices;
+		uint32_t m_nVoiceLimit = 64;
+		std::atomic<VoiceSteal> m_voiceSteal{ VoiceSteal::Quietest };
+		std::atomic<Interpolation> m_interpolation{ Interpolation::Linear };
+		std::atomic<uint32_t> m_nActiveVoices{ 0 };
+		// Compressed waves are decoded into this a block at a time
+		std::vector<float> m_vDecode;
+		// One channel of a block, for the block callbacks
+		std::vector<float> m_vChannelBlock;
+
+		SPSCQueue<WaveCommand, 1024> m_queueCommands;
+		PlayingWave m_nLastWaveID = 0;
+		std::atomic<bool> m_bAudioRunning{ false };
 
 	public:
 		uint32_t GetSampleRate() const;
@@ -633,22 +1302,95 @@ namespace olc::sound
 		// Handle to SoundWave, to interrogate optons, and get user data
 		WaveEngine* m_pHost = nullptr;
 	};
-	}
 
-
-	namespace synth
+	// Mixes without any audio hardware, on every platform. Started by InitialiseAudio(),
+	// it mixes blocks on a thread of its own, unless it was made for manual use, where
+	// nothing mixes until RenderBlocks() is called
+	class Null : public Base
 	{
-		class Property
+	public:
+		enum class Mode
 		{
-		public:
-			double value = 0.0f;
+			Manual,		// RenderBlocks() mixes on the calling thread
+			Free,		// Blocks are mixed as fast as they can be
+			RealTime,	// Blocks are mixed as fast as they would play
+		};
 
-		public:
-			Property() = default;
-			Property(double f);
+		Null(WaveEngine* pHost, const Mode mode = Mode::Free);
+		~Null();
 
-		public:
-			Property& operator =(const double f);			
+	public:
+		bool Start() override;
+		void Stop() override;
+
+		// Mixes nBlocks blocks on the calling thread. Only call this when the
+		// driver is not started, or was made for manual use
+		void RenderBlocks(const uint32_t nBlocks);
+
+		// Blocks mixed so far
+		uint64_t GetBlocksRendered() const;
+
+	protected:
+		// Called with every block mixed, interleaved float samples
+		virtual void OnBlock(const std::vector<float>& vBlock);
+
+	private:
+		void DriverLoop();
+
+		Mode m_mode;
+		std::vector<float> m_vBlock;
+		std::atomic<uint64_t> m_nBlocksRendered{ 0 };
+		std::atomic<bool> m_bDriverLoopActive{ false };
+		std::thread m_thDriverLoop;
+	};
+
+	// A Null driver that writes everything it mixes to a WAV file, 32 bit float
+	// unless nSampleSize is 2 (16 bit PCM)
+	class WaveWriter : public Null
+	{
+	public:
+		WaveWriter(WaveEngine* pHost, const std::string& sFilename, const Mode mode = Mode::Free, const uint32_t nSampleSize = 4);
+		~WaveWriter();
+
+	public:
+		// The file is opened with the device name ignored, and finished off when closed
+		bool Open(const std::string& sOutputDevice, const std::string& sInputDevice) override;
+		void Close() override;
+
+	protected:
+		void OnBlock(const std::vector<float>& vBlock) override;
+
+	private:
+		std::string m_sFilename;
+		uint32_t m_nSampleSize;
+		std::ofstream m_ofs;
+		size_t m_nSamplesWritten = 0;
+		std::vector<short> m_vPCM;
+	};
+	}
+
+
+	namespace synth
+	{
+		// Most frames a module processes in one UpdateBlock()
+		constexpr uint32_t nMaxBlockFrames = 1024;
+
+		class Property
+		{
+		public:
+			double value = 0.0f;
+			// While a module processes blocks, its value at each frame of the last one, or
+			// nullptr if it holds value throughout. Patches carry it along with value
+			const float* block = nullptr;
+
+		public:
+			Property() = default;
+			Property(double f);
+
+		public:
+			Property& operator =(const double f);			
+			// Value at frame n of the block being processed
+			double at(const uint32_t n) const;
 		};
 
 
@@ -662,6 +1404,9 @@ namespace olc::sound
 		{
 		public:
 			virtual void Update(uint32_t nChannel, double dTime, double dTimeStep) = 0;
+			// Processes nFrames frames, up to nMaxBlockFrames, starting at dTime. By default
+			// calls Update() for each, so outputs only hold the last frame's value
+			virtual void UpdateBlock(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nFrames);
 		};
 
 
@@ -680,6 +1425,9 @@ namespace olc::sound
 		public:
 			void UpdatePatches();
 			void Update(uint32_t nChannel, double dTime, double dTimeStep);
+			// Processes a block through every module in the order they were added, updating
+			// patches before each, so a module hears this block from modules added before it
+			void UpdateBlock(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nFrames);
 
 		protected:
 			std::vector<Module*> m_vModules;
@@ -724,12 +1472,17 @@ namespace olc::sound
 			double max_frequency = 20000.0;
 			uint32_t random_seed = 0xB00B1E5;
 
+			// Phase and output at each frame of the last block
+			std::array<float, nMaxBlockFrames> block_phase;
+			std::array<float, nMaxBlockFrames> block_output;
+
 			double rndDouble(double min, double max);
 			uint32_t rnd();
 			
 
 		public:
 			virtual void Update(uint32_t nChannel, double dTime, double dTimeStep) override;
+			virtual void UpdateBlock(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nFrames) override;
 
 		};
 	}
@@ -928,242 +1681,1869 @@ namespace olc::sound::driver
 #ifdef OLC_SOUNDWAVE
 #undef OLC_SOUNDWAVE
 
+#if defined(_WIN32)
+#define _WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#undef min
+#undef max
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace olc::sound
 {	
-	WaveEngine::WaveEngine()
+	namespace wave
 	{
-		m_sInputDevice = "NONE";
-		m_sOutputDevice = "DEFAULT";
+		Mapping::~Mapping()
+		{
+			Close();
+		}
 
-#if defined(SOUNDWAVE_USING_WINMM)
-		m_driver = std::make_unique<driver::WinMM>(this);
-#endif
+		bool Mapping::Open(const std::string& sFilename)
+		{
+			Close();
 
-#if defined(SOUNDWAVE_USING_WASAPI)
-		m_driver = std::make_unique<driver::WASAPI>(this);
-#endif
+#if defined(_WIN32)
+			HANDLE hFile = CreateFileA(sFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (hFile == INVALID_HANDLE_VALUE)
+				return false;
 
-#if defined(SOUNDWAVE_USING_XAUDIO)
-		m_driver = std::make_unique<driver::XAudio>(this);
-#endif
+			LARGE_INTEGER nSize;
+			HANDLE hMapping = nullptr;
+			if (GetFileSizeEx(hFile, &nSize) && nSize.QuadPart > 0)
+				hMapping = CreateFileMappingA(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+			CloseHandle(hFile);
+			if (hMapping == nullptr)
+				return false;
 
-#if defined(SOUNDWAVE_USING_OPENAL)
-		m_driver = std::make_unique<driver::OpenAL>(this);
-#endif
+			// The view keeps the mapping open
+			void* pView = MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+			CloseHandle(hMapping);
+			if (pView == nullptr)
+				return false;
 
-#if defined(SOUNDWAVE_USING_ALSA)
-		m_driver = std::make_unique<driver::ALSA>(this);
-#endif
+			m_pData = static_cast<char*>(pView);
+			m_nSize = size_t(nSize.QuadPart);
+#else
+			int nFile = open(sFilename.c_str(), O_RDONLY);
+			if (nFile < 0)
+				return false;
 
-#if defined(SOUNDWAVE_USING_SDLMIXER)
-		m_driver = std::make_unique<driver::SDLMixer>(this);
-#endif
+			struct stat st;
+			void* pView = MAP_FAILED;
+			if (fstat(nFile, &st) == 0 && st.st_size > 0)
+				pView = mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, nFile, 0);
+			close(nFile);
+			if (pView == MAP_FAILED)
+				return false;
 
-#if defined(SOUNDWAVE_USING_PULSE)
-		m_driver = std::make_unique<driver::PulseAudio>(this);
+			m_pData = static_cast<char*>(pView);
+			m_nSize = size_t(st.st_size);
 #endif
-	}
-
-	WaveEngine::~WaveEngine()
-	{
-		DestroyAudio();
-	}
-
-	std::vector<std::string> WaveEngine::GetOutputDevices()
-	{
-		return { "XXX" };
-	}
-
-
-	void WaveEngine::UseOutputDevice(const std::string& sDeviceOut)
-	{
-		m_sOutputDevice = sDeviceOut;
-	}
-
-	std::vector<std::string> WaveEngine::GetInputDevices()
-	{
-		return { "XXX" };
-	}
-
-	void WaveEngine::UseInputDevice(const std::string& sDeviceIn)
-	{
-		m_sInputDevice = sDeviceIn;
-	}
-
-	bool WaveEngine::InitialiseAudio(uint32_t nSampleRate, uint32_t nChannels, uint32_t nBlocks, uint32_t nBlockSamples)
-	{
-		m_nSampleRate = nSampleRate;
-		m_nChannels = nChannels;
-		m_nBlocks = nBlocks;
-		m_nBlockSamples = nBlockSamples;
-		m_dSamplePerTime = double(nSampleRate);
-		m_dTimePerSample = 1.0 / double(nSampleRate);
-		m_driver->Open(m_sOutputDevice, m_sInputDevice);
-		m_driver->Start();
-		return false;
-	}
-
-
-	bool WaveEngine::DestroyAudio()
-	{
-		StopAll();
-		m_driver->Stop();
-		m_driver->Close();
-		return false;
-	}
+			return true;
+		}
 
-	void WaveEngine::SetCallBack_NewSample(std::function<void(double)> func)
-	{
-		m_funcNewSample = func;
-	}
+		void Mapping::Close()
+		{
+			if (m_pData == nullptr)
+				return;
 
-	void WaveEngine::SetCallBack_SynthFunction(std::function<float(uint32_t, double)> func)
-	{
-		m_funcUserSynth = func;
-	}
+#if defined(_WIN32)
+			UnmapViewOfFile(m_pData);
+#else
+			munmap(m_pData, m_nSize);
+#endif
+			m_pData = nullptr;
+			m_nSize = 0;
+		}
 
-	void WaveEngine::SetCallBack_FilterFunction(std::function<float(uint32_t, double, float)> func)
-	{
-		m_funcUserFilter = func;
-	}
+		namespace adpcm
+		{
+			constexpr int32_t StepTable[89] =
+			{
+				7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+				50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+				253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+				1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+				3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+				12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+			};
 
-	PlayingWave WaveEngine::PlayWaveform(Wave* pWave, bool bLoop, double dSpeed)
-	{
-		WaveInstance wi;
-		wi.bLoop = bLoop;
-		wi.pWave = pWave;
-		wi.dSpeedModifier = dSpeed * double(pWave->file.samplerate()) / m_dSamplePerTime;
-		wi.dDuration = pWave->file.duration() / dSpeed;
-		wi.dInstanceTime = m_dGlobalTime;
-		m_listWaves.push_back(wi);
-		return std::prev(m_listWaves.end());
-	}
+			constexpr int32_t IndexTable[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
 
-	void WaveEngine::StopWaveform(const PlayingWave& w)
-	{
-		w->bFlagForStop = true;
-	}
+			// Where sample n (from 1) of channel c is, as a byte and which half of it
+			inline size_t CodeByte(const size_t nChannels, const size_t c, const size_t n)
+			{
+				size_t i = n - 1;
+				return 4 * nChannels + (i / 8) * 4 * nChannels + 4 * c + (i % 8) / 2;
+			}
 
-	void WaveEngine::StopAll()
-	{
-		for (auto& wave : m_listWaves)
-		{
-			wave.bFlagForStop = true;
-		}
-	}
+			constexpr float fScale = 1.0f / float(std::numeric_limits<int16_t>::max());
 
-	void WaveEngine::SetOutputVolume(const float fVolume)
-	{
-		m_fOutputVolume = std::clamp(fVolume, 0.0f, 1.0f);
-	}
+			// The signed step each code takes from each step index, and the index after it,
+			// so a sample is decoded with one lookup
+			struct Steps
+			{
+				int32_t nDelta[89 * 16];
+				uint8_t nNext[89 * 16];
+			};
 
-	uint32_t WaveEngine::FillOutputBuffer(std::vector<float>& vBuffer, const uint32_t nBufferOffset, const uint32_t nRequiredSamples)
-	{
-		for (uint32_t nSample = 0; nSample < nRequiredSamples; nSample++)
-		{
-			double dSampleTime = m_dGlobalTime + nSample * m_dTimePerSample;
+			constexpr Steps MakeSteps()
+			{
+				Steps steps{};
+				for (int32_t nIndex = 0; nIndex < 89; nIndex++)
+				{
+					for (int32_t nCode = 0; nCode < 16; nCode++)
+					{
+						int32_t nStep = StepTable[nIndex];
+						int32_t nDelta = nStep >> 3;
+						if (nCode & 4) nDelta += nStep;
+						if (nCode & 2) nDelta += nStep >> 1;
+						if (nCode & 1) nDelta += nStep >> 2;
+						steps.nDelta[nIndex * 16 + nCode] = (nCode & 8) ? -nDelta : nDelta;
+						steps.nNext[nIndex * 16 + nCode] = uint8_t(std::clamp(nIndex + IndexTable[nCode], 0, 88));
+					}
+				}
+				return steps;
+			}
 
-			if (m_funcNewSample)
-				m_funcNewSample(dSampleTime);
+			constexpr Steps StepsTable = MakeSteps();
 
-			for (uint32_t nChannel = 0; nChannel < m_nChannels; nChannel++)
+			// Decodes K neighbouring channels, from channel c, together. Each sample depends on
+			// the one before, so this gives the processor more than one to work on at once
+			template<size_t K>
+			void DecodeChannels(const uint8_t* pBlock, const size_t nChannels, const size_t c, State* pState, const size_t nFrame, const size_t nTo, const size_t nOut, float* pOutput)
 			{
-				// Construct the sample
-				float fSample = 0.0f;
+				int32_t nPredictor[K], nIndex[K];
+				for (size_t k = 0; k < K; k++)
+				{
+					nPredictor[k] = pState[k].nPredictor;
+					nIndex[k] = pState[k].nIndex;
+					if (nFrame >= nOut)
+						pOutput[(nFrame - nOut) * nChannels + c + k] = float(nPredictor[k]) * fScale;
+				}
 
-				// 1) Sample any active waves
-				for (auto& wave : m_listWaves)
+				// Each channel's codes come 8 at a time in a 32 bit word, first in the lowest bits
+				size_t n = nFrame + 1;
+				while (n <= nTo)
 				{
-					// Is wave instance flagged for stopping?
-					if (wave.bFlagForStop)
+					size_t i = n - 1;
+					uint32_t nWord[K];
+					for (size_t k = 0; k < K; k++)
 					{
-						wave.bFinished = true;
+						std::memcpy(&nWord[k], pBlock + 4 * nChannels * (1 + i / 8) + 4 * (c + k), sizeof(uint32_t));
+						nWord[k] >>= 4 * (i % 8);
 					}
-					else
-					{
-						// Calculate offset into wave instance
-						double dTimeOffset = dSampleTime - wave.dInstanceTime;
 
-						// If offset is larger than wave then...
-						if (dTimeOffset >= wave.dDuration)
-						{
-							if (wave.bLoop)
-							{
-								// ...if looping, reset the wave instance
-								wave.dInstanceTime = dSampleTime;
-							}
-							else
-							{
-								// ...if not looping, flag wave instance as dead
-								wave.bFinished = true;
-							}
-						}
-						else
+					size_t nEnd = std::min(nTo, n + 7 - i % 8);
+					for (; n <= nEnd; n++)
+					{
+						for (size_t k = 0; k < K; k++)
 						{
-							// OR, sample the waveform from the correct channel
-							fSample += float(wave.pWave->vChannelView[nChannel % wave.pWave->file.channels()].GetSample(dTimeOffset * m_dSamplePerTime * wave.dSpeedModifier));
+							size_t nEntry = size_t(nIndex[k]) * 16 + (nWord[k] & 0x0F);
+							nWord[k] >>= 4;
+							nPredictor[k] = std::clamp(nPredictor[k] + StepsTable.nDelta[nEntry], -32768, 32767);
+							nIndex[k] = StepsTable.nNext[nEntry];
+							if (n >= nOut)
+								pOutput[(n - nOut) * nChannels + c + k] = float(nPredictor[k]) * fScale;
 						}
 					}
 				}
 
-				// Remove waveform instances that have finished
-				m_listWaves.remove_if([](const WaveInstance& wi) {return wi.bFinished; });
-
-
-				// 2) If user is synthesizing, request sample
-				if (m_funcUserSynth)
-					fSample += m_funcUserSynth(nChannel, dSampleTime);
+				for (size_t k = 0; k < K; k++)
+				{
+					pState[k].nPredictor = nPredictor[k];
+					pState[k].nIndex = nIndex[k];
+				}
+			}
 
-				// 3) Apply global filters
+			void StartBlock(const uint8_t* pBlock, const size_t nChannels, State* pState)
+			{
+				for (size_t c = 0; c < nChannels; c++)
+				{
+					int16_t nFirst = 0;
+					std::memcpy(&nFirst, pBlock + 4 * c, sizeof(int16_t));
+					pState[c].nPredictor = nFirst;
+					pState[c].nIndex = std::min(int32_t(pBlock[4 * c + 2]), 88);
+				}
+			}
 
+			void DecodeFrames(const uint8_t* pBlock, const size_t nChannels, State* pState, const size_t nFrame, const size_t nTo, const size_t nOut, float* pOutput)
+			{
+				size_t c = 0;
+				for (; c + 2 <= nChannels; c += 2)
+					DecodeChannels<2>(pBlock, nChannels, c, pState + c, nFrame, nTo, nOut, pOutput);
+				if (c < nChannels)
+					DecodeChannels<1>(pBlock, nChannels, c, pState + c, nFrame, nTo, nOut, pOutput);
+			}
 
-				// 4) If user is filtering, allow manipulation of output
-				if (m_funcUserFilter)
-					fSample = m_funcUserFilter(nChannel, dSampleTime, fSample);
+			void DecodeBlock(const uint8_t* pBlock, const size_t nChannels, const size_t nFrames, float* pOutput)
+			{
+				if (nFrames == 0)
+					return;
 
-				// Place sample in buffer
-				vBuffer[nBufferOffset + nSample * m_nChannels + nChannel] = fSample * m_fOutputVolume;
+				State state[2];
+				size_t c = 0;
+				for (; c + 2 <= nChannels; c += 2)
+				{
+					StartBlock(pBlock + 4 * c, 2, state);
+					DecodeChannels<2>(pBlock, nChannels, c, state, 0, nFrames - 1, 0, pOutput);
+				}
+				if (c < nChannels)
+				{
+					StartBlock(pBlock + 4 * c, 1, state);
+					DecodeChannels<1>(pBlock, nChannels, c, state, 0, nFrames - 1, 0, pOutput);
+				}
 			}
-		}
 
-		// UPdate global time, accounting for error (thanks scripticuk)
-		m_dGlobalTime += nRequiredSamples * m_dTimePerSample;
-		return nRequiredSamples;
-	}
+			void EncodeBlock(const float* pInput, const size_t nChannels, const size_t nFrames, const size_t nFramesPerBlock, int32_t* pIndex, uint8_t* pBlock)
+			{
+				auto ToPCM = [](float f) { return int32_t(std::lround(std::clamp(f, -1.0f, 1.0f) * float(std::numeric_limits<int16_t>::max()))); };
 
+				std::memset(pBlock, 0, nChannels * (4 + (nFramesPerBlock - 1) / 2));
+				for (size_t c = 0; c < nChannels; c++)
+				{
+					int32_t nPredictor = ToPCM(pInput[c]);
+					int32_t nIndex = pIndex[c];
+					int16_t nFirst = int16_t(nPredictor);
+					std::memcpy(pBlock + 4 * c, &nFirst, sizeof(int16_t));
+					pBlock[4 * c + 2] = uint8_t(nIndex);
 
-	uint32_t WaveEngine::GetSampleRate() const
-	{
-		return m_nSampleRate;
-	}
+					for (size_t n = 1; n < nFramesPerBlock; n++)
+					{
+						// Past the last frame, it is held
+						int32_t nDiff = ToPCM(pInput[std::min(n, nFrames - 1) * nChannels + c]) - nPredictor;
+						uint8_t nCode = 0;
+						if (nDiff < 0)
+						{
+							nCode = 8;
+							nDiff = -nDiff;
+						}
 
-	uint32_t WaveEngine::GetChannels() const
-	{
-		return m_nChannels;
+						// The step the decoder will take, closest to the difference
+						int32_t nStep = StepTable[nIndex];
+						int32_t nDelta = nStep >> 3;
+						if (nDiff >= nStep) { nCode |= 4; nDiff -= nStep; nDelta += nStep; }
+						nStep >>= 1;
+						if (nDiff >= nStep) { nCode |= 2; nDiff -= nStep; nDelta += nStep; }
+						nStep >>= 1;
+						if (nDiff >= nStep) { nCode |= 1; nDelta += nStep; }
+						nPredictor = std::clamp(nPredictor + ((nCode & 8) ? -nDelta : nDelta), -32768, 32767);
+						nIndex = std::clamp(nIndex + IndexTable[nCode], 0, 88);
+
+						pBlock[CodeByte(nChannels, c, n)] |= ((n - 1) & 1) ? uint8_t(nCode << 4) : nCode;
+					}
+					pIndex[c] = nIndex;
+				}
+			}
+		}
 	}
 
-	uint32_t WaveEngine::GetBlocks() const
+	namespace mix
 	{
-		return m_nBlocks;
-	}
+		const char* Path()
+		{
+#if defined(SOUNDWAVE_SIMD_AVX2)
+			return "AVX2";
+#elif defined(SOUNDWAVE_SIMD_SSE2)
+			return "SSE2";
+#else
+			return "scalar";
+#endif
+		}
 
-	uint32_t WaveEngine::GetBlockSampleCount() const
-	{
-		return m_nBlockSamples;
-	}
+		void Accumulate(float* dst, const float* src, size_t nCount, float fGain)
+		{
+			size_t n = 0;
+#if defined(SOUNDWAVE_SIMD_AVX2)
+			const __m256 vGain8 = _mm256_set1_ps(fGain);
+			for (; n + 8 <= nCount; n += 8)
+				_mm256_storeu_ps(dst + n, _mm256_add_ps(_mm256_loadu_ps(dst + n), _mm256_mul_ps(_mm256_loadu_ps(src + n), vGain8)));
+#endif
+#if defined(SOUNDWAVE_SIMD_SSE2)
+			const __m128 vGain4 = _mm_set1_ps(fGain);
+			for (; n + 4 <= nCount; n += 4)
+				_mm_storeu_ps(dst + n, _mm_add_ps(_mm_loadu_ps(dst + n), _mm_mul_ps(_mm_loadu_ps(src + n), vGain4)));
+#endif
+			for (; n < nCount; n++)
+				dst[n] += src[n] * fGain;
+		}
 
-	double WaveEngine::GetTimePerSample() const
-	{
-		return m_dTimePerSample;
-	}
+		void Scale(float* dst, size_t nCount, float fGain)
+		{
+			size_t n = 0;
+#if defined(SOUNDWAVE_SIMD_AVX2)
+			const __m256 vGain8 = _mm256_set1_ps(fGain);
+			for (; n + 8 <= nCount; n += 8)
+				_mm256_storeu_ps(dst + n, _mm256_mul_ps(_mm256_loadu_ps(dst + n), vGain8));
+#endif
+#if defined(SOUNDWAVE_SIMD_SSE2)
+			const __m128 vGain4 = _mm_set1_ps(fGain);
+			for (; n + 4 <= nCount; n += 4)
+				_mm_storeu_ps(dst + n, _mm_mul_ps(_mm_loadu_ps(dst + n), vGain4));
+#endif
+			for (; n < nCount; n++)
+				dst[n] *= fGain;
+		}
 
-	namespace driver
-	{
-	Base::Base(olc::sound::WaveEngine* pHost) : m_pHost(pHost)
-	{}
+		void SineCycles(float* dst, const float* src, size_t nCount, float fGain)
+		{
+			// Each phase is brought to within a quarter cycle of zero, where sin(2 pi x) is odd
+			// and its Taylor series to the 11th power is good to float precision
+			constexpr float fTwoPi = 6.28318530717958647692f;
+			constexpr float c3 = -1.0f / 6.0f, c5 = 1.0f / 120.0f, c7 = -1.0f / 5040.0f;
+			constexpr float c9 = 1.0f / 362880.0f, c11 = -1.0f / 39916800.0f;
+			size_t n = 0;
+#if defined(SOUNDWAVE_SIMD_AVX2)
+			const __m256 vSign8 = _mm256_set1_ps(-0.0f), vHalf8 = _mm256_set1_ps(0.5f);
+			const __m256 vScale8 = _mm256_set1_ps(fTwoPi), vGain8 = _mm256_set1_ps(fGain);
+			for (; n + 8 <= nCount; n += 8)
+			{
+				__m256 x = _mm256_loadu_ps(src + n);
+				x = _mm256_sub_ps(x, _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+				__m256 a = _mm256_andnot_ps(vSign8, x);
+				a = _mm256_min_ps(a, _mm256_sub_ps(vHalf8, a));
+				__m256 y = _mm256_mul_ps(_mm256_or_ps(a, _mm256_and_ps(vSign8, x)), vScale8);
+				__m256 y2 = _mm256_mul_ps(y, y);
+				__m256 p = _mm256_add_ps(_mm256_set1_ps(c9), _mm256_mul_ps(y2, _mm256_set1_ps(c11)));
+				p = _mm256_add_ps(_mm256_set1_ps(c7), _mm256_mul_ps(y2, p));
+				p = _mm256_add_ps(_mm256_set1_ps(c5), _mm256_mul_ps(y2, p));
+				p = _mm256_add_ps(_mm256_set1_ps(c3), _mm256_mul_ps(y2, p));
+				p = _mm256_add_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(y2, p));
+				_mm256_storeu_ps(dst + n, _mm256_mul_ps(_mm256_mul_ps(y, p), vGain8));
+			}
+#endif
+#if defined(SOUNDWAVE_SIMD_SSE2)
+			const __m128 vSign4 = _mm_set1_ps(-0.0f), vHalf4 = _mm_set1_ps(0.5f);
+			const __m128 vScale4 = _mm_set1_ps(fTwoPi), vGain4 = _mm_set1_ps(fGain);
+			for (; n + 4 <= nCount; n += 4)
+			{
+				// SSE2 has no rounding instruction, but converting to integers rounds to nearest
+				__m128 x = _mm_loadu_ps(src + n);
+				x = _mm_sub_ps(x, _mm_cvtepi32_ps(_mm_cvtps_epi32(x)));
+				__m128 a = _mm_andnot_ps(vSign4, x);
+				a = _mm_min_ps(a, _mm_sub_ps(vHalf4, a));
+				__m128 y = _mm_mul_ps(_mm_or_ps(a, _mm_and_ps(vSign4, x)), vScale4);
+				__m128 y2 = _mm_mul_ps(y, y);
+				__m128 p = _mm_add_ps(_mm_set1_ps(c9), _mm_mul_ps(y2, _mm_set1_ps(c11)));
+				p = _mm_add_ps(_mm_set1_ps(c7), _mm_mul_ps(y2, p));
+				p = _mm_add_ps(_mm_set1_ps(c5), _mm_mul_ps(y2, p));
+				p = _mm_add_ps(_mm_set1_ps(c3), _mm_mul_ps(y2, p));
+				p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(y2, p));
+				_mm_storeu_ps(dst + n, _mm_mul_ps(_mm_mul_ps(y, p), vGain4));
+			}
+#endif
+			for (; n < nCount; n++)
+			{
+				float x = src[n] - std::nearbyint(src[n]);
+				float a = std::min(std::abs(x), 0.5f - std::abs(x));
+				float y = std::copysign(a, x) * fTwoPi;
+				float y2 = y * y;
+				dst[n] = y * (1.0f + y2 * (c3 + y2 * (c5 + y2 * (c7 + y2 * (c9 + y2 * c11))))) * fGain;
+			}
+		}
 
-	Base::~Base()
-	{}
+		void AccumulateMonoToStereo(float* dst, const float* src, size_t nFrames, float fGain)
+		{
+			size_t n = 0;
+#if defined(SOUNDWAVE_SIMD_AVX2)
+			const __m256 vGain8 = _mm256_set1_ps(fGain);
+			for (; n + 8 <= nFrames; n += 8)
+			{
+				// Unpacking works within 128 bit lanes, the permutes put the halves back in order
+				__m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + n), vGain8);
+				__m256 lo = _mm256_unpacklo_ps(v, v), hi = _mm256_unpackhi_ps(v, v);
+				float* d = dst + 2 * n;
+				_mm256_storeu_ps(d, _mm256_add_ps(_mm256_loadu_ps(d), _mm256_permute2f128_ps(lo, hi, 0x20)));
+				_mm256_storeu_ps(d + 8, _mm256_add_ps(_mm256_loadu_ps(d + 8), _mm256_permute2f128_ps(lo, hi, 0x31)));
+			}
+#endif
+#if defined(SOUNDWAVE_SIMD_SSE2)
+			const __m128 vGain4 = _mm_set1_ps(fGain);
+			for (; n + 4 <= nFrames; n += 4)
+			{
+				__m128 v = _mm_mul_ps(_mm_loadu_ps(src + n), vGain4);
+				float* d = dst + 2 * n;
+				_mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d), _mm_unpacklo_ps(v, v)));
+				_mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4), _mm_unpackhi_ps(v, v)));
+			}
+#endif
+			for (; n < nFrames; n++)
+			{
+				float f = src[n] * fGain;
+				dst[2 * n + 0] += f;
+				dst[2 * n + 1] += f;
+			}
+		}
+
+		void Resample(float* dst, const float* src, size_t nSrcChannels, size_t nChannel, uint64_t nFixedStart, uint64_t nFixedStep, size_t nFrames)
+		{
+			constexpr float fFixedFraction = 1.0f / 4294967296.0f;
+			src += nChannel;
+			size_t n = 0;
+
+			// The vector paths step the fixed point position once per group of lanes, and
+			// offset each lane from it in float. Rounding can land a lane on the next whole
+			// sample when it is a hair short of it, which is why one more sample is required
+#if defined(SOUNDWAVE_SIMD_AVX2)
+			const __m256 vLane8 = _mm256_mul_ps(_mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_ps(float(nFixedStep) * fFixedFraction));
+			const __m256i vStride8 = _mm256_set1_epi32(int32_t(nSrcChannels));
+			for (; n + 8 <= nFrames; n += 8)
+			{
+				uint64_t nFixed = nFixedStart + n * nFixedStep;
+				const float* a = src + size_t(nFixed >> 32) * nSrcChannels;
+				__m256 vOffset = _mm256_add_ps(_mm256_set1_ps(float(uint32_t(nFixed)) * fFixedFraction), vLane8);
+				__m256i vWhole = _mm256_cvttps_epi32(vOffset);
+				__m256 t = _mm256_sub_ps(vOffset, _mm256_cvtepi32_ps(vWhole));
+				__m256i vIndex = _mm256_mullo_epi32(vWhole, vStride8);
+				__m256 va = _mm256_i32gather_ps(a, vIndex, 4);
+				__m256 vb = _mm256_i32gather_ps(a + nSrcChannels, vIndex, 4);
+				_mm256_storeu_ps(dst + n, _mm256_add_ps(va, _mm256_mul_ps(t, _mm256_sub_ps(vb, va))));
+			}
+#endif
+#if defined(SOUNDWAVE_SIMD_SSE2)
+			// No gathers in SSE2, the loads are scalar but the LERPs are not
+			const __m128 vLane4 = _mm_mul_ps(_mm_setr_ps(0, 1, 2, 3), _mm_set1_ps(float(nFixedStep) * fFixedFraction));
+			for (; n + 4 <= nFrames; n += 4)
+			{
+				uint64_t nFixed = nFixedStart + n * nFixedStep;
+				const float* a = src + size_t(nFixed >> 32) * nSrcChannels;
+				__m128 vOffset = _mm_add_ps(_mm_set1_ps(float(uint32_t(nFixed)) * fFixedFraction), vLane4);
+				__m128i vWhole = _mm_cvttps_epi32(vOffset);
+				__m128 t = _mm_sub_ps(vOffset, _mm_cvtepi32_ps(vWhole));
+
+				alignas(16) int32_t nWhole[4];
+				_mm_store_si128((__m128i*)nWhole, vWhole);
+				const float* a0 = a + nWhole[0] * nSrcChannels;
+				const float* a1 = a + nWhole[1] * nSrcChannels;
+				const float* a2 = a + nWhole[2] * nSrcChannels;
+				const float* a3 = a + nWhole[3] * nSrcChannels;
+				__m128 va = _mm_setr_ps(a0[0], a1[0], a2[0], a3[0]);
+				__m128 vb = _mm_setr_ps(a0[nSrcChannels], a1[nSrcChannels], a2[nSrcChannels], a3[nSrcChannels]);
+				_mm_storeu_ps(dst + n, _mm_add_ps(va, _mm_mul_ps(t, _mm_sub_ps(vb, va))));
+			}
+#endif
+			for (; n < nFrames; n++)
+			{
+				uint64_t nFixed = nFixedStart + n * nFixedStep;
+				const float* a = src + size_t(nFixed >> 32) * nSrcChannels;
+				float t = float(uint32_t(nFixed)) * fFixedFraction;
+				dst[n] = a[0] + t * (a[nSrcChannels] - a[0]);
+			}
+		}
+
+		void AccumulateResampledStereo(float* dst, const float* src, uint64_t nFixedStart, uint64_t nFixedStep, size_t nFrames, float fGain)
+		{
+			// Both channels of a frame are neighbours, so they are loaded and LERPed together
+			constexpr float fFixedFraction = 1.0f / 4294967296.0f;
+			size_t n = 0;
+#if defined(SOUNDWAVE_SIMD_AVX2)
+			const __m256 vGain8 = _mm256_set1_ps(fGain);
+			// Frames are offset from each group's position in float, as in Resample(), so
+			// here too a lane can read one sample further than the position asks for
+			const __m256 vLane8 = _mm256_mul_ps(_mm256_setr_ps(0, 0, 1, 1, 2, 2, 3, 3), _mm256_set1_ps(float(nFixedStep) * fFixedFraction));
+			const __m256i vChannel8 = _mm256_setr_epi32(0, 1, 0, 1, 0, 1, 0, 1);
+			for (; n + 4 <= nFrames; n += 4)
+			{
+				uint64_t nFixed = nFixedStart + n * nFixedStep;
+				const float* a = src + size_t(nFixed >> 32) * 2;
+				__m256 vOffset = _mm256_add_ps(_mm256_set1_ps(float(uint32_t(nFixed)) * fFixedFraction), vLane8);
+				__m256i vWhole = _mm256_cvttps_epi32(vOffset);
+				__m256 t = _mm256_sub_ps(vOffset, _mm256_cvtepi32_ps(vWhole));
+				__m256i vIndex = _mm256_add_epi32(_mm256_slli_epi32(vWhole, 1), vChannel8);
+				__m256 va = _mm256_i32gather_ps(a, vIndex, 4);
+				__m256 vb = _mm256_i32gather_ps(a + 2, vIndex, 4);
+				__m256 v = _mm256_add_ps(va, _mm256_mul_ps(t, _mm256_sub_ps(vb, va)));
+				_mm256_storeu_ps(dst + 2 * n, _mm256_add_ps(_mm256_loadu_ps(dst + 2 * n), _mm256_mul_ps(v, vGain8)));
+			}
+#endif
+#if defined(SOUNDWAVE_SIMD_SSE2)
+			const __m128 vGain4 = _mm_set1_ps(fGain);
+			for (; n + 2 <= nFrames; n += 2)
+			{
+				uint64_t nFixed = nFixedStart + n * nFixedStep;
+				const float* a0 = src + size_t(nFixed >> 32) * 2; float t0 = float(uint32_t(nFixed)) * fFixedFraction; nFixed += nFixedStep;
+				const float* a1 = src + size_t(nFixed >> 32) * 2; float t1 = float(uint32_t(nFixed)) * fFixedFraction;
+				__m128 va = _mm_setr_ps(a0[0], a0[1], a1[0], a1[1]);
+				__m128 vb = _mm_setr_ps(a0[2], a0[3], a1[2], a1[3]);
+				__m128 t = _mm_setr_ps(t0, t0, t1, t1);
+				__m128 v = _mm_add_ps(va, _mm_mul_ps(t, _mm_sub_ps(vb, va)));
+				_mm_storeu_ps(dst + 2 * n, _mm_add_ps(_mm_loadu_ps(dst + 2 * n), _mm_mul_ps(v, vGain4)));
+			}
+#endif
+			for (; n < nFrames; n++)
+			{
+				uint64_t nFixed = nFixedStart + n * nFixedStep;
+				const float* a = src + size_t(nFixed >> 32) * 2;
+				float t = float(uint32_t(nFixed)) * fFixedFraction;
+				dst[2 * n + 0] += (a[0] + t * (a[2] - a[0])) * fGain;
+				dst[2 * n + 1] += (a[1] + t * (a[3] - a[1])) * fGain;
+			}
+		}
+
+		const SincTable* FindSincTable(double dStep)
+		{
+			// One table for resampling up (or not at all), and others for stepping faster. Each
+			// cuts off a little below the Nyquist frequency of the fastest step it takes, with
+			// 32 taps for each source sample a step covers, under a Kaiser window
+			static const std::vector<SincTable> vTables = []()
+			{
+				constexpr double dPi = 3.14159265358979323846;
+				constexpr double dBeta = 8.0;
+				auto BesselI0 = [](double x)
+				{
+					double dSum = 1.0, dTerm = 1.0;
+					for (int k = 1; k < 32; k++)
+					{
+						dTerm *= (x / (2.0 * k)) * (x / (2.0 * k));
+						dSum += dTerm;
+					}
+					return dSum;
+				};
+
+				std::vector<SincTable> vTables;
+				for (double dMaxStep : { 1.0, 1.25, 1.5, 2.0, 3.0, 4.0 })
+				{
+					SincTable table;
+					table.dMaxStep = dMaxStep;
+					table.nTaps = size_t(std::ceil(32.0 * dMaxStep / 8.0)) * 8;
+					table.vCoefficients.resize((nSincPhases + 1) * table.nTaps);
+
+					const double dCutoff = 0.9 / dMaxStep;	// Of the source's Nyquist frequency
+					const double dHalf = double(table.nTaps / 2);
+					for (size_t r = 0; r <= nSincPhases; r++)
+					{
+						float* pRow = table.vCoefficients.data() + r * table.nTaps;
+						double dSum = 0.0;
+						for (size_t j = 0; j < table.nTaps; j++)
+						{
+							double x = double(j) + 1.0 - dHalf - double(r) / double(nSincPhases);
+							double dSinc = (x == 0.0) ? 1.0 : std::sin(dPi * dCutoff * x) / (dPi * dCutoff * x);
+							double dWindow = (std::abs(x) < dHalf) ? BesselI0(dBeta * std::sqrt(1.0 - (x / dHalf) * (x / dHalf))) / BesselI0(dBeta) : 0.0;
+							double h = dCutoff * dSinc * dWindow;
+							pRow[j] = float(h);
+							dSum += h;
+						}
+
+						// Every row passes a constant unchanged
+						for (size_t j = 0; j < table.nTaps; j++)
+							pRow[j] = float(double(pRow[j]) / dSum);
+					}
+					vTables.push_back(std::move(table));
+				}
+				return vTables;
+			}();
+
+			for (const SincTable& table : vTables)
+				if (dStep <= table.dMaxStep)
+					return &table;
+			return nullptr;
+		}
+
+		void ResampleSinc(float* dst, const float* src, size_t nSrcFrames, size_t nSrcChannels, const SincTable& table, uint64_t nFixedStart, uint64_t nFixedStep, size_t nFrames)
+		{
+			// The fraction of a sample picks two rows of taps, and what is left LERPs between them
+			constexpr uint32_t nPhaseShift = 25;
+			constexpr float fPhaseFraction = 1.0f / float(1u << nPhaseShift);
+			const size_t nTaps = table.nTaps;
+			const size_t nHalf = nTaps / 2;
+			const float* pCoefficients = table.vCoefficients.data();
+
+			for (size_t n = 0; n < nFrames; n++)
+			{
+				uint64_t nFixed = nFixedStart + n * nFixedStep;
+				size_t nWhole = size_t(nFixed >> 32);
+				uint32_t nFraction = uint32_t(nFixed);
+				const float* c0 = pCoefficients + size_t(nFraction >> nPhaseShift) * nTaps;
+				const float* c1 = c0 + nTaps;
+				float t = float(nFraction & ((1u << nPhaseShift) - 1)) * fPhaseFraction;
+				float* pFrame = dst + n * nSrcChannels;
+
+				// Near either end of the source, taps off the end read silence
+				if (nWhole + 1 < nHalf || nWhole + nHalf >= nSrcFrames)
+				{
+					for (size_t c = 0; c < nSrcChannels; c++)
+					{
+						float fSum = 0.0f;
+						for (size_t j = 0; j < nTaps; j++)
+						{
+							size_t k = nWhole + 1 + j - nHalf;
+							if (nWhole + 1 + j >= nHalf && k < nSrcFrames)
+								fSum += src[k * nSrcChannels + c] * (c0[j] + t * (c1[j] - c0[j]));
+						}
+						pFrame[c] = fSum;
+					}
+					continue;
+				}
+
+				const float* a = src + (nWhole + 1 - nHalf) * nSrcChannels;
+				size_t j = 0;
+				if (nSrcChannels == 1)
+				{
+					float fSum = 0.0f;
+#if defined(SOUNDWAVE_SIMD_AVX2)
+					const __m256 vT8 = _mm256_set1_ps(t);
+					__m256 vSum8 = _mm256_setzero_ps();
+					for (; j + 8 <= nTaps; j += 8)
+					{
+						__m256 va = _mm256_loadu_ps(c0 + j);
+						__m256 vc = _mm256_add_ps(va, _mm256_mul_ps(vT8, _mm256_sub_ps(_mm256_loadu_ps(c1 + j), va)));
+						vSum8 = _mm256_add_ps(vSum8, _mm256_mul_ps(_mm256_loadu_ps(a + j), vc));
+					}
+					__m128 vHalf = _mm_add_ps(_mm256_castps256_ps128(vSum8), _mm256_extractf128_ps(vSum8, 1));
+					vHalf = _mm_add_ps(vHalf, _mm_movehl_ps(vHalf, vHalf));
+					fSum += _mm_cvtss_f32(_mm_add_ss(vHalf, _mm_shuffle_ps(vHalf, vHalf, 1)));
+#endif
+#if defined(SOUNDWAVE_SIMD_SSE2)
+					const __m128 vT4 = _mm_set1_ps(t);
+					__m128 vSum4 = _mm_setzero_ps();
+					for (; j + 4 <= nTaps; j += 4)
+					{
+						__m128 va = _mm_loadu_ps(c0 + j);
+						__m128 vc = _mm_add_ps(va, _mm_mul_ps(vT4, _mm_sub_ps(_mm_loadu_ps(c1 + j), va)));
+						vSum4 = _mm_add_ps(vSum4, _mm_mul_ps(_mm_loadu_ps(a + j), vc));
+					}
+					vSum4 = _mm_add_ps(vSum4, _mm_movehl_ps(vSum4, vSum4));
+					fSum += _mm_cvtss_f32(_mm_add_ss(vSum4, _mm_shuffle_ps(vSum4, vSum4, 1)));
+#endif
+					for (; j < nTaps; j++)
+						fSum += a[j] * (c0[j] + t * (c1[j] - c0[j]));
+					pFrame[0] = fSum;
+				}
+				else if (nSrcChannels == 2)
+				{
+					// Each tap is used for both samples of its frame
+					float fSum[2] = { 0.0f, 0.0f };
+#if defined(SOUNDWAVE_SIMD_AVX2)
+					const __m256 vT8 = _mm256_set1_ps(t);
+					const __m256i vLow8 = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+					const __m256i vHigh8 = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+					__m256 vSum8 = _mm256_setzero_ps();
+					for (; j + 8 <= nTaps; j += 8)
+					{
+						__m256 va = _mm256_loadu_ps(c0 + j);
+						__m256 vc = _mm256_add_ps(va, _mm256_mul_ps(vT8, _mm256_sub_ps(_mm256_loadu_ps(c1 + j), va)));
+						vSum8 = _mm256_add_ps(vSum8, _mm256_mul_ps(_mm256_loadu_ps(a + 2 * j), _mm256_permutevar8x32_ps(vc, vLow8)));
+						vSum8 = _mm256_add_ps(vSum8, _mm256_mul_ps(_mm256_loadu_ps(a + 2 * j + 8), _mm256_permutevar8x32_ps(vc, vHigh8)));
+					}
+					__m128 vHalf = _mm_add_ps(_mm256_castps256_ps128(vSum8), _mm256_extractf128_ps(vSum8, 1));
+					vHalf = _mm_add_ps(vHalf, _mm_movehl_ps(vHalf, vHalf));
+					fSum[0] += _mm_cvtss_f32(vHalf);
+					fSum[1] += _mm_cvtss_f32(_mm_shuffle_ps(vHalf, vHalf, 1));
+#endif
+#if defined(SOUNDWAVE_SIMD_SSE2)
+					const __m128 vT4 = _mm_set1_ps(t);
+					__m128 vSum4 = _mm_setzero_ps();
+					for (; j + 4 <= nTaps; j += 4)
+					{
+						__m128 va = _mm_loadu_ps(c0 + j);
+						__m128 vc = _mm_add_ps(va, _mm_mul_ps(vT4, _mm_sub_ps(_mm_loadu_ps(c1 + j), va)));
+						vSum4 = _mm_add_ps(vSum4, _mm_mul_ps(_mm_loadu_ps(a + 2 * j), _mm_unpacklo_ps(vc, vc)));
+						vSum4 = _mm_add_ps(vSum4, _mm_mul_ps(_mm_loadu_ps(a + 2 * j + 4), _mm_unpackhi_ps(vc, vc)));
+					}
+					vSum4 = _mm_add_ps(vSum4, _mm_movehl_ps(vSum4, vSum4));
+					fSum[0] += _mm_cvtss_f32(vSum4);
+					fSum[1] += _mm_cvtss_f32(_mm_shuffle_ps(vSum4, vSum4, 1));
+#endif
+					for (; j < nTaps; j++)
+					{
+						float c = c0[j] + t * (c1[j] - c0[j]);
+						fSum[0] += a[2 * j + 0] * c;
+						fSum[1] += a[2 * j + 1] * c;
+					}
+					pFrame[0] = fSum[0];
+					pFrame[1] = fSum[1];
+				}
+				else
+				{
+					for (size_t c = 0; c < nSrcChannels; c++)
+					{
+						float fSum = 0.0f;
+						for (j = 0; j < nTaps; j++)
+							fSum += a[j * nSrcChannels + c] * (c0[j] + t * (c1[j] - c0[j]));
+						pFrame[c] = fSum;
+					}
+				}
+			}
+		}
+	}
+
+	bool WaveAdpcm::LoadAudioWaveform(const std::string& sWavFile)
+	{
+		std::ifstream ifs(sWavFile, std::ios::binary);
+		if (!ifs.is_open())
+			return false;
+
+		wave::Format format;
+		if (!wave::ReadHeader(ifs, format))
+			return false;
+
+		if (!format.bAdpcm)
+		{
+			ifs.close();
+			Wave wave;
+			return wave.LoadAudioWaveform(sWavFile) && Encode(wave);
+		}
+
+		// Blocks must fit where the mixer decodes them
+		if ((format.nFramesPerBlock + 1) * format.nChannels > wave::adpcm::nMaxBlockSamples || format.nChannels > wave::adpcm::nMaxChannels)
+			return false;
+
+		m_nSamples = format.nFrames;
+		m_nChannels = format.nChannels;
+		m_nSampleRate = format.nSampleRate;
+		m_nBlockAlign = format.nBlockAlign;
+		m_nFramesPerBlock = format.nFramesPerBlock;
+
+		// A truncated file decodes as silence
+		size_t nBlocks = (m_nSamples + m_nFramesPerBlock - 1) / m_nFramesPerBlock;
+		m_vData.assign(nBlocks * m_nBlockAlign, 0);
+		ifs.read((char*)m_vData.data(), m_vData.size());
+		return true;
+	}
+
+	bool WaveAdpcm::Encode(const Wave& wave, size_t nBlockAlign)
+	{
+		const size_t nChannels = wave.file.channels();
+		if (nChannels == 0 || nChannels > wave::adpcm::nMaxChannels || wave.file.data() == nullptr)
+			return false;
+
+		// Whole groups of 8 samples for every channel
+		if (nBlockAlign == 0)
+			nBlockAlign = 512 * nChannels;
+		nBlockAlign = std::max(nBlockAlign / (4 * nChannels), size_t(2)) * 4 * nChannels;
+		const size_t nFramesPerBlock = wave::adpcm::FramesPerBlock(nBlockAlign, nChannels);
+		if ((nFramesPerBlock + 1) * nChannels > wave::adpcm::nMaxBlockSamples)
+			return false;
+
+		m_nSamples = wave.file.samples();
+		m_nChannels = nChannels;
+		m_nSampleRate = wave.file.samplerate();
+		m_nBlockAlign = nBlockAlign;
+		m_nFramesPerBlock = nFramesPerBlock;
+
+		size_t nBlocks = (m_nSamples + m_nFramesPerBlock - 1) / m_nFramesPerBlock;
+		m_vData.assign(nBlocks * m_nBlockAlign, 0);
+		// Each block starts with the step size the last ended with. The first starts with
+		// one that fits the first two samples, rather than taking a few to grow into it
+		std::vector<int32_t> vIndex(m_nChannels, 0);
+		for (size_t c = 0; c < m_nChannels && m_nSamples > 1; c++)
+		{
+			float fDiff = std::abs(wave.file.data()[m_nChannels + c] - wave.file.data()[c]) * float(std::numeric_limits<int16_t>::max());
+			while (vIndex[c] < 88 && float(wave::adpcm::StepTable[vIndex[c]]) < fDiff)
+				vIndex[c]++;
+		}
+
+		for (size_t b = 0; b < nBlocks; b++)
+		{
+			size_t nFirst = b * m_nFramesPerBlock;
+			wave::adpcm::EncodeBlock(wave.file.data() + nFirst * m_nChannels, m_nChannels, std::min(m_nFramesPerBlock, m_nSamples - nFirst),
+				m_nFramesPerBlock, vIndex.data(), m_vData.data() + b * m_nBlockAlign);
+		}
+		return true;
+	}
+
+	bool WaveAdpcm::SaveFile(const std::string& sWavFile) const
+	{
+		if (m_nChannels == 0)
+			return false;
+
+		std::ofstream ofs(sWavFile, std::ios::binary);
+		if (!ofs.is_open())
+			return false;
+
+		auto write16 = [&](uint16_t n) { ofs.write((const char*)&n, sizeof(n)); };
+		auto write32 = [&](uint32_t n) { ofs.write((const char*)&n, sizeof(n)); };
+
+		// As wave::WriteHeader(), with the samples per block, and a fact chunk saying
+		// how many frames there are
+		ofs.write("RIFF", 4);
+		write32(uint32_t(4 + 28 + 12 + 8 + m_vData.size()));
+		ofs.write("WAVE", 4);
+		ofs.write("fmt ", 4);
+		write32(20);
+		write16(0x11);
+		write16(uint16_t(m_nChannels));
+		write32(uint32_t(m_nSampleRate));
+		write32(uint32_t(m_nSampleRate * m_nBlockAlign / m_nFramesPerBlock));
+		write16(uint16_t(m_nBlockAlign));
+		write16(4);
+		write16(2);
+		write16(uint16_t(m_nFramesPerBlock));
+		ofs.write("fact", 4);
+		write32(4);
+		write32(uint32_t(m_nSamples));
+		ofs.write("data", 4);
+		write32(uint32_t(m_vData.size()));
+		ofs.write((const char*)m_vData.data(), m_vData.size());
+		return ofs.good();
+	}
+
+	Wave WaveAdpcm::Decode() const
+	{
+		Wave wave(m_nChannels, 2, m_nSampleRate, m_nSamples);
+		for (size_t nFirst = 0, b = 0; nFirst < m_nSamples; nFirst += m_nFramesPerBlock, b++)
+			wave::adpcm::DecodeBlock(block(b), m_nChannels, std::min(m_nFramesPerBlock, m_nSamples - nFirst), wave.file.data() + nFirst * m_nChannels);
+		return wave;
+	}
+
+	double WaveInstance::SourceRate() const
+	{
+		if (pStream != nullptr) return double(pStream->samplerate());
+		if (pAdpcm != nullptr) return double(pAdpcm->samplerate());
+		return double(pWave->file.samplerate());
+	}
+
+	double WaveInstance::SourceDuration() const
+	{
+		if (pStream != nullptr) return pStream->duration();
+		if (pAdpcm != nullptr) return pAdpcm->duration();
+		return pWave->file.duration();
+	}
+
+	WaveStream::WaveStream(const std::string& sWavFile, const double dBufferSeconds)
+	{
+		Open(sWavFile, dBufferSeconds);
+	}
+
+	WaveStream::~WaveStream()
+	{
+		Close();
+	}
+
+	bool WaveStream::Open(const std::string& sWavFile, const double dBufferSeconds)
+	{
+		Close();
+
+		m_ifs.open(sWavFile, std::ios::binary);
+		if (!m_ifs.is_open())
+			return false;
+
+		// Samples are read a frame at a time, so compressed files are not streamed
+		if (!wave::ReadHeader(m_ifs, m_format) || m_format.bAdpcm)
+		{
+			m_ifs.close();
+			return false;
+		}
+
+		m_posData = m_ifs.tellg();
+		const size_t nChannels = m_format.nChannels;
+		m_nFrames = m_format.nDataBytes / (nChannels * m_format.nSampleSize);
+		m_vRaw.resize(nChunkFrames * nChannels * m_format.nSampleSize);
+
+		// Everything the mixer will touch is made here, so it never allocates
+		size_t nRingFrames = std::max(size_t(dBufferSeconds * double(m_format.nSampleRate)), 2 * nChunkFrames);
+		m_vRing.assign(nRingFrames * nChannels, 0.0f);
+		m_vLocal.assign(nLocalFrames * nChannels, 0.0f);
+		m_nLocalFrames = 0;
+		m_dLocalPosition = 0.0;
+		m_bPlayed = false;
+		m_nWrite = 0;
+		m_nRead = 0;
+		m_bEnded = false;
+		m_bLoop = false;
+		m_bRewind = false;
+		m_nUnderruns = 0;
+
+		// Have something to play straight away
+		SeekStart();
+		ReadFrames(nChunkFrames);
+
+		m_bReading = true;
+		m_thReader = std::thread(&WaveStream::ReaderLoop, this);
+		return true;
+	}
+
+	void WaveStream::Close()
+	{
+		m_bReading = false;
+		if (m_thReader.joinable())
+		{
+			m_cvReader.notify_one();
+			m_thReader.join();
+		}
+		m_ifs.close();
+	}
+
+	bool WaveStream::IsOpen() const
+	{
+		return m_bReading;
+	}
+
+	size_t WaveStream::channels() const
+	{
+		return m_format.nChannels;
+	}
+
+	size_t WaveStream::samplerate() const
+	{
+		return m_format.nSampleRate;
+	}
+
+	double WaveStream::duration() const
+	{
+		return m_format.nSampleRate > 0 ? double(m_nFrames) / double(m_format.nSampleRate) : 0.0;
+	}
+
+	uint32_t WaveStream::GetUnderruns() const
+	{
+		return m_nUnderruns;
+	}
+
+	void WaveStream::ReaderLoop()
+	{
+		const size_t nChannels = m_format.nChannels;
+		while (m_bReading)
+		{
+			if (m_bRewind.load(std::memory_order_acquire))
+			{
+				// The mixer is waiting, so the ring can be emptied from this side
+				m_nRead.store(m_nWrite.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				SeekStart();
+				m_bEnded = false;
+				ReadFrames(nChunkFrames);
+				m_bRewind.store(false, std::memory_order_release);
+				continue;
+			}
+
+			size_t nFilled = m_nWrite.load(std::memory_order_relaxed) - m_nRead.load(std::memory_order_acquire);
+			if (!m_bEnded && m_vRing.size() - nFilled >= nChunkFrames * nChannels)
+			{
+				ReadFrames(nChunkFrames);
+				continue;
+			}
+
+			// Full, or nothing left to read. The mixer only wakes us to rewind
+			std::unique_lock<std::mutex> lock(m_muxReader);
+			m_cvReader.wait_for(lock, std::chrono::milliseconds(5));
+		}
+	}
+
+	size_t WaveStream::ReadFrames(size_t nFrames)
+	{
+		const size_t nChannels = m_format.nChannels;
+		const size_t nSampleSize = m_format.nSampleSize;
+		const size_t nRing = m_vRing.size();
+		size_t nDone = 0;
+		while (nDone < nFrames)
+		{
+			if (m_nFramesLeft == 0)
+			{
+				if (!m_bLoop || m_nFrames == 0)
+				{
+					m_bEnded = true;
+					break;
+				}
+				SeekStart();
+			}
+
+			size_t nCount = std::min(nFrames - nDone, m_nFramesLeft);
+			size_t nSamples = nCount * nChannels;
+			m_ifs.read(m_vRaw.data(), nSamples * nSampleSize);
+			// A truncated file reads as silence
+			std::fill(m_vRaw.begin() + m_ifs.gcount(), m_vRaw.begin() + nSamples * nSampleSize, 0);
+
+			// Converted straight into the ring, in two parts where it wraps around
+			size_t nWrite = m_nWrite.load(std::memory_order_relaxed);
+			size_t nIndex = nWrite % nRing;
+			size_t nFirst = std::min(nSamples, nRing - nIndex);
+			wave::ConvertSamples(m_vRaw.data(), nFirst, m_format, m_vRing.data() + nIndex);
+			wave::ConvertSamples(m_vRaw.data() + nFirst * nSampleSize, nSamples - nFirst, m_format, m_vRing.data());
+			m_nWrite.store(nWrite + nSamples, std::memory_order_release);
+
+			m_nFramesLeft -= nCount;
+			nDone += nCount;
+		}
+		return nDone;
+	}
+
+	void WaveStream::SeekStart()
+	{
+		m_ifs.clear();
+		m_ifs.seekg(m_posData);
+		m_nFramesLeft = m_nFrames;
+	}
+
+	WaveEngine::WaveEngine()
+	{
+		m_sInputDevice = "NONE";
+		m_sOutputDevice = "DEFAULT";
+
+#if defined(SOUNDWAVE_USING_WINMM)
+		m_driver = std::make_unique<driver::WinMM>(this);
+#endif
+
+#if defined(SOUNDWAVE_USING_WASAPI)
+		m_driver = std::make_unique<driver::WASAPI>(this);
+#endif
+
+#if defined(SOUNDWAVE_USING_XAUDIO)
+		m_driver = std::make_unique<driver::XAudio>(this);
+#endif
+
+#if defined(SOUNDWAVE_USING_OPENAL)
+		m_driver = std::make_unique<driver::OpenAL>(this);
+#endif
+
+#if defined(SOUNDWAVE_USING_ALSA)
+		m_driver = std::make_unique<driver::ALSA>(this);
+#endif
+
+#if defined(SOUNDWAVE_USING_SDLMIXER)
+		m_driver = std::make_unique<driver::SDLMixer>(this);
+#endif
+
+#if defined(SOUNDWAVE_USING_PULSE)
+		m_driver = std::make_unique<driver::PulseAudio>(this);
+#endif
+
+#if defined(SOUNDWAVE_USING_NULL)
+		m_driver = std::make_unique<driver::Null>(this, driver::Null::Mode::RealTime);
+#endif
+	}
+
+	WaveEngine::~WaveEngine()
+	{
+		DestroyAudio();
+	}
+
+	std::vector<std::string> WaveEngine::GetOutputDevices()
+	{
+		return { "XXX" };
+	}
+
+
+	void WaveEngine::UseOutputDevice(const std::string& sDeviceOut)
+	{
+		m_sOutputDevice = sDeviceOut;
+	}
+
+	std::vector<std::string> WaveEngine::GetInputDevices()
+	{
+		return { "XXX" };
+	}
+
+	void WaveEngine::UseInputDevice(const std::string& sDeviceIn)
+	{
+		m_sInputDevice = sDeviceIn;
+	}
+
+	void WaveEngine::UseDriver(std::unique_ptr<driver::Base> pDriver)
+	{
+		m_driver = std::move(pDriver);
+	}
+
+	void WaveEngine::SetVoiceLimit(const uint32_t nVoices)
+	{
+		m_nVoiceLimit = std::max(nVoices, 1u);
+	}
+
+	void WaveEngine::SetVoiceStealing(const VoiceSteal steal)
+	{
+		m_voiceSteal = steal;
+	}
+
+	void WaveEngine::SetInterpolation(const Interpolation interpolation)
+	{
+		// Make the filters here, rather than on the audio thread
+		if (interpolation == Interpolation::Sinc)
+			mix::FindSincTable(1.0);
+		m_interpolation = interpolation;
+	}
+
+	uint32_t WaveEngine::GetActiveVoices() const
+	{
+		return m_nActiveVoices;
+	}
+
+	bool WaveEngine::InitialiseAudio(uint32_t nSampleRate, uint32_t nChannels, uint32_t nBlocks, uint32_t nBlockSamples)
+	{
+		m_nSampleRate = nSampleRate;
+		m_nChannels = nChannels;
+		m_nBlocks = nBlocks;
+		m_nBlockSamples = nBlockSamples;
+		m_dSamplePerTime = double(nSampleRate);
+		m_dTimePerSample = 1.0 / double(nSampleRate);
+
+		m_vVoices.assign(m_nVoiceLimit, WaveInstance());
+		m_vDecode.resize(wave::adpcm::nMaxBlockSamples);
+		m_vChannelBlock.resize(nBlockSamples);
+		m_vActiveVoices.clear();
+		m_vActiveVoices.reserve(m_nVoiceLimit);
+		m_vFreeVoices.resize(m_nVoiceLimit);
+		// Handed out from the back, so voice 0 goes first
+		for (uint32_t n = 0; n < m_nVoiceLimit; n++)
+			m_vFreeVoices[n] = m_nVoiceLimit - 1 - n;
+
+		m_driver->Open(m_sOutputDevice, m_sInputDevice);
+		m_bAudioRunning = m_driver->Start();
+		return false;
+	}
+
+
+	bool WaveEngine::DestroyAudio()
+	{
+		m_driver->Stop();
+		m_driver->Close();
+		m_bAudioRunning = false;
+
+		// Nothing is mixing now, so this thread can finish off the queue
+		ApplyCommands();
+		for (uint32_t nVoice : m_vActiveVoices)
+			m_vFreeVoices.push_back(nVoice);
+		m_vActiveVoices.clear();
+		m_nActiveVoices = 0;
+		return false;
+	}
+
+	void WaveEngine::SetCallBack_NewSample(std::function<void(double)> func)
+	{
+		m_funcNewSample = func;
+	}
+
+	void WaveEngine::SetCallBack_SynthFunction(std::function<float(uint32_t, double)> func)
+	{
+		m_funcUserSynth = func;
+	}
+
+	void WaveEngine::SetCallBack_FilterFunction(std::function<float(uint32_t, double, float)> func)
+	{
+		m_funcUserFilter = func;
+	}
+
+	void WaveEngine::SetCallBack_SynthBlock(std::function<void(uint32_t, double, double, float*, uint32_t)> func)
+	{
+		m_funcUserSynthBlock = func;
+	}
+
+	void WaveEngine::SetCallBack_FilterBlock(std::function<void(uint32_t, double, double, float*, uint32_t)> func)
+	{
+		m_funcUserFilterBlock = func;
+	}
+
+	PlayingWave WaveEngine::PlayWaveform(Wave* pWave, bool bLoop, double dSpeed, float fVolume, int32_t nPriority)
+	{
+		WaveCommand cmd;
+		cmd.type = WaveCommand::Type::Play;
+		cmd.nID = m_nLastWaveID + 1;
+		cmd.pWave = pWave;
+		cmd.bLoop = bLoop;
+		cmd.dSpeed = dSpeed;
+		cmd.fVolume = fVolume;
+		cmd.nPriority = nPriority;
+		if (!PostCommand(cmd))
+			return 0;
+
+		m_nLastWaveID = cmd.nID;
+		return cmd.nID;
+	}
+
+	PlayingWave WaveEngine::PlayWaveform(WaveAdpcm* pWave, bool bLoop, double dSpeed, float fVolume, int32_t nPriority)
+	{
+		WaveCommand cmd;
+		cmd.type = WaveCommand::Type::Play;
+		cmd.nID = m_nLastWaveID + 1;
+		cmd.pAdpcm = pWave;
+		cmd.bLoop = bLoop;
+		cmd.dSpeed = dSpeed;
+		cmd.fVolume = fVolume;
+		cmd.nPriority = nPriority;
+		if (!PostCommand(cmd))
+			return 0;
+
+		m_nLastWaveID = cmd.nID;
+		return cmd.nID;
+	}
+
+	PlayingWave WaveEngine::PlayStream(WaveStream* pStream, bool bLoop, double dSpeed, float fVolume, int32_t nPriority)
+	{
+		WaveCommand cmd;
+		cmd.type = WaveCommand::Type::Play;
+		cmd.nID = m_nLastWaveID + 1;
+		cmd.pStream = pStream;
+		cmd.bLoop = bLoop;
+		cmd.dSpeed = dSpeed;
+		cmd.fVolume = fVolume;
+		cmd.nPriority = nPriority;
+		if (pStream == nullptr || !pStream->IsOpen() || !PostCommand(cmd))
+			return 0;
+
+		m_nLastWaveID = cmd.nID;
+		return cmd.nID;
+	}
+
+	void WaveEngine::StopWaveform(const PlayingWave w)
+	{
+		WaveCommand cmd;
+		cmd.type = WaveCommand::Type::Stop;
+		cmd.nID = w;
+		PostCommand(cmd);
+	}
+
+	void WaveEngine::StopAll()
+	{
+		WaveCommand cmd;
+		cmd.type = WaveCommand::Type::StopAll;
+		PostCommand(cmd);
+	}
+
+	void WaveEngine::SetWaveVolume(const PlayingWave w, const float fVolume)
+	{
+		WaveCommand cmd;
+		cmd.type = WaveCommand::Type::SetVolume;
+		cmd.nID = w;
+		cmd.fVolume = fVolume;
+		PostCommand(cmd);
+	}
+
+	void WaveEngine::SetWaveSpeed(const PlayingWave w, const double dSpeed)
+	{
+		WaveCommand cmd;
+		cmd.type = WaveCommand::Type::SetSpeed;
+		cmd.nID = w;
+		cmd.dSpeed = dSpeed;
+		PostCommand(cmd);
+	}
+
+	void WaveEngine::SetOutputVolume(const float fVolume)
+	{
+		WaveCommand cmd;
+		cmd.type = WaveCommand::Type::SetOutputVolume;
+		cmd.fVolume = std::clamp(fVolume, 0.0f, 1.0f);
+		PostCommand(cmd);
+	}
+
+	bool WaveEngine::PostCommand(const WaveCommand& cmd)
+	{
+		// A full queue empties a block at a time, unless nothing is mixing
+		while (!m_queueCommands.Push(cmd))
+		{
+			if (!m_bAudioRunning)
+				return false;
+			std::this_thread::yield();
+		}
+		return true;
+	}
+
+	void WaveEngine::ApplyCommands()
+	{
+		WaveCommand cmd;
+		while (m_queueCommands.Pop(cmd))
+			ApplyCommand(cmd);
+	}
+
+	WaveInstance* WaveEngine::FindVoice(const PlayingWave w)
+	{
+		for (uint32_t nVoice : m_vActiveVoices)
+			if (m_vVoices[nVoice].nID == w)
+				return &m_vVoices[nVoice];
+		return nullptr;
+	}
+
+	int32_t WaveEngine::AllocateVoice(const int32_t nPriority)
+	{
+		if (!m_vFreeVoices.empty())
+		{
+			uint32_t nVoice = m_vFreeVoices.back();
+			m_vFreeVoices.pop_back();
+			m_vActiveVoices.push_back(nVoice);
+			return int32_t(nVoice);
+		}
+
+		const VoiceSteal steal = m_voiceSteal;
+		if (steal == VoiceSteal::Never)
+			return -1;
+
+		// Voices being stopped are taken first, they will not be heard again anyway
+		int32_t nVictim = -1;
+		for (uint32_t nVoice : m_vActiveVoices)
+		{
+			const WaveInstance& wi = m_vVoices[nVoice];
+			if (wi.nPriority > nPriority && !wi.bFlagForStop)
+				continue;
+
+			if (nVictim < 0)
+			{
+				nVictim = int32_t(nVoice);
+				continue;
+			}
+
+			const WaveInstance& best = m_vVoices[nVictim];
+			if (wi.bFlagForStop != best.bFlagForStop)
+			{
+				if (wi.bFlagForStop) nVictim = int32_t(nVoice);
+				continue;
+			}
+
+			if (wi.nPriority != best.nPriority)
+			{
+				if (wi.nPriority < best.nPriority) nVictim = int32_t(nVoice);
+				continue;
+			}
+
+			// Lower ids started earlier
+			bool bBetter = (steal == VoiceSteal::Quietest && wi.fVolume != best.fVolume) ? wi.fVolume < best.fVolume : wi.nID < best.nID;
+			if (bBetter) nVictim = int32_t(nVoice);
+		}
+
+		// The stolen voice keeps its place in m_vActiveVoices
+		return nVictim;
+	}
+
+	void WaveEngine::ApplyCommand(const WaveCommand& cmd)
+	{
+		switch (cmd.type)
+		{
+		case WaveCommand::Type::Play:
+		{
+			WaveStream* pStream = cmd.pStream;
+			if (pStream != nullptr)
+			{
+				// A stream has one place to read from, so it leaves any voice it was playing in
+				for (uint32_t nVoice : m_vActiveVoices)
+				{
+					if (m_vVoices[nVoice].pStream == pStream)
+						m_vVoices[nVoice].bFlagForStop = true;
+				}
+
+				// Unless this is the first time it plays, and the reader has not got to
+				// the end, the reader starts it again from the top
+				pStream->m_bLoop = cmd.bLoop;
+				if (pStream->m_bPlayed || pStream->m_bEnded)
+				{
+					pStream->m_nLocalFrames = 0;
+					pStream->m_dLocalPosition = 0.0;
+					pStream->m_bRewind = true;
+					pStream->m_cvReader.notify_one();
+				}
+				pStream->m_bPlayed = true;
+			}
+
+			int32_t nVoice = AllocateVoice(cmd.nPriority);
+			if (nVoice < 0)
+				break;
+
+			WaveInstance& wi = m_vVoices[nVoice];
+			wi = WaveInstance();
+			wi.nID = cmd.nID;
+			wi.bLoop = cmd.bLoop;
+			wi.pWave = cmd.pWave;
+			wi.pStream = pStream;
+			wi.pAdpcm = cmd.pAdpcm;
+			wi.fVolume = cmd.fVolume;
+			wi.nPriority = cmd.nPriority;
+			wi.dSpeed = cmd.dSpeed;
+			wi.dSpeedModifier = cmd.dSpeed * wi.SourceRate() / m_dSamplePerTime;
+			wi.dDuration = wi.SourceDuration() / cmd.dSpeed;
+			wi.dInstanceTime = m_dGlobalTime;
+			break;
+		}
+
+		case WaveCommand::Type::Stop:
+			if (WaveInstance* wi = FindVoice(cmd.nID))
+				wi->bFlagForStop = true;
+			break;
+
+		case WaveCommand::Type::StopAll:
+			for (uint32_t nVoice : m_vActiveVoices)
+				m_vVoices[nVoice].bFlagForStop = true;
+			break;
+
+		case WaveCommand::Type::SetVolume:
+			if (WaveInstance* wi = FindVoice(cmd.nID))
+				wi->fVolume = cmd.fVolume;
+			break;
+
+		case WaveCommand::Type::SetSpeed:
+		{
+			// Carry on from the same place in the wave, at the new rate
+			WaveInstance* wi = FindVoice(cmd.nID);
+			if (wi == nullptr || cmd.dSpeed <= 0.0)
+				break;
+			double dPosition = (m_dGlobalTime - wi->dInstanceTime) * wi->dSpeed;
+			wi->dSpeed = cmd.dSpeed;
+			wi->dSpeedModifier = cmd.dSpeed * wi->SourceRate() / m_dSamplePerTime;
+			wi->dDuration = wi->SourceDuration() / cmd.dSpeed;
+			wi->dInstanceTime = m_dGlobalTime - dPosition / cmd.dSpeed;
+			break;
+		}
+
+		case WaveCommand::Type::SetOutputVolume:
+			m_fOutputVolume = cmd.fVolume;
+			break;
+		}
+	}
+
+	uint32_t WaveEngine::FillOutputBuffer(std::vector<float>& vBuffer, const uint32_t nBufferOffset, const uint32_t nRequiredSamples)
+	{
+		ApplyCommands();
+
+		float* pOutput = vBuffer.data() + nBufferOffset;
+		std::fill(pOutput, pOutput + size_t(nRequiredSamples) * m_nChannels, 0.0f);
+
+		// 1) Mix active waves a block at a time. Each works out once how many of the
+		// block's samples it still covers, mixes those, then loops or finishes
+		for (uint32_t nVoice : m_vActiveVoices)
+		{
+			WaveInstance& wave = m_vVoices[nVoice];
+
+			// Is wave instance flagged for stopping?
+			if (wave.bFlagForStop)
+			{
+				wave.bFinished = true;
+				continue;
+			}
+
+			// Streams keep their own place, and loop as they are read
+			if (wave.pStream != nullptr)
+			{
+				if (!MixStream(wave, pOutput, nRequiredSamples))
+					wave.bFinished = true;
+				continue;
+			}
+
+			uint32_t nSample = 0;
+			while (nSample < nRequiredSamples)
+			{
+				// Calculate offset into wave instance, and how many samples are left of it
+				double dTimeOffset = m_dGlobalTime + nSample * m_dTimePerSample - wave.dInstanceTime;
+				double dRemaining = std::ceil((wave.dDuration - dTimeOffset) * m_dSamplePerTime);
+				uint32_t nCount = uint32_t(std::clamp(dRemaining, 0.0, double(nRequiredSamples - nSample)));
+
+				MixWave(wave, pOutput + size_t(nSample) * m_nChannels, nCount, dTimeOffset * m_dSamplePerTime * wave.dSpeedModifier);
+				nSample += nCount;
+				if (nSample == nRequiredSamples) break;
+
+				// The wave ended inside this block
+				if (wave.bLoop && wave.dDuration > 0.0)
+				{
+					// ...if looping, restart the wave instance at the next sample
+					wave.dInstanceTime = m_dGlobalTime + nSample * m_dTimePerSample;
+				}
+				else
+				{
+					// ...if not looping, flag wave instance as dead
+					wave.bFinished = true;
+					break;
+				}
+			}
+		}
+
+		// Return the voices of waveform instances that have finished
+		size_t nActive = 0;
+		for (uint32_t nVoice : m_vActiveVoices)
+		{
+			if (m_vVoices[nVoice].bFinished)
+				m_vFreeVoices.push_back(nVoice);
+			else
+				m_vActiveVoices[nActive++] = nVoice;
+		}
+		m_vActiveVoices.resize(nActive);
+		m_nActiveVoices = uint32_t(nActive);
+
+		// 2) If user is synthesizing a block at a time, add each channel's block
+		if (m_funcUserSynthBlock)
+		{
+			float* pBlock = m_vChannelBlock.data();
+			for (uint32_t nSample = 0; nSample < nRequiredSamples; nSample += uint32_t(m_vChannelBlock.size()))
+			{
+				uint32_t nCount = std::min(uint32_t(m_vChannelBlock.size()), nRequiredSamples - nSample);
+				double dSampleTime = m_dGlobalTime + nSample * m_dTimePerSample;
+				float* pMix = pOutput + size_t(nSample) * m_nChannels;
+				for (uint32_t nChannel = 0; nChannel < m_nChannels; nChannel++)
+				{
+					std::fill(pBlock, pBlock + nCount, 0.0f);
+					m_funcUserSynthBlock(nChannel, dSampleTime, m_dTimePerSample, pBlock, nCount);
+					if (m_nChannels == 1)
+						mix::Accumulate(pMix, pBlock, nCount, 1.0f);
+					else
+					{
+						for (uint32_t n = 0; n < nCount; n++)
+							pMix[n * m_nChannels + nChannel] += pBlock[n];
+					}
+				}
+			}
+		}
+
+		// 3) If user is synthesizing or filtering, visit each sample
+		if (m_funcNewSample || m_funcUserSynth || m_funcUserFilter)
+		{
+			for (uint32_t nSample = 0; nSample < nRequiredSamples; nSample++)
+			{
+				double dSampleTime = m_dGlobalTime + nSample * m_dTimePerSample;
+
+				if (m_funcNewSample)
+					m_funcNewSample(dSampleTime);
+
+				for (uint32_t nChannel = 0; nChannel < m_nChannels; nChannel++)
+				{
+					float& fSample = pOutput[nSample * m_nChannels + nChannel];
+
+					if (m_funcUserSynth)
+						fSample += m_funcUserSynth(nChannel, dSampleTime);
+
+					// 4) Apply global filters
+
+
+					// 5) If user is filtering, allow manipulation of output
+					if (m_funcUserFilter)
+						fSample = m_funcUserFilter(nChannel, dSampleTime, fSample);
+				}
+			}
+		}
+
+		// 6) If user is filtering a block at a time, hand over each channel's block. Mono
+		// output is already one channel, so is filtered where it is
+		if (m_funcUserFilterBlock)
+		{
+			float* pBlock = m_vChannelBlock.data();
+			for (uint32_t nSample = 0; nSample < nRequiredSamples; nSample += uint32_t(m_vChannelBlock.size()))
+			{
+				uint32_t nCount = std::min(uint32_t(m_vChannelBlock.size()), nRequiredSamples - nSample);
+				double dSampleTime = m_dGlobalTime + nSample * m_dTimePerSample;
+				float* pMix = pOutput + size_t(nSample) * m_nChannels;
+				for (uint32_t nChannel = 0; nChannel < m_nChannels; nChannel++)
+				{
+					if (m_nChannels == 1)
+					{
+						m_funcUserFilterBlock(nChannel, dSampleTime, m_dTimePerSample, pMix, nCount);
+						continue;
+					}
+
+					for (uint32_t n = 0; n < nCount; n++)
+						pBlock[n] = pMix[n * m_nChannels + nChannel];
+					m_funcUserFilterBlock(nChannel, dSampleTime, m_dTimePerSample, pBlock, nCount);
+					for (uint32_t n = 0; n < nCount; n++)
+						pMix[n * m_nChannels + nChannel] = pBlock[n];
+				}
+			}
+		}
+
+		if (m_fOutputVolume != 1.0f)
+			mix::Scale(pOutput, size_t(nRequiredSamples) * m_nChannels, m_fOutputVolume);
+
+		// UPdate global time, accounting for error (thanks scripticuk)
+		m_dGlobalTime += nRequiredSamples * m_dTimePerSample;
+		return nRequiredSamples;
+	}
+
+	void WaveEngine::MixWave(WaveInstance& wave, float* pOutput, const uint32_t nSamples, const double dPosition)
+	{
+		if (wave.pAdpcm == nullptr)
+		{
+			if (m_interpolation.load(std::memory_order_relaxed) == Interpolation::Sinc)
+				MixSinc(wave.pWave->file.data(), wave.pWave->file.samples(), wave.pWave->file.channels(), wave.dSpeedModifier, wave.fVolume, pOutput, nSamples, dPosition);
+			else
+				MixSamples(wave.pWave->file.data(), wave.pWave->file.samples(), wave.pWave->file.channels(), wave.dSpeedModifier, wave.fVolume, pOutput, nSamples, dPosition);
+			return;
+		}
+
+		// Compressed waves are decoded a block at a time, only as far as the output needs,
+		// and the voice keeps the decoder where the next output starts, so no frame is
+		// decoded twice unless the voice goes back. The frame after a block is the first of
+		// the next, which is stored whole at its start
+		const WaveAdpcm& adpcm = *wave.pAdpcm;
+		const size_t nWaveChannels = adpcm.channels();
+		const size_t nFramesPerBlock = adpcm.framesperblock();
+		const double dStep = wave.dSpeedModifier;
+		const double dStart = std::max(dPosition, 0.0);
+		float* pDecode = m_vDecode.data();
+
+		uint32_t n = 0;
+		while (n < nSamples)
+		{
+			double dSample = dStart + n * dStep;
+			size_t nBlock = size_t(dSample) / nFramesPerBlock;
+			size_t nFirst = nBlock * nFramesPerBlock;
+			if (nFirst >= adpcm.samples())
+				break;
+
+			// The output samples that fall in this block, and the frames they need
+			size_t nFrames = std::min(nFramesPerBlock, adpcm.samples() - nFirst);
+			uint32_t nCount = uint32_t(std::clamp(std::ceil((double(nFirst + nFrames) - dSample) / dStep), 1.0, double(nSamples - n)));
+			size_t nFrom = size_t(dSample) - nFirst;
+			size_t nLast = size_t(dSample + (nCount - 1) * dStep) - nFirst + 1;
+			size_t nTo = std::min(nLast, nFrames - 1);
+			size_t nNext = std::min(size_t(dSample + nCount * dStep) - nFirst, nTo);
+
+			const uint8_t* pBlock = adpcm.block(nBlock);
+			if (wave.nAdpcmBlock != nBlock || wave.nAdpcmFrame > nFrom)
+			{
+				wave::adpcm::StartBlock(pBlock, nWaveChannels, wave.adpcmState.data());
+				wave.nAdpcmBlock = nBlock;
+				wave.nAdpcmFrame = 0;
+			}
+
+			wave::adpcm::DecodeFrames(pBlock, nWaveChannels, wave.adpcmState.data(), wave.nAdpcmFrame, nNext, nFrom, pDecode);
+			wave.nAdpcmFrame = nNext;
+			if (nTo > nNext)
+			{
+				std::array<wave::adpcm::State, wave::adpcm::nMaxChannels> state = wave.adpcmState;
+				wave::adpcm::DecodeFrames(pBlock, nWaveChannels, state.data(), nNext, nTo, nFrom, pDecode);
+			}
+
+			size_t nDecoded = nTo - nFrom + 1;
+			if (nLast >= nFrames && nFirst + nFrames < adpcm.samples())
+			{
+				wave::adpcm::State state[wave::adpcm::nMaxChannels];
+				wave::adpcm::StartBlock(adpcm.block(nBlock + 1), nWaveChannels, state);
+				for (size_t c = 0; c < nWaveChannels; c++)
+					pDecode[nDecoded * nWaveChannels + c] = float(state[c].nPredictor) * wave::adpcm::fScale;
+				nDecoded++;
+			}
+
+			MixSamples(pDecode, nDecoded, nWaveChannels, dStep, wave.fVolume, pOutput + size_t(n) * m_nChannels, nCount, dSample - double(nFirst + nFrom));
+			n += nCount;
+		}
+	}
+
+	void WaveEngine::MixSamples(const float* pData, const size_t nWaveSamples, const size_t nWaveChannels, const double dStep, const float fGain,
+		float* pOutput, const uint32_t nSamples, const double dPosition) const
+	{
+		// Samples are LERPed between neighbours, with silence after the last one,
+		// and each output channel reads the wave channel it wraps around to
+		if (pData == nullptr || nWaveSamples == 0 || nWaveChannels == 0 || nSamples == 0) return;
+
+		const uint32_t nChannels = m_nChannels;
+		const bool bLayoutKernel = nWaveChannels == nChannels || (nWaveChannels == 1 && nChannels == 2);
+		double dStart = std::max(dPosition, 0.0);
+
+		// A wave played at the device rate lands on whole samples (give or take the
+		// error in the clock), so it is copied across without any LERPing
+		double dWhole = std::round(dStart);
+		if (dStep == 1.0 && bLayoutKernel && std::abs(dStart - dWhole) < 1e-6)
+		{
+			size_t p = size_t(dWhole);
+			if (p >= nWaveSamples) return;
+			size_t nCount = std::min(size_t(nSamples), nWaveSamples - p);
+			if (nWaveChannels == nChannels)
+				mix::Accumulate(pOutput, pData + p * nChannels, nCount * nChannels, fGain);
+			else
+				mix::AccumulateMonoToStereo(pOutput, pData + p, nCount, fGain);
+			return;
+		}
+
+		// Most of the span can be resampled by the kernels, which need the two samples
+		// after each position. The rest (near the end of the wave) is done a sample at
+		// a time below
+		uint32_t nSafe = 0;
+		if (nWaveSamples > 2 && dStart < double(nWaveSamples - 2))
+			nSafe = (dStep > 0.0) ? uint32_t(std::min(std::ceil((double(nWaveSamples - 2) - dStart) / dStep), double(nSamples))) : nSamples;
+
+		// The position is stepped in 32.32 fixed point, and resampled into a
+		// chunk of the stack before being mixed in
+		constexpr double dFixedOne = 4294967296.0;
+		constexpr uint32_t nChunk = 256;
+		const uint64_t nFixedStart = uint64_t(dStart * dFixedOne);
+		const uint64_t nFixedStep = uint64_t(dStep * dFixedOne);
+		alignas(32) float fChunk[nChunk];
+
+		for (uint32_t n = 0; n < nSafe; n += nChunk)
+		{
+			uint32_t nCount = std::min(nChunk, nSafe - n);
+			uint64_t nFixed = nFixedStart + n * nFixedStep;
+			float* pMix = pOutput + size_t(n) * nChannels;
+
+			if (nWaveChannels == 1)
+			{
+				mix::Resample(fChunk, pData, 1, 0, nFixed, nFixedStep, nCount);
+				if (nChannels == 1)
+					mix::Accumulate(pMix, fChunk, nCount, fGain);
+				else if (nChannels == 2)
+					mix::AccumulateMonoToStereo(pMix, fChunk, nCount, fGain);
+				else
+				{
+					for (uint32_t i = 0; i < nCount; i++)
+						for (uint32_t c = 0; c < nChannels; c++)
+							pMix[i * nChannels + c] += fChunk[i] * fGain;
+				}
+			}
+			else if (nWaveChannels == 2 && nChannels == 2)
+				mix::AccumulateResampledStereo(pMix, pData, nFixed, nFixedStep, nCount, fGain);
+			else if (nWaveChannels == nChannels)
+			{
+				for (uint32_t c = 0; c < nChannels; c++)
+				{
+					mix::Resample(fChunk, pData, nChannels, c, nFixed, nFixedStep, nCount);
+					for (uint32_t i = 0; i < nCount; i++)
+						pMix[i * nChannels + c] += fChunk[i] * fGain;
+				}
+			}
+			else
+			{
+				nSafe = 0;
+				break;
+			}
+		}
+
+		for (uint32_t n = nSafe; n < nSamples; n++)
+		{
+			double dSample = dStart + n * dStep;
+			size_t p1 = size_t(int64_t(dSample));
+			if (p1 >= nWaveSamples) break;
+			float t = float(dSample - double(p1));
+
+			const float* a = pData + p1 * nWaveChannels;
+			const bool bLast = p1 + 1 >= nWaveSamples;
+			for (uint32_t nChannel = 0; nChannel < nChannels; nChannel++)
+			{
+				size_t c = nChannel % nWaveChannels;
+				float b = bLast ? 0.0f : a[nWaveChannels + c];
+				pOutput[n * nChannels + nChannel] += (a[c] + t * (b - a[c])) * fGain;
+			}
+		}
+	}
+
+	void WaveEngine::MixSinc(const float* pData, const size_t nWaveSamples, const size_t nWaveChannels, const double dStep, const float fGain,
+		float* pOutput, const uint32_t nSamples, const double dPosition) const
+	{
+		// On whole samples at the output's rate the filter gives back what it was given, and
+		// past the fastest table there is no filter, so both are left to MixSamples()
+		const mix::SincTable* pTable = mix::FindSincTable(dStep);
+		double dStart = std::max(dPosition, 0.0);
+		if (pTable == nullptr || (dStep == 1.0 && std::abs(dStart - std::round(dStart)) < 1e-6))
+		{
+			MixSamples(pData, nWaveSamples, nWaveChannels, dStep, fGain, pOutput, nSamples, dPosition);
+			return;
+		}
+
+		if (pData == nullptr || nWaveChannels == 0 || dStart >= double(nWaveSamples)) return;
+
+		// Silent past the last sample, as when LERPing
+		const uint32_t nChannels = m_nChannels;
+		const uint32_t nCount = uint32_t(std::min(std::ceil((double(nWaveSamples) - dStart) / dStep), double(nSamples)));
+
+		constexpr double dFixedOne = 4294967296.0;
+		const uint64_t nFixedStart = uint64_t(dStart * dFixedOne);
+		const uint64_t nFixedStep = uint64_t(dStep * dFixedOne);
+		alignas(32) float fChunk[1024];
+		const uint32_t nChunk = uint32_t(std::max(size_t(1), 1024 / nWaveChannels));
+
+		for (uint32_t n = 0; n < nCount; n += nChunk)
+		{
+			uint32_t nFrames = std::min(nChunk, nCount - n);
+			mix::ResampleSinc(fChunk, pData, nWaveSamples, nWaveChannels, *pTable, nFixedStart + n * nFixedStep, nFixedStep, nFrames);
+
+			float* pMix = pOutput + size_t(n) * nChannels;
+			if (nWaveChannels == nChannels)
+				mix::Accumulate(pMix, fChunk, size_t(nFrames) * nChannels, fGain);
+			else if (nWaveChannels == 1 && nChannels == 2)
+				mix::AccumulateMonoToStereo(pMix, fChunk, nFrames, fGain);
+			else
+			{
+				for (uint32_t i = 0; i < nFrames; i++)
+					for (uint32_t c = 0; c < nChannels; c++)
+						pMix[i * nChannels + c] += fChunk[i * nWaveChannels + c % nWaveChannels] * fGain;
+			}
+		}
+	}
+
+	bool WaveEngine::MixStream(WaveInstance& wave, float* pOutput, const uint32_t nSamples)
+	{
+		WaveStream& stream = *wave.pStream;
+
+		// Still being taken back to the start
+		if (stream.m_bRewind.load(std::memory_order_acquire))
+		{
+			stream.m_nUnderruns++;
+			return true;
+		}
+
+		const size_t nWaveChannels = stream.channels();
+		const size_t nRing = stream.m_vRing.size();
+		float* pLocal = stream.m_vLocal.data();
+		uint32_t nSample = 0;
+		while (nSample < nSamples)
+		{
+			// Let go of the frames played, keeping the one the position is in for LERPing
+			size_t nDrop = std::min(size_t(stream.m_dLocalPosition), stream.m_nLocalFrames);
+			if (nDrop > 0)
+			{
+				std::memmove(pLocal, pLocal + nDrop * nWaveChannels, (stream.m_nLocalFrames - nDrop) * nWaveChannels * sizeof(float));
+				stream.m_nLocalFrames -= nDrop;
+				stream.m_dLocalPosition -= double(nDrop);
+			}
+
+			// Take what the reader has ready, as far as there is room
+			size_t nRead = stream.m_nRead.load(std::memory_order_relaxed);
+			size_t nWrite = stream.m_nWrite.load(std::memory_order_acquire);
+			size_t nTake = std::min(nWrite - nRead, (WaveStream::nLocalFrames - stream.m_nLocalFrames) * nWaveChannels);
+			if (nTake > 0)
+			{
+				float* pTarget = pLocal + stream.m_nLocalFrames * nWaveChannels;
+				size_t nIndex = nRead % nRing;
+				size_t nFirst = std::min(nTake, nRing - nIndex);
+				std::memcpy(pTarget, stream.m_vRing.data() + nIndex, nFirst * sizeof(float));
+				std::memcpy(pTarget + nFirst, stream.m_vRing.data(), (nTake - nFirst) * sizeof(float));
+				stream.m_nRead.store(nRead + nTake, std::memory_order_release);
+				stream.m_nLocalFrames += nTake / nWaveChannels;
+			}
+
+			// How many output samples fall between frames that are both here
+			const double dStep = wave.dSpeedModifier;
+			const size_t nLocal = stream.m_nLocalFrames;
+			uint32_t nCount = 0;
+			if (nLocal >= 2 && stream.m_dLocalPosition < double(nLocal - 1))
+				nCount = uint32_t(std::min(std::ceil((double(nLocal - 1) - stream.m_dLocalPosition) / dStep), double(nSamples - nSample)));
+
+			if (nCount == 0)
+			{
+				// Once the reader has stopped, and all it read is here, the last frame
+				// is LERPed to silence and the stream is done
+				if (stream.m_bEnded && stream.m_nWrite.load(std::memory_order_acquire) == stream.m_nRead.load(std::memory_order_relaxed))
+				{
+					MixSamples(pLocal, nLocal, nWaveChannels, dStep, wave.fVolume,
+						pOutput + size_t(nSample) * m_nChannels, nSamples - nSample, stream.m_dLocalPosition);
+					return false;
+				}
+
+				// The reader has fallen behind, what is left of the block stays silent
+				stream.m_nUnderruns++;
+				return true;
+			}
+
+			MixSamples(pLocal, nLocal, nWaveChannels, dStep, wave.fVolume, pOutput + size_t(nSample) * m_nChannels, nCount, stream.m_dLocalPosition);
+			stream.m_dLocalPosition += double(nCount) * dStep;
+			nSample += nCount;
+		}
+		return true;
+	}
+
+	uint32_t WaveEngine::GetSampleRate() const
+	{
+		return m_nSampleRate;
+	}
+
+	uint32_t WaveEngine::GetChannels() const
+	{
+		return m_nChannels;
+	}
+
+	uint32_t WaveEngine::GetBlocks() const
+	{
+		return m_nBlocks;
+	}
+
+	uint32_t WaveEngine::GetBlockSampleCount() const
+	{
+		return m_nBlockSamples;
+	}
+
+	double WaveEngine::GetTimePerSample() const
+	{
+		return m_dTimePerSample;
+	}
+
+	namespace driver
+	{
+	Base::Base(olc::sound::WaveEngine* pHost) : m_pHost(pHost)
+	{}
+
+	Base::~Base()
+	{}
 
 	bool Base::Open(const std::string& sOutputDevice, const std::string& sInputDevice)
 	{
@@ -1234,6 +3614,120 @@ namespace olc::sound
 			nSamplesToProcess -= nSamplesGathered;
 		}
 	}
+
+	Null::Null(WaveEngine* pHost, const Mode mode) : Base(pHost), m_mode(mode)
+	{}
+
+	Null::~Null()
+	{
+		Stop();
+	}
+
+	bool Null::Start()
+	{
+		if (m_mode == Mode::Manual)
+			return false;
+
+		m_bDriverLoopActive = true;
+		m_thDriverLoop = std::thread(&Null::DriverLoop, this);
+		return true;
+	}
+
+	void Null::Stop()
+	{
+		m_bDriverLoopActive = false;
+		if (m_thDriverLoop.joinable())
+			m_thDriverLoop.join();
+	}
+
+	void Null::RenderBlocks(const uint32_t nBlocks)
+	{
+		m_vBlock.resize(size_t(m_pHost->GetBlockSampleCount()) * m_pHost->GetChannels());
+		for (uint32_t n = 0; n < nBlocks; n++)
+		{
+			GetFullOutputBlock(m_vBlock);
+			OnBlock(m_vBlock);
+			m_nBlocksRendered++;
+		}
+	}
+
+	uint64_t Null::GetBlocksRendered() const
+	{
+		return m_nBlocksRendered;
+	}
+
+	void Null::OnBlock(const std::vector<float>&)
+	{}
+
+	void Null::DriverLoop()
+	{
+		const auto tpBlock = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(double(m_pHost->GetBlockSampleCount()) * m_pHost->GetTimePerSample()));
+		auto tpNext = std::chrono::steady_clock::now();
+
+		while (m_bDriverLoopActive)
+		{
+			RenderBlocks(1);
+
+			if (m_mode == Mode::RealTime)
+			{
+				tpNext += tpBlock;
+				std::this_thread::sleep_until(tpNext);
+			}
+		}
+	}
+
+	WaveWriter::WaveWriter(WaveEngine* pHost, const std::string& sFilename, const Mode mode, const uint32_t nSampleSize)
+		: Null(pHost, mode), m_sFilename(sFilename), m_nSampleSize(nSampleSize == 2 ? 2 : 4)
+	{}
+
+	WaveWriter::~WaveWriter()
+	{
+		Stop();
+		Close();
+	}
+
+	bool WaveWriter::Open(const std::string&, const std::string&)
+	{
+		m_ofs.open(m_sFilename, std::ios::binary);
+		if (!m_ofs.is_open())
+			return false;
+
+		// Sizes are filled in once they are known
+		m_nSamplesWritten = 0;
+		wave::WriteHeader(m_ofs, m_pHost->GetChannels(), m_pHost->GetSampleRate(), m_nSampleSize, 0, m_nSampleSize == 4);
+		return true;
+	}
+
+	void WaveWriter::Close()
+	{
+		if (!m_ofs.is_open())
+			return;
+
+		m_ofs.seekp(0);
+		wave::WriteHeader(m_ofs, m_pHost->GetChannels(), m_pHost->GetSampleRate(), m_nSampleSize, m_nSamplesWritten, m_nSampleSize == 4);
+		m_ofs.close();
+	}
+
+	void WaveWriter::OnBlock(const std::vector<float>& vBlock)
+	{
+		if (!m_ofs.is_open())
+			return;
+
+		if (m_nSampleSize == 4)
+			m_ofs.write((const char*)vBlock.data(), vBlock.size() * sizeof(float));
+		else
+		{
+			// Converted as the hardware drivers convert to shorts
+			constexpr float fMaxSample = float(std::numeric_limits<short>::max());
+			constexpr float fMinSample = float(std::numeric_limits<short>::min());
+			m_vPCM.resize(vBlock.size());
+			for (size_t n = 0; n < vBlock.size(); n++)
+				m_vPCM[n] = short(std::clamp(vBlock[n] * fMaxSample, fMinSample, fMaxSample));
+			m_ofs.write((const char*)m_vPCM.data(), m_vPCM.size() * sizeof(short));
+		}
+		m_nSamplesWritten += vBlock.size() / m_pHost->GetChannels();
+	}
 	}	
 
 	namespace synth
@@ -1249,6 +3743,18 @@ namespace olc::sound
 		return *this;
 	}
 
+	double Property::at(const uint32_t n) const
+	{
+		return (block != nullptr) ? double(block[n]) : value;
+	}
+
+
+	void Module::UpdateBlock(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nFrames)
+	{
+		for (uint32_t n = 0; n < nFrames; n++)
+			Update(nChannel, dTime + n * dTimeStep, dTimeStep);
+	}
+
 
 	ModularSynth::ModularSynth()
 	{
@@ -1315,6 +3821,7 @@ namespace olc::sound
 		for (auto& patch : m_vPatches)
 		{
 			patch.second->value = patch.first->value;
+			patch.second->block = patch.first->block;
 		}
 	}
 
@@ -1328,6 +3835,15 @@ namespace olc::sound
 		}
 	}
 
+	void ModularSynth::UpdateBlock(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nFrames)
+	{
+		for (auto& pModule : m_vModules)
+		{
+			UpdatePatches();
+			pModule->UpdateBlock(nChannel, dTime, dTimeStep, nFrames);
+		}
+	}
+
 
 	namespace modules
 	{		
@@ -1338,6 +3854,9 @@ namespace olc::sound
 			phase_acc += w + lfo_input.value * frequency.value;
 			if (phase_acc >= 2.0) phase_acc -= 2.0;
 
+			// A frame at a time, so there is no block to read
+			output.block = nullptr;
+
 			switch (waveform)
 			{
 			case Type::Sine:
@@ -1349,15 +3868,15 @@ namespace olc::sound
 				break;
 
 			case Type::Square:
-				output = amplitude.value * (phase_acc >= 1.0) ? 1.0 : -1.0;
+				output = amplitude.value * ((phase_acc >= 1.0) ? 1.0 : -1.0);
 				break;
 
 			case Type::Triangle:
-				output = amplitude.value * (phase_acc < 1.0) ? (phase_acc * 0.5) : (1.0 - phase_acc * 0.5);
+				output = amplitude.value * ((phase_acc < 1.0) ? (phase_acc * 0.5) : (1.0 - phase_acc * 0.5));
 				break;
 
 			case Type::PWM:
-				output = amplitude.value * (phase_acc >= (parameter.value + 1.0)) ? 1.0 : -1.0;
+				output = amplitude.value * ((phase_acc >= (parameter.value + 1.0)) ? 1.0 : -1.0);
 				break;
 
 			case Type::Wave:
@@ -1372,6 +3891,95 @@ namespace olc::sound
 			}
 		}
 
+		void Oscillator::UpdateBlock(uint32_t nChannel, double, double dTimeStep, uint32_t nFrames)
+		{
+			nFrames = std::min(nFrames, nMaxBlockFrames);
+			if (nFrames == 0) return;
+			float* pPhase = block_phase.data();
+			float* pOutput = block_output.data();
+
+			// Phase accumulates frame by frame as Update() does it, then whole blocks are shaped
+			if (frequency.block == nullptr && lfo_input.block == nullptr)
+			{
+				const double w = frequency.value * max_frequency * dTimeStep + lfo_input.value * frequency.value;
+				for (uint32_t n = 0; n < nFrames; n++)
+				{
+					phase_acc += w;
+					if (phase_acc >= 2.0) phase_acc -= 2.0;
+					pPhase[n] = float(phase_acc);
+				}
+			}
+			else
+			{
+				for (uint32_t n = 0; n < nFrames; n++)
+				{
+					double f = frequency.at(n);
+					phase_acc += f * max_frequency * dTimeStep + lfo_input.at(n) * f;
+					if (phase_acc >= 2.0) phase_acc -= 2.0;
+					pPhase[n] = float(phase_acc);
+				}
+			}
+
+			switch (waveform)
+			{
+			case Type::Sine:
+				mix::SineCycles(pOutput, pPhase, nFrames, 1.0f);
+				break;
+
+			case Type::Saw:
+				for (uint32_t n = 0; n < nFrames; n++)
+					pOutput[n] = (pPhase[n] - 1.0f) * 2.0f;
+				break;
+
+			case Type::Square:
+				for (uint32_t n = 0; n < nFrames; n++)
+					pOutput[n] = (pPhase[n] >= 1.0f) ? 1.0f : -1.0f;
+				break;
+
+			case Type::Triangle:
+				for (uint32_t n = 0; n < nFrames; n++)
+					pOutput[n] = (pPhase[n] < 1.0f) ? (pPhase[n] * 0.5f) : (1.0f - pPhase[n] * 0.5f);
+				break;
+
+			case Type::PWM:
+				for (uint32_t n = 0; n < nFrames; n++)
+					pOutput[n] = (pPhase[n] >= float(parameter.at(n) + 1.0)) ? 1.0f : -1.0f;
+				break;
+
+			case Type::Wave:
+				if (pWave == nullptr)
+				{
+					// Holds its last output, as Update() does
+					output.block = nullptr;
+					return;
+				}
+				for (uint32_t n = 0; n < nFrames; n++)
+					pOutput[n] = float(pWave->vChannelView[nChannel].GetSample(pPhase[n] * 0.5 * pWave->file.durationInSamples()));
+				break;
+
+			case Type::Noise:
+				for (uint32_t n = 0; n < nFrames; n++)
+					pOutput[n] = float(rndDouble(-1.0, 1.0));
+				break;
+			}
+
+			// Outputs are clamped, as assigning to a Property clamps
+			if (amplitude.block == nullptr)
+			{
+				const float fAmplitude = float(amplitude.value);
+				for (uint32_t n = 0; n < nFrames; n++)
+					pOutput[n] = std::clamp(pOutput[n] * fAmplitude, -1.0f, 1.0f);
+			}
+			else
+			{
+				for (uint32_t n = 0; n < nFrames; n++)
+					pOutput[n] = std::clamp(pOutput[n] * amplitude.block[n], -1.0f, 1.0f);
+			}
+
+			output.value = pOutput[nFrames - 1];
+			output.block = pOutput;
+		}
+
 		double Oscillator::rndDouble(double min, double max)
 		{
 			return ((double)rnd() / (double)(0x7FFFFFFF)) * (max - min) + min;
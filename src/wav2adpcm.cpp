@@ -0,0 +1,72 @@
+// WAV to IMA ADPCM encoder.
+// Compresses a WAV file (PCM or float, any number of channels) into an IMA ADPCM WAV file,
+// which olc::sound::WaveAdpcm keeps in memory as it is and the mixer decodes as it plays.
+// Reports how much smaller it is than 16 bit and float samples, and how close the decoded
+// samples are to the original ones.
+//
+// g++ -O2 -DSOUNDWAVE_USING_NULL -o wav2adpcm wav2adpcm.cpp -lpthread -std=c++17
+// ./wav2adpcm input.wav output.wav [block bytes per channel]
+
+#define OLC_SOUNDWAVE
+#include "olcSoundWaveEngine.h"
+
+#include <cstdlib>
+#include <iomanip>
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: wav2adpcm input.wav output.wav [block bytes per channel, default 512]\n";
+        return 1;
+    }
+
+    std::string sInput = argv[1];
+    std::string sOutput = argv[2];
+    size_t nBlockBytes = (argc > 3) ? size_t(std::atoi(argv[3])) : 512;
+
+    olc::sound::Wave wave;
+    if (!wave.LoadAudioWaveform(sInput))
+    {
+        std::cerr << "Could not load " << sInput << std::endl;
+        return 1;
+    }
+
+    olc::sound::WaveAdpcm adpcm;
+    if (!adpcm.Encode(wave, nBlockBytes * wave.file.channels()))
+    {
+        std::cerr << "Could not encode with " << nBlockBytes << " byte blocks" << std::endl;
+        return 1;
+    }
+
+    if (!adpcm.SaveFile(sOutput))
+    {
+        std::cerr << "Could not write " << sOutput << std::endl;
+        return 1;
+    }
+
+    // How far the decoded samples are from the original ones
+    olc::sound::Wave decoded = adpcm.Decode();
+    double dSignal = 0.0, dNoise = 0.0, dMaxError = 0.0;
+    size_t nCount = wave.file.samples() * wave.file.channels();
+    for (size_t n = 0; n < nCount; n++)
+    {
+        double dOriginal = std::clamp(double(wave.file.data()[n]), -1.0, 1.0);
+        double dError = double(decoded.file.data()[n]) - dOriginal;
+        dSignal += dOriginal * dOriginal;
+        dNoise += dError * dError;
+        dMaxError = std::max(dMaxError, std::abs(dError));
+    }
+
+    size_t nPCM16 = nCount * sizeof(int16_t);
+    size_t nFloat = nCount * sizeof(float);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "input:       " << sInput << ", " << wave.file.channels() << " channels, " << wave.file.samplerate() << " Hz, "
+              << wave.file.samples() << " frames (" << wave.file.duration() << " s)\n";
+    std::cout << "output:      " << sOutput << ", " << adpcm.bytes() << " bytes of samples, " << adpcm.framesperblock() << " frames a block\n";
+    std::cout << "vs 16 bit:   " << double(nPCM16) / double(std::max(adpcm.bytes(), size_t(1))) << "x smaller\n";
+    std::cout << "vs float:    " << double(nFloat) / double(std::max(adpcm.bytes(), size_t(1))) << "x smaller\n";
+    std::cout << "SNR:         " << ((dNoise > 0.0) ? 10.0 * std::log10(dSignal / dNoise) : 0.0) << " dB\n";
+    std::cout << std::setprecision(5) << "max error:   " << dMaxError << std::endl;
+    return 0;
+}